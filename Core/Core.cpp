@@ -1,7 +1,10 @@
 #include "Core.h"
+#include "Parallel.h"
 
 #if _WIN32
 #include <direct.h>					// for mkdir()
+#else
+#include <unistd.h>					// for link(), fork()
 #endif
 
 #include <sys/stat.h>				// for mkdir(), stat()
@@ -13,18 +16,133 @@
 #endif // VSTUDIO_INTEGRATION
 
 
+/*-----------------------------------------------------------------------------
+	Buffered log output
+
+	Messages are formatted by the calling thread, then appended to the shared
+	buffer under a short lock. The buffer is written to the console and log file
+	by a background thread, or by the printing thread when the buffer is full.
+-----------------------------------------------------------------------------*/
+
+#define LOG_BUFFER_SIZE			65536
+#define LOG_FLUSH_INTERVAL		50			// msec
+
+int GLogLevel = LOG_Verbose;
+
 static FILE *GLogFile = NULL;
+static FILE *GObjectLogFile = NULL;
+
+struct CLogBuffer
+{
+	char			Data[LOG_BUFFER_SIZE];
+	int				Size;
+};
+
+static CLogBuffer ConsoleBuffer;
+static CLogBuffer ObjectLogBuffer;
+
+// Allocated dynamically and never destroyed, so logging works while static objects are destroyed
+static CMutex *LogLock = NULL;
+static CThread *LogThread = NULL;
+
+static CMutex& GetLogLock()
+{
+	if (!LogLock) LogLock = new CMutex;
+	return *LogLock;
+}
+
+// Should be called with LogLock held
+static void WriteLogBuffers()
+{
+	if (ConsoleBuffer.Size)
+	{
+		if (GLogLevel > LOG_Quiet)
+		{
+			fwrite(ConsoleBuffer.Data, ConsoleBuffer.Size, 1, stdout);
+			fflush(stdout);
+		}
+		if (GLogFile) fwrite(ConsoleBuffer.Data, ConsoleBuffer.Size, 1, GLogFile);
+		ConsoleBuffer.Size = 0;
+	}
+	if (ObjectLogBuffer.Size)
+	{
+		if (GObjectLogFile) fwrite(ObjectLogBuffer.Data, ObjectLogBuffer.Size, 1, GObjectLogFile);
+		ObjectLogBuffer.Size = 0;
+	}
+}
+
+void appFlushLog()
+{
+	CScopedLock Lock(GetLogLock());
+	WriteLogBuffers();
+}
+
+static void LogFlushThread(void*)
+{
+	while (true)
+	{
+		appSleep(LOG_FLUSH_INTERVAL);
+		appFlushLog();
+	}
+}
+
+static void AppendLog(CLogBuffer &Buf, const char *Text, int Len)
+{
+	CScopedLock Lock(GetLogLock());
+	if (!LogThread)
+	{
+		// first message, start the flushing thread
+		atexit(appFlushLog);
+		LogThread = new CThread;
+		LogThread->Start(LogFlushThread, NULL);
+	}
+	if (Buf.Size + Len > LOG_BUFFER_SIZE)
+		WriteLogBuffers();
+	assert(Len <= LOG_BUFFER_SIZE);
+	memcpy(Buf.Data + Buf.Size, Text, Len);
+	Buf.Size += Len;
+}
+
+
+#if !_WIN32
+
+int appFork()
+{
+	// hold the lock, so the child will not get it locked by the log thread
+	CMutex &Lock = GetLogLock();
+	Lock.Lock();
+	WriteLogBuffers();
+	int Pid = fork();
+	if (Pid == 0)
+	{
+		// threads are not copied to the child process, the log thread will be started again
+		LogThread = NULL;
+	}
+	Lock.Unlock();
+	return Pid;
+}
+
+#endif // !_WIN32
+
 
 void appOpenLogFile(const char *filename)
 {
-	GLogFile = fopen(filename, "a");
-	if (!GLogFile)
+	FILE *f = fopen(filename, "a");
+	if (!f)
+	{
 		appPrintf("Unable to open log \"%s\"\n", filename);
+		return;
+	}
+	CScopedLock Lock(GetLogLock());
+	WriteLogBuffers();
+	GLogFile = f;
 }
 
 
 void appPrintf(const char *fmt, ...)
 {
+	if (GLogLevel == LOG_Quiet && !GLogFile) return;
+
 	va_list	argptr;
 	va_start(argptr, fmt);
 	char buf[4096];
@@ -32,8 +150,7 @@ void appPrintf(const char *fmt, ...)
 	va_end(argptr);
 	assert(len >= 0 && len < ARRAY_COUNT(buf) - 1);
 
-	fwrite(buf, len, 1, stdout);
-	if (GLogFile) fwrite(buf, len, 1, GLogFile);
+	AppendLog(ConsoleBuffer, buf, len);
 
 #if VSTUDIO_INTEGRATION
 	if (IsDebuggerPresent())
@@ -42,11 +159,37 @@ void appPrintf(const char *fmt, ...)
 }
 
 
+void appOpenObjectLog(const char *filename)
+{
+	FILE *f = fopen(filename, "a");
+	if (!f)
+	{
+		appPrintf("Unable to open object log \"%s\"\n", filename);
+		return;
+	}
+	CScopedLock Lock(GetLogLock());
+	WriteLogBuffers();
+	GObjectLogFile = f;
+}
+
+
+void appLogObject(const char *Action, const char *ClassName, const char *PackageName, const char *ObjectName,
+	int64 Bytes, unsigned Msec, const char *Result)
+{
+	if (!GObjectLogFile) return;
+	char buf[1024];
+	appSprintf(ARRAY_ARG(buf), "%s\t%s\t%s\t%s\t%lld\t%u\t%s\n",
+		Action, ClassName, PackageName, ObjectName, (long long)Bytes, Msec, Result);
+	AppendLog(ObjectLogBuffer, buf, strlen(buf));
+}
+
+
 /*-----------------------------------------------------------------------------
 	Simple error/notofication functions
 -----------------------------------------------------------------------------*/
 
-bool GIsSwError = false;			// software-gererated error
+THREAD_LOCAL bool GIsSwError = false;	// software-gererated error
+static THREAD_LOCAL bool WasError = false;
 
 void appError(const char *fmt, ...)
 {
@@ -63,8 +206,10 @@ void appError(const char *fmt, ...)
 //	appNotify("ERROR: %s\n", buf);
 	strcpy(GErrorHistory, buf);
 	appStrcatn(ARRAY_ARG(GErrorHistory), "\n");
+	WasError = false;				// new history was started
 	THROW;
 #else
+	appFlushLog();
 	fprintf(stderr, "Fatal Error: %s\n", buf);
 	if (GLogFile) fprintf(GLogFile, "Fatal Error: %s\n", buf);
 	exit(1);
@@ -73,9 +218,12 @@ void appError(const char *fmt, ...)
 
 
 static char NotifyBuf[512];
+static NotifyHeaderFunc_t NotifyFunc = NULL;
+static const void *NotifyParam = NULL;
 
 void appSetNotifyHeader(const char *fmt, ...)
 {
+	NotifyFunc = NULL;
 	if (!fmt)
 	{
 		NotifyBuf[0] = 0;
@@ -88,6 +236,14 @@ void appSetNotifyHeader(const char *fmt, ...)
 }
 
 
+void appSetNotifyHeaderFunc(NotifyHeaderFunc_t Func, const void *Param)
+{
+	NotifyBuf[0] = 0;
+	NotifyFunc   = Func;
+	NotifyParam  = Param;
+}
+
+
 void appNotify(const char *fmt, ...)
 {
 	va_list	argptr;
@@ -97,7 +253,14 @@ void appNotify(const char *fmt, ...)
 	va_end(argptr);
 	assert(len >= 0 && len < ARRAY_COUNT(buf) - 1);
 
-	fflush(stdout);
+	CScopedLock Lock(GetLogLock());
+	WriteLogBuffers();
+
+	if (NotifyFunc)
+	{
+		NotifyFunc(ARRAY_ARG(NotifyBuf), NotifyParam);
+		NotifyFunc = NULL;
+	}
 
 	// a bit ugly code: printing the same thing into 3 streams
 
@@ -127,8 +290,7 @@ void appNotify(const char *fmt, ...)
 }
 
 
-char GErrorHistory[2048];
-static bool WasError = false;
+THREAD_LOCAL char GErrorHistory[2048];
 
 static void LogHistory(const char *part)
 {
@@ -183,8 +345,9 @@ const char *va(const char *format, ...)
 {
 //	guardSlow(va);
 
-	static char buf[VA_BUFSIZE];
-	static int bufPos = 0;
+	// every thread has its own buffer
+	static THREAD_LOCAL char buf[VA_BUFSIZE];
+	static THREAD_LOCAL int bufPos = 0;
 	// wrap buffer
 	if (bufPos >= VA_BUFSIZE - VA_GOODSIZE) bufPos = 0;
 
@@ -311,6 +474,18 @@ const char *appStristr(const char *s1, const char *s2)
 	return s1 + (s - buf1);
 }
 
+uint32 appStrHashNoCase(const char *str)
+{
+	// FNV-1a with lowercasing; good enough distribution for short identifiers
+	uint32 hash = 2166136261u;
+	while (char c = *str++)
+	{
+		if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+		hash = (hash ^ (byte)c) * 16777619u;
+	}
+	return hash;
+}
+
 void appNormalizeFilename(char *filename)
 {
 	char *src = filename;
@@ -570,6 +745,34 @@ bool appContainsWildcard(const char *string)
 	File helpers
 -----------------------------------------------------------------------------*/
 
+// Cache of directories created by appMakeDirectory(), so mkdir() is called only once
+// for every directory
+#define DIR_CACHE_HASH_SIZE		1024
+
+struct CDirCacheItem
+{
+	CDirCacheItem	*Next;
+	char			Name[1];		// variable size
+};
+
+static CDirCacheItem *DirCacheHash[DIR_CACHE_HASH_SIZE];
+
+// Returns 'true' if directory was already registered
+static bool RegisterCreatedDirectory(const char *dirname)
+{
+	int hash = appStrHashNoCase(dirname) & (DIR_CACHE_HASH_SIZE - 1);
+	for (const CDirCacheItem *item = DirCacheHash[hash]; item; item = item->Next)
+	{
+		if (!strcmp(item->Name, dirname)) return true;
+	}
+	int len = strlen(dirname);
+	CDirCacheItem *item = (CDirCacheItem*)appMalloc(sizeof(CDirCacheItem) + len);
+	memcpy(item->Name, dirname, len + 1);
+	item->Next = DirCacheHash[hash];
+	DirCacheHash[hash] = item;
+	return false;
+}
+
 void appMakeDirectory(const char *dirname)
 {
 	if (!dirname[0]) return;
@@ -586,7 +789,7 @@ void appMakeDirectory(const char *dirname)
 			continue;
 		*s = 0;						// temporarily cut rest of path
 		// here: path delimiter or end of string
-		if (Name[0] != '.' || Name[1] != 0)		// do not create "."
+		if ((Name[0] != '.' || Name[1] != 0) && !RegisterCreatedDirectory(Name))	// do not create "."
 #if _WIN32
 			_mkdir(Name);
 #else
@@ -611,6 +814,21 @@ void appMakeDirectoryForFile(const char *filename)
 	}
 }
 
+#if _WIN32 && !defined(WINAPI)	// detect <windows.h>
+extern "C" {
+	__declspec(dllimport) int __stdcall CreateHardLinkA(const char* lpFileName, const char* lpExistingFileName, void* lpSecurityAttributes);
+}
+#endif
+
+bool appMakeHardLink(const char *existingFile, const char *newFile)
+{
+#if _WIN32
+	return CreateHardLinkA(newFile, existingFile, NULL) != 0;
+#else
+	return link(existingFile, newFile) == 0;
+#endif
+}
+
 #ifndef S_ISDIR
 // no such declarations in windows headers, but exists in mingw32 ...
 #define	S_ISDIR(m)	(((m) & S_IFMT) == S_IFDIR)
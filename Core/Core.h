@@ -122,6 +122,7 @@ template<>    struct CompileTimeError<true> {};
 #	define vsnwprintf			_vsnwprintf
 #	define FORCEINLINE			__forceinline
 #	define NORETURN				__declspec(noreturn)
+#	define THREAD_LOCAL			__declspec(thread)
 #	define stricmp				_stricmp
 #	define strnicmp				_strnicmp
 #	define GCC_PACK							// VC uses #pragma pack()
@@ -156,6 +157,7 @@ typedef unsigned __int64		uint64;
 #	define vsnwprintf			swprintf
 #	define __FUNCSIG__			__PRETTY_FUNCTION__
 #	define NORETURN				__attribute__((noreturn))
+#	define THREAD_LOCAL			__thread
 #	if (__GNUC__ > 3) || ((__GNUC__ == 3) && (__GNUC_MINOR__ >= 2))
 	// strange, but there is only way to work (inline+always_inline)
 #		define FORCEINLINE		inline __attribute__((always_inline))
@@ -272,7 +274,35 @@ inline void QSort(const char** array, int count, int (*cmpFunc)(const char**, co
 void appOpenLogFile(const char *filename);
 void appPrintf(const char *fmt, ...);
 
-extern bool GIsSwError;
+// Console output is buffered and written by a background thread. Call this function
+// before writing to stdout or stderr directly.
+void appFlushLog();
+
+#if !_WIN32
+// Create a child process with fork() and prepare log output to work in both processes.
+// Should be called when there are no other threads except the log writer.
+int appFork();
+#endif
+
+enum ELogLevel
+{
+	LOG_Quiet,						// no console output, log file receives summary messages
+	LOG_Summary,					// no per-object messages
+	LOG_Verbose,					// everything, default
+};
+
+extern int GLogLevel;
+
+// Print per-object message, arguments are not evaluated when these messages are disabled
+#define appPrintfVerbose		if (GLogLevel < LOG_Verbose) {} else appPrintf
+
+// Machine-readable object log, one tab-separated line per processed object:
+//	<action> <class> <package> <object> <bytes> <msec> <result>
+void appOpenObjectLog(const char *filename);
+void appLogObject(const char *Action, const char *ClassName, const char *PackageName, const char *ObjectName,
+	int64 Bytes, unsigned Msec, const char *Result);
+
+extern THREAD_LOCAL bool GIsSwError;
 
 void appError(const char *fmt, ...);
 
@@ -280,6 +310,10 @@ void appError(const char *fmt, ...);
 // Log some information
 
 void appSetNotifyHeader(const char *fmt, ...);
+// Same as above, but the header text is built by the callback only when a message
+// is printed. Param should remain valid until the header is changed.
+typedef void (*NotifyHeaderFunc_t)(char *buf, int bufSize, const void *Param);
+void appSetNotifyHeaderFunc(NotifyHeaderFunc_t Func, const void *Param);
 void appNotify(const char *fmt, ...);
 
 
@@ -293,6 +327,8 @@ void appStrncpyz(char *dst, const char *src, int count);
 void appStrncpylwr(char *dst, const char *src, int count);
 void appStrcatn(char *dst, int count, const char *src);
 const char *appStristr(const char *s1, const char *s2);
+// Case-insensitive string hash, suitable for hash tables with power-of-two size
+uint32 appStrHashNoCase(const char *str);
 
 bool appMatchWildcard(const char *name, const char *mask, bool ignoreCase = false);
 bool appContainsWildcard(const char *string);
@@ -300,6 +336,9 @@ bool appContainsWildcard(const char *string);
 void appNormalizeFilename(char *filename);
 void appMakeDirectory(const char *dirname);
 void appMakeDirectoryForFile(const char *filename);
+// Create a hard link 'newFile' to 'existingFile'. Returns false on failure (for example,
+// when files are on different volumes, or filesystem doesn't support hard links).
+bool appMakeHardLink(const char *existingFile, const char *newFile);
 
 #define FS_FILE				1
 #define FS_DIR				2
@@ -470,7 +509,8 @@ long win32ExceptFilter(struct _EXCEPTION_POINTERS *info);
 void appUnwindPrefix(const char *fmt);		// not vararg (will display function name for unguardf only)
 NORETURN void appUnwindThrow(const char *fmt, ...);
 
-extern char GErrorHistory[2048];
+// Error history is per-thread, so errors in different threads don't affect each other
+extern THREAD_LOCAL char GErrorHistory[2048];
 
 #else  // DO_GUARD
 
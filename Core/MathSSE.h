@@ -2,6 +2,7 @@
 #define __MATH_SSE_H__
 
 #include <xmmintrin.h>
+#include <emmintrin.h>			// SSE2
 
 struct CVec4
 {
@@ -1,4 +1,5 @@
 #include "Core.h"
+#include "Parallel.h"
 
 #if DEBUG_MEMORY
 #define MAX_STACK_TRACE			16
@@ -55,6 +56,21 @@ struct CStackTrace
 static CStackTrace GAllocationPoints[MAX_ALLOCATION_POINTS];
 static int GNumAllocationPoints = 0;
 
+// Spin lock protecting the block list and allocation points. Not using CMutex to avoid
+// dependency on static initialization order.
+static volatile int GDebugMemoryLock = 0;
+
+static void LockDebugMemory()
+{
+	while (appInterlockedExchange(&GDebugMemoryLock, 1))
+	{}
+}
+
+static void UnlockDebugMemory()
+{
+	appInterlockedExchange(&GDebugMemoryLock, 0);
+}
+
 #endif // DEBUG_MEMORY
 
 
@@ -117,11 +133,12 @@ void *appMalloc(int size, int alignment)
 	hdr->blockSize = size;
 
 #if DEBUG_MEMORY
-	hdr->Link();
 	// collect a stack trace
 	CStackTrace stack;
 	appCaptureStackTrace(stack.stack, MAX_STACK_TRACE, 2);
 	stack.UpdateHash();
+	LockDebugMemory();
+	hdr->Link();
 	// find similar call stack
 	CStackTrace* found = NULL;
 	for (int i = 0; i < GNumAllocationPoints; i++)
@@ -139,13 +156,15 @@ void *appMalloc(int size, int alignment)
 		*found = stack;
 	}
 	hdr->stack = found;
+	UnlockDebugMemory();
 #endif // DEBUG_MEMORY
 
-	// statistics
-	GTotalAllocationSize += size;
-	GTotalAllocationCount++;
+	// statistics; atomic operations are used because memory could be allocated from
+	// different threads
+	appInterlockedAdd(&GTotalAllocationSize, (size_t)size);
+	appInterlockedAdd(&GTotalAllocationCount, 1);
 #if PROFILE
-	GNumAllocs++;
+	appInterlockedAdd(&GNumAllocs, 1);
 #endif
 
 	return ptr;
@@ -167,7 +186,9 @@ void* appRealloc(void *ptr, int newSize)
 	assert(hdr->magic == BLOCK_MAGIC);
 	hdr->magic--;		// modify to any value
 #if DEBUG_MEMORY
+	LockDebugMemory();
 	hdr->Unlink();
+	UnlockDebugMemory();
 #endif
 
 	int alignment = hdr->align + 1;
@@ -185,11 +206,11 @@ void* appRealloc(void *ptr, int newSize)
 
 	// statistics: we're allocating a new block with appMalloc, which counts statistics
 	// for this allocation, so only eliminate statistics from old memory block here
-	GTotalAllocationSize -= oldSize;
-	GTotalAllocationCount--;
+	appInterlockedAdd(&GTotalAllocationSize, -(size_t)oldSize);
+	appInterlockedAdd(&GTotalAllocationCount, -1);
 
 #if PROFILE
-	GNumAllocs++;
+	appInterlockedAdd(&GNumAllocs, 1);
 #endif
 
 	return newData;
@@ -209,13 +230,15 @@ void appFree(void *ptr)
 	assert(hdr->magic == BLOCK_MAGIC);
 	hdr->magic--;		// modify to any value
 #if DEBUG_MEMORY
+	LockDebugMemory();
 	hdr->Unlink();
+	UnlockDebugMemory();
 	memset(ptr, FREE_BLOCK, hdr->blockSize);
 #endif
 
 	// statistics
-	GTotalAllocationSize -= hdr->blockSize;
-	GTotalAllocationCount--;
+	appInterlockedAdd(&GTotalAllocationSize, -(size_t)hdr->blockSize);
+	appInterlockedAdd(&GTotalAllocationCount, -1);
 
 	free(block);
 
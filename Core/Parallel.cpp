@@ -0,0 +1,324 @@
+#include "Core.h"
+#include "Parallel.h"
+
+#if _WIN32
+#define WIN32_LEAN_AND_MEAN			// exclude rarely-used services from windown headers
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>					// for sysconf()
+#endif
+
+#define MAX_THREADS			32
+
+int GNumThreads = 0;
+
+
+int appGetNumThreads()
+{
+	static int NumCores = 0;
+	if (!NumCores)
+	{
+#if _WIN32
+		SYSTEM_INFO si;
+		GetSystemInfo(&si);
+		NumCores = si.dwNumberOfProcessors;
+#else
+		NumCores = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+		NumCores = bound(NumCores, 1, MAX_THREADS);
+	}
+	return (GNumThreads > 0) ? min(GNumThreads, MAX_THREADS) : NumCores;
+}
+
+void appSleep(int msec)
+{
+#if _WIN32
+	Sleep(msec);
+#else
+	usleep(msec * 1000);
+#endif
+}
+
+
+/*-----------------------------------------------------------------------------
+	CMutex
+-----------------------------------------------------------------------------*/
+
+#if _WIN32
+
+CMutex::CMutex()
+{
+	staticAssert(sizeof(Data) >= sizeof(CRITICAL_SECTION), Mutex_Data_Too_Small);
+	InitializeCriticalSection((CRITICAL_SECTION*)Data);
+}
+
+CMutex::~CMutex()
+{
+	DeleteCriticalSection((CRITICAL_SECTION*)Data);
+}
+
+void CMutex::Lock()
+{
+	EnterCriticalSection((CRITICAL_SECTION*)Data);
+}
+
+void CMutex::Unlock()
+{
+	LeaveCriticalSection((CRITICAL_SECTION*)Data);
+}
+
+#else // _WIN32
+
+CMutex::CMutex()
+{
+	staticAssert(sizeof(Data) >= sizeof(pthread_mutex_t), Mutex_Data_Too_Small);
+	// make it recursive, like CRITICAL_SECTION
+	pthread_mutexattr_t Attr;
+	pthread_mutexattr_init(&Attr);
+	pthread_mutexattr_settype(&Attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init((pthread_mutex_t*)Data, &Attr);
+	pthread_mutexattr_destroy(&Attr);
+}
+
+CMutex::~CMutex()
+{
+	pthread_mutex_destroy((pthread_mutex_t*)Data);
+}
+
+void CMutex::Lock()
+{
+	pthread_mutex_lock((pthread_mutex_t*)Data);
+}
+
+void CMutex::Unlock()
+{
+	pthread_mutex_unlock((pthread_mutex_t*)Data);
+}
+
+#endif // _WIN32
+
+
+/*-----------------------------------------------------------------------------
+	CCondition
+-----------------------------------------------------------------------------*/
+
+#if _WIN32
+
+CCondition::CCondition()
+{
+	staticAssert(sizeof(Data) >= sizeof(CONDITION_VARIABLE), Condition_Data_Too_Small);
+	InitializeConditionVariable((CONDITION_VARIABLE*)Data);
+}
+
+CCondition::~CCondition()
+{}
+
+void CCondition::Wait(CMutex &Mutex)
+{
+	SleepConditionVariableCS((CONDITION_VARIABLE*)Data, (CRITICAL_SECTION*)Mutex.Data, INFINITE);
+}
+
+void CCondition::SignalAll()
+{
+	WakeAllConditionVariable((CONDITION_VARIABLE*)Data);
+}
+
+#else // _WIN32
+
+CCondition::CCondition()
+{
+	staticAssert(sizeof(Data) >= sizeof(pthread_cond_t), Condition_Data_Too_Small);
+	pthread_cond_init((pthread_cond_t*)Data, NULL);
+}
+
+CCondition::~CCondition()
+{
+	pthread_cond_destroy((pthread_cond_t*)Data);
+}
+
+void CCondition::Wait(CMutex &Mutex)
+{
+	pthread_cond_wait((pthread_cond_t*)Data, (pthread_mutex_t*)Mutex.Data);
+}
+
+void CCondition::SignalAll()
+{
+	pthread_cond_broadcast((pthread_cond_t*)Data);
+}
+
+#endif // _WIN32
+
+
+/*-----------------------------------------------------------------------------
+	CThread
+-----------------------------------------------------------------------------*/
+
+struct CThreadStartInfo
+{
+	ThreadFunc_t	Func;
+	void			*Param;
+};
+
+#if _WIN32
+
+static DWORD WINAPI ThreadEntry(void *Arg)
+{
+	CThreadStartInfo Info = *(CThreadStartInfo*)Arg;
+	delete (CThreadStartInfo*)Arg;
+	Info.Func(Info.Param);
+	return 0;
+}
+
+#else
+
+static void* ThreadEntry(void *Arg)
+{
+	CThreadStartInfo Info = *(CThreadStartInfo*)Arg;
+	delete (CThreadStartInfo*)Arg;
+	Info.Func(Info.Param);
+	return NULL;
+}
+
+#endif // _WIN32
+
+
+CThread::CThread()
+:	Handle(NULL)
+{}
+
+CThread::~CThread()
+{
+	Join();
+}
+
+void CThread::Start(ThreadFunc_t Func, void *Param)
+{
+	guard(CThread::Start);
+
+	assert(!Handle);
+	CThreadStartInfo *Info = new CThreadStartInfo;
+	Info->Func  = Func;
+	Info->Param = Param;
+#if _WIN32
+	Handle = CreateThread(NULL, 0, ThreadEntry, Info, 0, NULL);
+#else
+	pthread_t *Thread = new pthread_t;
+	if (pthread_create(Thread, NULL, ThreadEntry, Info) == 0)
+		Handle = Thread;
+	else
+		delete Thread;
+#endif
+	if (!Handle)
+	{
+		delete Info;
+		appError("Unable to create a thread");
+	}
+
+	unguard;
+}
+
+void CThread::Join()
+{
+	if (!Handle) return;
+#if _WIN32
+	WaitForSingleObject(Handle, INFINITE);
+	CloseHandle(Handle);
+#else
+	pthread_t *Thread = (pthread_t*)Handle;
+	pthread_join(*Thread, NULL);
+	delete Thread;
+#endif
+	Handle = NULL;
+}
+
+
+/*-----------------------------------------------------------------------------
+	Parallel for
+-----------------------------------------------------------------------------*/
+
+struct CParallelForContext
+{
+	ParallelForFunc_t Func;
+	void			*Param;
+	int				Count;
+	volatile int	NextIndex;
+	volatile int	Failed;
+	char			Error[2048];
+};
+
+// Set for threads which are executing appParallelFor() callbacks
+static THREAD_LOCAL bool InParallelFor = false;
+
+static void ParallelForWorker(void *Arg)
+{
+	CParallelForContext *Ctx = (CParallelForContext*)Arg;
+	InParallelFor = true;
+	// Note: this function shouldn't have objects with destructors because of TRY
+	while (!Ctx->Failed)
+	{
+		int Index = appInterlockedAdd(&Ctx->NextIndex, 1) - 1;
+		if (Index >= Ctx->Count) break;
+		TRY
+		{
+			Ctx->Func(Index, Ctx->Param);
+		}
+		CATCH_CRASH
+		{
+			// keep the first error only
+			if (appInterlockedExchange(&Ctx->Failed, 1) == 0)
+			{
+#if DO_GUARD
+				appStrncpyz(Ctx->Error, GErrorHistory, ARRAY_COUNT(Ctx->Error));
+#else
+				strcpy(Ctx->Error, "Error in a worker thread");
+#endif
+			}
+#if DO_GUARD
+			GErrorHistory[0] = 0;
+#endif
+		}
+	}
+}
+
+void appParallelFor(int Count, ParallelForFunc_t Func, void *Param)
+{
+	guard(appParallelFor);
+
+	int NumThreads = min(appGetNumThreads(), Count);
+	if (NumThreads <= 1 || InParallelFor)
+	{
+		// no threading, or nested call from a callback which already runs in parallel
+		// with others; errors are passed as usual
+		for (int i = 0; i < Count; i++)
+			Func(i, Param);
+		return;
+	}
+
+	CParallelForContext Ctx;
+	Ctx.Func      = Func;
+	Ctx.Param     = Param;
+	Ctx.Count     = Count;
+	Ctx.NextIndex = 0;
+	Ctx.Failed    = 0;
+	Ctx.Error[0]  = 0;
+
+	// current thread works too
+	CThread Threads[MAX_THREADS - 1];
+	for (int i = 0; i < NumThreads - 1; i++)
+		Threads[i].Start(ParallelForWorker, &Ctx);
+	ParallelForWorker(&Ctx);
+	InParallelFor = false;
+	for (int i = 0; i < NumThreads - 1; i++)
+		Threads[i].Join();
+
+	if (Ctx.Failed)
+	{
+		// remove trailing line feed, appError will add it
+		int len = strlen(Ctx.Error);
+		if (len && Ctx.Error[len-1] == '\n') Ctx.Error[len-1] = 0;
+		appError("%s", Ctx.Error);
+	}
+
+	unguard;
+}
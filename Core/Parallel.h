@@ -0,0 +1,154 @@
+#ifndef __PARALLEL_H__
+#define __PARALLEL_H__
+
+/*-----------------------------------------------------------------------------
+	Simple threading primitives
+-----------------------------------------------------------------------------*/
+
+// Maximal number of threads used for parallel work; 0 = use all CPU cores, 1 = don't
+// use threads at all
+extern int GNumThreads;
+
+// Number of threads appParallelFor() will use
+int appGetNumThreads();
+
+// Suspend the calling thread for the given time
+void appSleep(int msec);
+
+
+// Atomic operations, return the resulting value
+
+#if _MSC_VER
+
+FORCEINLINE int appInterlockedAdd(volatile int *Value, int Add)
+{
+	return _InterlockedExchangeAdd((volatile long*)Value, Add) + Add;
+}
+
+FORCEINLINE size_t appInterlockedAdd(volatile size_t *Value, size_t Add)
+{
+#if _WIN64
+	return _InterlockedExchangeAdd64((volatile __int64*)Value, Add) + Add;
+#else
+	return _InterlockedExchangeAdd((volatile long*)Value, Add) + Add;
+#endif
+}
+
+// Returns previous value
+FORCEINLINE int appInterlockedExchange(volatile int *Value, int NewValue)
+{
+	return _InterlockedExchange((volatile long*)Value, NewValue);
+}
+
+#else // _MSC_VER
+
+FORCEINLINE int appInterlockedAdd(volatile int *Value, int Add)
+{
+	return __sync_add_and_fetch(Value, Add);
+}
+
+FORCEINLINE size_t appInterlockedAdd(volatile size_t *Value, size_t Add)
+{
+	return __sync_add_and_fetch(Value, Add);
+}
+
+// Returns previous value
+FORCEINLINE int appInterlockedExchange(volatile int *Value, int NewValue)
+{
+	return __sync_lock_test_and_set(Value, NewValue);
+}
+
+#endif // _MSC_VER
+
+
+// Mutex object. Uses inline storage for the system object, so it doesn't allocate memory
+// and could be used inside memory manager. Mutex is recursive: it could be locked several
+// times by the same thread.
+class CMutex
+{
+public:
+	CMutex();
+	~CMutex();
+	void Lock();
+	void Unlock();
+
+private:
+	int64			Data[8];		// pthread_mutex_t or CRITICAL_SECTION
+
+	friend class CCondition;
+
+	// disable copying
+	CMutex(const CMutex&);
+	CMutex& operator=(const CMutex&);
+};
+
+// Condition variable, used together with CMutex. Wait() should be called with the mutex
+// locked once; the mutex is released while waiting and locked again before returning.
+class CCondition
+{
+public:
+	CCondition();
+	~CCondition();
+	void Wait(CMutex &Mutex);
+	void SignalAll();
+
+private:
+	int64			Data[8];		// pthread_cond_t or CONDITION_VARIABLE
+
+	// disable copying
+	CCondition(const CCondition&);
+	CCondition& operator=(const CCondition&);
+};
+
+class CScopedLock
+{
+public:
+	CScopedLock(CMutex &InMutex)
+	:	Mutex(InMutex)
+	{
+		Mutex.Lock();
+	}
+	~CScopedLock()
+	{
+		Mutex.Unlock();
+	}
+
+private:
+	CMutex			&Mutex;
+};
+
+
+// Thread object. Thread function should not throw exceptions (errors are not passed to
+// the thread which created the object).
+typedef void (*ThreadFunc_t)(void *Param);
+
+class CThread
+{
+public:
+	CThread();
+	~CThread();				// waits for the thread
+	void Start(ThreadFunc_t Func, void *Param);
+	void Join();
+	bool IsRunning() const
+	{
+		return Handle != NULL;
+	}
+
+private:
+	void			*Handle;
+
+	CThread(const CThread&);
+	CThread& operator=(const CThread&);
+};
+
+
+// Call Func(Index, Param) for every Index in [0, Count) range using all available
+// threads. Function returns when all items are processed. When the callback raises an
+// error, the remaining items are not started, and the error is passed to the calling
+// thread. Nested calls made from the callback are executed in the calling thread.
+typedef void (*ParallelForFunc_t)(int Index, void *Param);
+
+void appParallelFor(int Count, ParallelForFunc_t Func, void *Param);
+
+
+#endif // __PARALLEL_H__
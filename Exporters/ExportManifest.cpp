@@ -0,0 +1,411 @@
+#include "Core.h"
+#include "UnCore.h"
+
+#include "UnObject.h"
+#include "UnPackage.h"
+#include "GameFileSystem.h"
+
+#include "Exporters.h"
+
+#include <sys/stat.h>				// for stat()
+#include <fcntl.h>					// for open()
+#if _WIN32
+#include <io.h>						// for write()
+#else
+#include <unistd.h>
+#endif
+
+/*-----------------------------------------------------------------------------
+	Incremental export manifest
+
+	Manifest is a text file placed into the export directory. There is one line
+	(record) per package:
+		<package>\t<size>\t<mtime>\t<guid>\t<options>\t<file1>\t<file2>...
+	Package name is relative to the game root directory, file names are relative
+	to the export directory. Options is a signature of export options used for
+	the package. Records are appended when package export is finished,
+	so the file remains usable when umodel is interrupted. Every record is
+	appended with a single write() to a file opened with O_APPEND, so records
+	from several worker processes sharing the manifest are not interleaved.
+	When the same package appears several times, the last record wins;
+	incomplete last line is ignored. The file is compacted when export is
+	finished.
+-----------------------------------------------------------------------------*/
+
+bool GIncrementalExport = false;
+
+#define MANIFEST_FILENAME		"umodel_manifest.txt"
+#define MANIFEST_HASH_SIZE		4096
+
+struct CManifestRecord
+{
+	FString			Package;
+	int64			Size;
+	int64			Time;			// file modification time, 0 when not available (file in pak etc)
+	FGuid			Guid;
+	uint32			Options;		// signature of export options
+	FString			Files;			// tab-separated list of files, relative to the export directory
+	bool			UpToDate;		// previous record: package was checked and not changed
+	bool			Dirty;			// current record: has changes which weren't written yet
+	int				HashNext;
+};
+
+struct CManifestRecordList
+{
+	TArray<CManifestRecord>	Records;
+	int				Hash[MANIFEST_HASH_SIZE];
+
+	CManifestRecord* Find(const char* Package)
+	{
+		if (!Records.Num()) return NULL;
+		for (int i = Hash[appStrHashNoCase(Package) & (MANIFEST_HASH_SIZE - 1)]; i >= 0; i = Records[i].HashNext)
+		{
+			CManifestRecord& R = Records[i];
+			if (!stricmp(*R.Package, Package)) return &R;
+		}
+		return NULL;
+	}
+
+	CManifestRecord* FindOrAdd(const char* Package)
+	{
+		CManifestRecord* R = Find(Package);
+		if (R) return R;
+		if (!Records.Num())
+		{
+			// we're adding first item here, initialize hash with -1
+			memset(Hash, -1, sizeof(Hash));
+		}
+		int h = appStrHashNoCase(Package) & (MANIFEST_HASH_SIZE - 1);
+		int index = Records.AddZeroed();
+		R = &Records[index];
+		R->Package  = Package;
+		R->HashNext = Hash[h];
+		Hash[h] = index;
+		return R;
+	}
+
+	void Empty()
+	{
+		for (int i = 0; i < Records.Num(); i++)
+		{
+			Records[i].Package.Empty();
+			Records[i].Files.Empty();
+		}
+		Records.Empty();
+	}
+};
+
+static CManifestRecordList OldRecords;		// loaded from existing manifest
+static CManifestRecordList NewRecords;		// packages exported now
+static int ManifestFile = -1;				// file descriptor, opened for appending
+static FString ManifestFilename;
+static uint32 ManifestOptions;				// signature of current export options
+
+
+static bool GetPackageFileStats(const CGameFileInfo* info, int64& Size, int64& Time)
+{
+	if (info->FileSystem)
+	{
+		// file in a virtual file system, no timestamp available
+		Size = info->FileSystem->GetFileSize(info->RelativeName);
+		Time = 0;
+		return true;
+	}
+
+	char Path[MAX_PACKAGE_PATH];
+	appSprintf(ARRAY_ARG(Path), "%s/%s", appGetRootDirectory(), info->RelativeName);
+	// note: using 64-bit 'stat' here because 'stat' ignores large files
+#if _WIN32
+	struct _stati64 buf;
+	if (_stati64(Path, &buf) != 0) return false;
+#else
+	struct stat64 buf;
+	if (stat64(Path, &buf) != 0) return false;
+#endif
+	Size = buf.st_size;
+	Time = buf.st_mtime;
+	return true;
+}
+
+// Format the whole record, including line terminator, into a single string
+static void FormatRecord(const CManifestRecord& R, FString& Line)
+{
+	const FGuid& G = R.Guid;
+	char Header[MAX_PACKAGE_PATH + 128];
+	appSprintf(ARRAY_ARG(Header), "%s\t%lld\t%lld\t%08X%08X%08X%08X\t%08X", *R.Package, (long long)R.Size, (long long)R.Time,
+		G.A, G.B, G.C, G.D, R.Options);
+	Line = Header;
+	if (!R.Files.IsEmpty())
+	{
+		Line += "\t";
+		Line += R.Files;
+	}
+	Line += "\n";
+}
+
+static void WriteRecord(FILE* f, const CManifestRecord& R)
+{
+	FString Line;
+	FormatRecord(R, Line);
+	fputs(*Line, f);
+}
+
+// Append the record to the manifest with a single write() call
+static void AppendRecord(const CManifestRecord& R)
+{
+	FString Line;
+	FormatRecord(R, Line);
+	if (write(ManifestFile, *Line, Line.Len()) != Line.Len())
+		appPrintf("Unable to write manifest \"%s\"\n", *ManifestFilename);
+}
+
+static void ParseManifest(char* Text)
+{
+	guard(ParseManifest);
+
+	char* Line = Text;
+	while (true)
+	{
+		char* End = strchr(Line, '\n');
+		if (!End) break;					// end of data, or incomplete record
+		*End = 0;
+		if (End > Line && End[-1] == '\r') End[-1] = 0;
+
+		if (Line[0] && Line[0] != '#')
+		{
+			// split line to fields
+			char* Fields[4];
+			char* s = Line;
+			int NumFields;
+			for (NumFields = 0; NumFields < 4 && s; NumFields++)
+			{
+				Fields[NumFields] = s;
+				s = strchr(s, '\t');
+				if (s) *s++ = 0;
+			}
+			FGuid G;
+			if (NumFields == 4 && sscanf(Fields[3], "%08X%08X%08X%08X", &G.A, &G.B, &G.C, &G.D) == 4)
+			{
+				CManifestRecord* R = OldRecords.FindOrAdd(Fields[0]);
+				R->Size    = atoll(Fields[1]);
+				R->Time    = atoll(Fields[2]);
+				R->Guid    = G;
+				R->Options = 0;
+				// options field is exactly 8 hex digits; it is missing in manifests of older versions
+				char* OptEnd;
+				uint32 Options = s ? strtoul(s, &OptEnd, 16) : 0;
+				if (s && OptEnd == s + 8 && (*OptEnd == 0 || *OptEnd == '\t'))
+				{
+					R->Options = Options;
+					s = *OptEnd ? OptEnd + 1 : NULL;
+				}
+				R->Files = s ? s : "";
+			}
+		}
+
+		Line = End + 1;
+	}
+
+	unguard;
+}
+
+
+void OpenExportManifest(const char* ExportDir, uint32 OptionsSignature)
+{
+	guard(OpenExportManifest);
+
+	assert(ManifestFile < 0);
+	ManifestFilename = va("%s/%s", ExportDir, MANIFEST_FILENAME);
+	ManifestOptions = OptionsSignature;
+
+	// load previous manifest
+	FILE* f = fopen(*ManifestFilename, "rb");
+	if (f)
+	{
+		fseek(f, 0, SEEK_END);
+		int Size = ftell(f);
+		fseek(f, 0, SEEK_SET);
+		char* Text = (char*)appMalloc(Size + 1);
+		int Read = fread(Text, 1, Size, f);
+		Text[Read] = 0;
+		fclose(f);
+		ParseManifest(Text);
+		appFree(Text);
+		appPrintf("Loaded export manifest: %d package(s)\n", OldRecords.Records.Num());
+	}
+
+	// open manifest for appending
+	appMakeDirectoryForFile(*ManifestFilename);
+#if _WIN32
+	ManifestFile = open(*ManifestFilename, O_WRONLY | O_APPEND | O_CREAT | O_BINARY, S_IREAD | S_IWRITE);
+#else
+	ManifestFile = open(*ManifestFilename, O_WRONLY | O_APPEND | O_CREAT, 0666);
+#endif
+	if (ManifestFile < 0)
+		appPrintf("Unable to open manifest \"%s\"\n", *ManifestFilename);
+
+	unguard;
+}
+
+
+bool IsPackageExported(const CGameFileInfo* info, const UnPackage* Package)
+{
+	guard(IsPackageExported);
+
+	if (ManifestFile < 0) return false;
+
+	int64 Size, Time;
+	if (!GetPackageFileStats(info, Size, Time)) return false;
+
+	CManifestRecord* Old = OldRecords.Find(info->RelativeName);
+	if (Old && Old->Size == Size && Old->Options == ManifestOptions)
+	{
+		bool Unchanged = false;
+		if (Time)
+		{
+			Unchanged = (Old->Time == Time);
+		}
+		else if (Package)
+		{
+			// no timestamp, compare package GUIDs
+			static const FGuid NullGuid = { 0, 0, 0, 0 };
+			const FGuid& G = Package->Summary.Guid;
+			Unchanged = !(G == NullGuid) && (G == Old->Guid);
+		}
+		if (Unchanged)
+		{
+			Old->UpToDate = true;
+			return true;
+		}
+	}
+
+	if (Package)
+	{
+		// this package will be exported
+		CManifestRecord* R = NewRecords.FindOrAdd(info->RelativeName);
+		R->Size  = Size;
+		R->Time  = Time;
+		R->Guid  = Package->Summary.Guid;
+		R->Options = ManifestOptions;
+		R->Dirty = true;
+	}
+	return false;
+
+	unguardf("%s", info->RelativeName);
+}
+
+
+void RegisterManifestFile(const UnPackage* Package, const char* RelativeName)
+{
+	if (ManifestFile < 0) return;
+	CManifestRecord* R = NewRecords.Find(Package->Filename);
+	if (!R) return;			// object from the package which is not exported as a whole
+	if (!R->Files.IsEmpty()) R->Files += "\t";
+	R->Files += RelativeName;
+	R->Dirty = true;
+}
+
+
+void FinishPackageExport(const UnPackage* Package)
+{
+	if (ManifestFile < 0) return;
+	CManifestRecord* R = NewRecords.Find(Package->Filename);
+	if (!R || !R->Dirty) return;
+	AppendRecord(*R);
+	R->Dirty = false;
+}
+
+
+// Returns true if tab-separated list contains the file
+static bool ListContainsFile(const char* List, const char* File, int FileLen)
+{
+	for (const char* s = List; *s; )
+	{
+		const char* e = strchr(s, '\t');
+		int len = e ? e - s : strlen(s);
+		if (len == FileLen && !strnicmp(s, File, len)) return true;
+		if (!e) break;
+		s = e + 1;
+	}
+	return false;
+}
+
+static void ReportStaleFiles(const char* OldFiles, const char* NewFiles, int& NumStale)
+{
+	for (const char* s = OldFiles; *s; )
+	{
+		const char* e = strchr(s, '\t');
+		int len = e ? e - s : strlen(s);
+		if (len && !ListContainsFile(NewFiles, s, len))
+		{
+			appPrintf("Stale file: %.*s\n", len, s);
+			NumStale++;
+		}
+		if (!e) break;
+		s = e + 1;
+	}
+}
+
+
+void CloseExportManifest()
+{
+	guard(CloseExportManifest);
+
+	if (ManifestFile < 0) return;
+
+	// flush records which weren't finished explicitly
+	for (int i = 0; i < NewRecords.Records.Num(); i++)
+		if (NewRecords.Records[i].Dirty) AppendRecord(NewRecords.Records[i]);
+	close(ManifestFile);
+	ManifestFile = -1;
+
+	// report files from previous export which weren't produced now
+	int NumStale = 0;
+	for (int i = 0; i < OldRecords.Records.Num(); i++)
+	{
+		CManifestRecord& Old = OldRecords.Records[i];
+		if (Old.UpToDate) continue;
+		const CManifestRecord* New = NewRecords.Find(*Old.Package);
+		if (New)
+		{
+			// package was re-exported
+			ReportStaleFiles(*Old.Files, *New->Files, NumStale);
+			continue;
+		}
+		const CGameFileInfo* info = appFindGameFile(*Old.Package);
+		if (!info || stricmp(info->RelativeName, *Old.Package) != 0)
+		{
+			// package was removed or renamed
+			appPrintf("Stale package: %s\n", *Old.Package);
+			ReportStaleFiles(*Old.Files, "", NumStale);
+			Old.Package.Empty();		// mark as removed
+		}
+	}
+	if (NumStale)
+		appPrintf("Found %d stale file(s)\n", NumStale);
+
+	// compact the manifest: write all actual records into a new file, then replace the old one
+	char TempFilename[1024];
+	appSprintf(ARRAY_ARG(TempFilename), "%s.tmp", *ManifestFilename);
+	FILE* f = fopen(TempFilename, "w");
+	if (f)
+	{
+		fprintf(f, "# umodel export manifest\n");
+		for (int i = 0; i < OldRecords.Records.Num(); i++)
+		{
+			const CManifestRecord& Old = OldRecords.Records[i];
+			if (!Old.Package.IsEmpty() && !NewRecords.Find(*Old.Package))
+				WriteRecord(f, Old);
+		}
+		for (int i = 0; i < NewRecords.Records.Num(); i++)
+			WriteRecord(f, NewRecords.Records[i]);
+		fclose(f);
+		remove(*ManifestFilename);
+		rename(TempFilename, *ManifestFilename);
+	}
+
+	OldRecords.Empty();
+	NewRecords.Empty();
+
+	unguard;
+}
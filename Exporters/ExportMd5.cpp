@@ -1,5 +1,6 @@
 #include "Core.h"
 #include "UnCore.h"
+#include "Parallel.h"
 
 #include "UnObject.h"
 #include "UnMaterial.h"
@@ -291,84 +292,138 @@ if (i == 32 || i == 34)
 }
 
 
-void ExportMd5Anim(const CAnimSet *Anim)
+static void WriteMd5Anim(const CAnimSet *Anim, const CAnimSequence &S, const CAnimBoneKey *SeqKeys, FArchive *Ar)
 {
-	guard(ExportMd5Anim);
+	guard(WriteMd5Anim);
 
 	int numBones = Anim->TrackBoneNames.Num();
-	UObject *OriginalAnim = Anim->OriginalAnim;
+	int i;
 
-	for (int AnimIndex = 0; AnimIndex < Anim->Sequences.Num(); AnimIndex++)
-	{
-		int i;
-		const CAnimSequence &S = *Anim->Sequences[AnimIndex];
+	Ar->Printf(
+		"MD5Version 10\n"
+		"commandline \"Created with UE Viewer\"\n"
+		"\n"
+		"numFrames %d\n"
+		"numJoints %d\n"
+		"frameRate %g\n"
+		"numAnimatedComponents %d\n"
+		"\n",
+		S.NumFrames,
+		numBones,
+		S.Rate,
+		numBones * 6
+	);
 
-		FArchive *Ar = CreateExportArchive(OriginalAnim, "%s/%s.md5anim", OriginalAnim->Name, *S.Name);
-		if (!Ar) continue;
+	// skeleton
+	Ar->Printf("hierarchy {\n");
+	for (i = 0; i < numBones; i++)
+	{
+		Ar->Printf("\t\"%s\" %d %d %d\n", *Anim->TrackBoneNames[i], (i == 0) ? -1 : 0, 63, i * 6);
+			// ParentIndex is unknown for UAnimSet, so always write "0"
+			// here: 6 is number of components per frame, 63 = (1<<6)-1 -- flags "all components are used"
+	}
 
-		Ar->Printf(
-			"MD5Version 10\n"
-			"commandline \"Created with UE Viewer\"\n"
-			"\n"
-			"numFrames %d\n"
-			"numJoints %d\n"
-			"frameRate %g\n"
-			"numAnimatedComponents %d\n"
-			"\n",
-			S.NumFrames,
-			numBones,
-			S.Rate,
-			numBones * 6
-		);
+	// bounds
+	Ar->Printf("}\n\nbounds {\n");
+	for (i = 0; i < S.NumFrames; i++)
+		Ar->Printf("\t( -100 -100 -100 ) ( 100 100 100 )\n");	//!! dummy
+	Ar->Printf("}\n\n");
 
-		// skeleton
-		Ar->Printf("hierarchy {\n");
-		for (i = 0; i < numBones; i++)
+	// baseframe and frames
+	for (int Frame = -1; Frame < S.NumFrames; Frame++)
+	{
+		int t = Frame;
+		if (Frame == -1)
 		{
-			Ar->Printf("\t\"%s\" %d %d %d\n", *Anim->TrackBoneNames[i], (i == 0) ? -1 : 0, 63, i * 6);
-				// ParentIndex is unknown for UAnimSet, so always write "0"
-				// here: 6 is number of components per frame, 63 = (1<<6)-1 -- flags "all components are used"
+			Ar->Printf("baseframe {\n");
+			t = 0;
 		}
+		else
+			Ar->Printf("frame %d {\n", Frame);
 
-		// bounds
-		Ar->Printf("}\n\nbounds {\n");
-		for (i = 0; i < S.NumFrames; i++)
-			Ar->Printf("\t( -100 -100 -100 ) ( 100 100 100 )\n");	//!! dummy
-		Ar->Printf("}\n\n");
-
-		// baseframe and frames
-		for (int Frame = -1; Frame < S.NumFrames; Frame++)
+		for (int b = 0; b < numBones; b++)
 		{
-			int t = Frame;
-			if (Frame == -1)
+			CVec3 BP;
+			CQuat BO;
+			if (t < S.NumFrames)
 			{
-				Ar->Printf("baseframe {\n");
-				t = 0;
+				const CAnimBoneKey &K = SeqKeys[t * numBones + b];
+				BP = K.Position;
+				BO = K.Orientation;
 			}
 			else
-				Ar->Printf("frame %d {\n", Frame);
-
-			for (int b = 0; b < numBones; b++)
 			{
-				CVec3 BP;
-				CQuat BO;
+				// baseframe of empty sequence, it has no baked keys
+				BP.Set(0, 0, 0);
+				BO.Set(0, 0, 0, 1);
 				S.Tracks[b].GetBonePosition(t, S.NumFrames, false, BP, BO);
-				if (!b) BO.Conjugate();			// root bone
+			}
+			if (!b) BO.Conjugate();			// root bone
 #if MIRROR_MESH
-				BO.y  *= -1;
-				BO.w  *= -1;
-				BP[1] *= -1;					// y
+			BO.y  *= -1;
+			BO.w  *= -1;
+			BP[1] *= -1;					// y
 #endif
-				if (BO.w < 0) BO.Negate();		// W-component of quaternion will be removed ...
-				if (Frame < 0)
-					Ar->Printf("\t( %f %f %f ) ( %.10f %.10f %.10f )\n", VECTOR_ARG(BP), BO.x, BO.y, BO.z);
-				else
-					Ar->Printf("\t%f %f %f %.10f %.10f %.10f\n", VECTOR_ARG(BP), BO.x, BO.y, BO.z);
-			}
-			Ar->Printf("}\n\n");
+			if (BO.w < 0) BO.Negate();		// W-component of quaternion will be removed ...
+			if (Frame < 0)
+				Ar->Printf("\t( %f %f %f ) ( %.10f %.10f %.10f )\n", VECTOR_ARG(BP), BO.x, BO.y, BO.z);
+			else
+				Ar->Printf("\t%f %f %f %.10f %.10f %.10f\n", VECTOR_ARG(BP), BO.x, BO.y, BO.z);
+		}
+		Ar->Printf("}\n\n");
+	}
+
+	unguardf("%s", *S.Name);
+}
+
+
+void ExportMd5Anim(const CAnimSet *Anim)
+{
+	guard(ExportMd5Anim);
+
+	int numBones = Anim->TrackBoneNames.Num();
+	int numSeqs = Anim->Sequences.Num();
+	UObject *OriginalAnim = Anim->OriginalAnim;
+
+	// Sequences are processed in batches. Files are opened before sampling, so sequences
+	// skipped by CreateExportArchive() are not sampled, and only keys of the current batch
+	// are kept in memory.
+	int batchSize = appGetNumThreads();
+	TArray<FArchive*> Archives;
+	TArray<int> SeqIndices, FirstKey;
+	TArray<CAnimBoneKey*> SeqKeys;
+	TArray<CAnimBoneKey> Keys;
+	for (int FirstSeq = 0; FirstSeq < numSeqs; FirstSeq += batchSize)
+	{
+		Archives.Empty(batchSize);
+		SeqIndices.Empty(batchSize);
+		FirstKey.Empty(batchSize);
+		int numKeys = 0;
+		for (int AnimIndex = FirstSeq; AnimIndex < min(FirstSeq + batchSize, numSeqs); AnimIndex++)
+		{
+			const CAnimSequence &S = *Anim->Sequences[AnimIndex];
+			FArchive *Ar = CreateExportArchive(OriginalAnim, "%s/%s.md5anim", OriginalAnim->Name, *S.Name);
+			if (!Ar) continue;
+			Archives.Add(Ar);
+			SeqIndices.Add(AnimIndex);
+			FirstKey.Add(numKeys);
+			numKeys += S.NumFrames * numBones;
 		}
+		if (!Archives.Num()) continue;
+
+		// sample the batch
+		Keys.Empty(numKeys);
+		Keys.AddUninitialized(numKeys);
+		SeqKeys.Empty(Archives.Num());
+		for (int i = 0; i < Archives.Num(); i++)
+			SeqKeys.Add(Keys.GetData() + FirstKey[i]);
+		Anim->BakeKeys(SeqIndices.Num(), SeqIndices.GetData(), SeqKeys.GetData(), sizeof(CAnimBoneKey));
 
-		delete Ar;
+		for (int i = 0; i < Archives.Num(); i++)
+		{
+			WriteMd5Anim(Anim, *Anim->Sequences[SeqIndices[i]], SeqKeys[i], Archives[i]);
+			delete Archives[i];
+		}
 	}
 
 	unguard;
@@ -282,12 +282,7 @@ static void ExportSkeletalMeshLod(const CSkeletalMesh &Mesh, const CSkelMeshLod
 		memset(&B, 0, sizeof(B));
 		const CSkelMeshBone &S = Mesh.RefSkeleton[i];
 		strcpy(B.Name, S.Name);
-		// count NumChildren
-		int NumChildren = 0;
-		for (j = 0; j < numBones; j++)
-			if ((j != i) && (Mesh.RefSkeleton[j].ParentIndex == i))
-				NumChildren++;
-		B.NumChildren = NumChildren;
+		B.NumChildren = Mesh.Hierarchy.Bones[i].NumChildren;
 		B.ParentIndex = S.ParentIndex;
 		B.BonePos.Position    = (FVector&) S.Position;
 		B.BonePos.Orientation = (FQuat&)   S.Orientation;
@@ -461,41 +456,49 @@ void ExportPsa(const CAnimSet *Anim)
 	KeyHdr.DataCount = keysCount;
 	KeyHdr.DataSize  = sizeof(VQuatAnimKey);
 	SAVE_CHUNK(KeyHdr, "ANIMKEYS");
-	bool requireConfig = false;
+
+	// VQuatAnimKey has no padding, so the whole chunk is written at once. It starts with the
+	// same fields as CAnimBoneKey, so sequences are sampled directly into it.
+	staticAssert(sizeof(VQuatAnimKey) == 32, VQuatAnimKey_Size);
+	staticAssert(offsetof(VQuatAnimKey, Orientation) == offsetof(CAnimBoneKey, Orientation), VQuatAnimKey_Layout);
+	TArray<VQuatAnimKey> Keys;
+	Keys.AddUninitialized(keysCount);
+	TArray<int> SeqIndices;
+	TArray<CAnimBoneKey*> SeqKeys;
+	SeqIndices.AddUninitialized(numAnims);
+	SeqKeys.AddUninitialized(numAnims);
+	int firstKey = 0;
 	for (i = 0; i < numAnims; i++)
 	{
-		const CAnimSequence &S = *Anim->Sequences[i];
-		for (int t = 0; t < S.NumFrames; t++)
-		{
-			for (int b = 0; b < numBones; b++)
-			{
-				VQuatAnimKey K;
-				CVec3 BP;
-				CQuat BO;
-
-				BP.Set(0, 0, 0);			// GetBonePosition() will not alter BP and BO when animation tracks are not exists
-				BO.Set(0, 0, 0, 1);
-				S.Tracks[b].GetBonePosition(t, S.NumFrames, false, BP, BO);
-
-				K.Position    = (FVector&) BP;
-				K.Orientation = (FQuat&)   BO;
-				K.Time        = 1;
+		SeqIndices[i] = i;
+		SeqKeys[i]    = (CAnimBoneKey*)(Keys.GetData() + firstKey);
+		firstKey += Anim->Sequences[i]->NumFrames * numBones;
+	}
+	Anim->BakeKeys(numAnims, SeqIndices.GetData(), SeqKeys.GetData(), sizeof(VQuatAnimKey));
+	for (i = 0; i < keysCount; i++)
+	{
+		VQuatAnimKey &K = Keys[i];
+		K.Time        = 1;
 #if MIRROR_MESH
-				K.Orientation.Y *= -1;
-				K.Orientation.W *= -1;
-				K.Position.Y    *= -1;
+		K.Orientation.Y *= -1;
+		K.Orientation.W *= -1;
+		K.Position.Y    *= -1;
 #endif
+	}
+	Ar.Serialize(Keys.GetData(), keysCount * sizeof(VQuatAnimKey));
 
-				Ar << K;
-				keysCount--;
-
-				// check for user error
-				if ((S.Tracks[b].KeyPos.Num() == 0) || (S.Tracks[b].KeyQuat.Num() == 0))
-					requireConfig = true;
-			}
+	// check for user error
+	bool requireConfig = false;
+	for (i = 0; i < numAnims; i++)
+	{
+		const CAnimSequence &S = *Anim->Sequences[i];
+		if (!S.NumFrames) continue;
+		for (int b = 0; b < numBones; b++)
+		{
+			if ((S.Tracks[b].KeyPos.Num() == 0) || (S.Tracks[b].KeyQuat.Num() == 0))
+				requireConfig = true;
 		}
 	}
-	assert(keysCount == 0);
 
 	// psa file is done
 	delete Ar0;
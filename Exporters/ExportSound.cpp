@@ -10,6 +10,21 @@
 #define XMA_EXPORT		1
 
 
+// Detect file extension using first bytes of sound data
+static const char *GetSoundExtension(const void *Data, const char *DefExt)
+{
+	if (!memcmp(Data, "OggS", 4))
+		return "ogg";
+	else if (!memcmp(Data, "RIFF", 4))
+		return "wav";
+	else if (!memcmp(Data, "FSB4", 4))
+		return "fsb";		// FMOD sound bank
+	else if (!memcmp(Data, "MSFC", 4))
+		return "mp3";		// PS3 MP3 codec
+	return DefExt;
+}
+
+
 static void SaveSound(const UObject *Obj, void *Data, int DataSize, const char *DefExt)
 {
 	// check for enough place for header
@@ -19,16 +34,7 @@ static void SaveSound(const UObject *Obj, void *Data, int DataSize, const char *
 		return;
 	}
 
-	const char *ext = DefExt;
-
-	if (!memcmp(Data, "OggS", 4))
-		ext = "ogg";
-	else if (!memcmp(Data, "RIFF", 4))
-		ext = "wav";
-	else if (!memcmp(Data, "FSB4", 4))
-		ext = "fsb";		// FMOD sound bank
-	else if (!memcmp(Data, "MSFC", 4))
-		ext = "mp3";		// PS3 MP3 codec
+	const char *ext = GetSoundExtension(Data, DefExt);
 
 	FArchive *Ar = CreateExportArchive(Obj, "%s.%s", Obj->Name, ext);
 	if (Ar)
@@ -39,6 +45,35 @@ static void SaveSound(const UObject *Obj, void *Data, int DataSize, const char *
 }
 
 
+#if UNREAL3
+
+// Save sound from bulk data. Data which is not loaded yet is copied from the package
+// file directly, so large sounds are never loaded into memory.
+static void SaveSound(const UObject *Obj, const FByteBulkData &Bulk, int Offset, const char *DefExt)
+{
+	int DataSize = Bulk.ElementCount - Offset;
+	// check for enough place for header
+	if (DataSize < 16)
+	{
+		appPrintf("... empty sound %s ?\n", Obj->Name);
+		return;
+	}
+
+	byte Header[16];
+	Bulk.ReadData(Offset, Header, sizeof(Header));
+	const char *ext = GetSoundExtension(Header, DefExt);
+
+	FArchive *Ar = CreateExportArchive(Obj, "%s.%s", Obj->Name, ext);
+	if (Ar)
+	{
+		Bulk.WriteData(*Ar, Offset, DataSize);
+		delete Ar;
+	}
+}
+
+#endif // UNREAL3
+
+
 #if XMA_EXPORT
 
 static void WriteRiffHeader(FArchive &Ar, int FileLength)
@@ -229,7 +264,7 @@ void ExportSoundNodeWave(const USoundNodeWave *Snd)
 		bulk = &Snd->CompressedXbox360Data;
 		ext  = "x360audio";
 #if XMA_EXPORT
-		if (SaveXMASound(Snd, bulk->BulkData, bulk->ElementCount, "xma")) return;
+		if (SaveXMASound(Snd, bulk->GetData(), bulk->ElementCount, "xma")) return;
 		// else - detect format by data tags, like for PC
 #endif
 	}
@@ -244,7 +279,7 @@ void ExportSoundNodeWave(const USoundNodeWave *Snd)
 		//!! data encoded in MP3 format
 	}
 
-	SaveSound(Snd, OffsetPointer(bulk->BulkData, extraHeaderSize), bulk->ElementCount - extraHeaderSize, ext);
+	SaveSound(Snd, *bulk, extraHeaderSize, ext);
 }
 
 #endif // UNREAL3
@@ -268,7 +303,7 @@ void ExportSoundWave4(const USoundWave *Snd)
 		ext = *Snd->CompressedFormatData[0].FormatName; // "OGG"
 	}
 
-	SaveSound(Snd, bulk->BulkData, bulk->ElementCount, ext);
+	SaveSound(Snd, *bulk, 0, ext);
 }
 
 #endif // UNREAL4
@@ -4,6 +4,7 @@
 #include "UnCore.h"
 #include "UnObject.h"
 #include "UnMaterial.h"
+#include "TexturePrepare.h"
 
 #include "Exporters.h"
 
@@ -238,6 +239,9 @@ void ExportTexture(const UUnrealMaterial *Tex)
 	byte *pic = NULL;
 	int width, height;
 
+	// the texture could be prepared for rendering in a worker thread
+	CancelTexturePreparation(Tex);
+
 	CTextureData TexData;
 	if (Tex->GetTextureData(TexData))
 	{
@@ -12,6 +12,8 @@ bool GExportScripts      = false;
 bool GExportLods         = false;
 bool GDontOverwriteFiles = false;
 
+static char BaseExportDir[512];
+
 
 /*-----------------------------------------------------------------------------
 	Exporter function management
@@ -23,22 +25,37 @@ struct CExporterInfo
 {
 	const char		*ClassName;
 	ExporterFunc_t	Func;
+	ExportFileNamesFunc_t FileNames;
 };
 
 static CExporterInfo exporters[MAX_EXPORTERS];
 static int numExporters = 0;
 
-void RegisterExporter(const char *ClassName, ExporterFunc_t Func)
+void RegisterExporter(const char *ClassName, ExporterFunc_t Func, ExportFileNamesFunc_t FileNames)
 {
 	guard(RegisterExporter);
 	assert(numExporters < MAX_EXPORTERS);
 	CExporterInfo &Info = exporters[numExporters];
 	Info.ClassName = ClassName;
 	Info.Func      = Func;
+	Info.FileNames = FileNames;
 	numExporters++;
 	unguard;
 }
 
+static const CExporterInfo* FindExporter(const CTypeInfo *Type)
+{
+	for (int i = 0; i < numExporters; i++)
+		if (Type->IsA(exporters[i].ClassName)) return &exporters[i];
+	return NULL;
+}
+
+static const CExporterInfo* FindExporter(const char *ClassName)
+{
+	const CTypeInfo *Type = FindClassType(ClassName);
+	return Type ? FindExporter(Type) : NULL;
+}
+
 
 // List of already exported objects
 
@@ -68,8 +85,11 @@ struct ExportedObjectEntry
 static TArray<ExportedObjectEntry> ProcessedObjects;
 static int ProcessedObjectHash[EXPORTED_LIST_HASH_SIZE];
 
+static void ProcessDuplicateExports();
+
 void ResetExportedList()
 {
+	ProcessDuplicateExports();
 	ProcessedObjects.Empty(1024);
 }
 
@@ -121,6 +141,342 @@ static bool RegisterProcessedObject(const UObject* Obj)
 }
 
 
+/*-----------------------------------------------------------------------------
+	Content-based duplicate detection
+-----------------------------------------------------------------------------*/
+
+int GDedupExports = DEDUP_NONE;
+
+#define CONTENT_HASH_SIZE		4096
+
+struct ContentEntry
+{
+	UnPackage*		Package;
+	int				ExportIndex;
+	int				SerialSize;
+	uint64			Fingerprint;
+	int				Original;		// index of the first entry with the same content, -1 when this entry is the first one
+	char*			ExportPath;		// allocated with appStrdup; set for duplicates and for exported originals
+	int				HashNext;		// next entry with the same fingerprint hash
+	int				ObjHashNext;	// next entry with the same Package/ExportIndex hash
+
+	int GetHash() const
+	{
+		return (int)(Fingerprint ^ (Fingerprint >> 32)) & (CONTENT_HASH_SIZE - 1);
+	}
+
+	static int GetObjHash(const UnPackage* Package, int ExportIndex)
+	{
+		return ( ((size_t)Package >> 3) ^ ExportIndex ^ (ExportIndex << 4) ) & (CONTENT_HASH_SIZE - 1);
+	}
+};
+
+// File written for the object which has duplicates
+struct ProducedFile
+{
+	int				Entry;			// index in ContentEntries
+	char*			Name;			// relative to ContentEntry.ExportPath, allocated with appStrdup
+};
+
+static TArray<ContentEntry> ContentEntries;
+static TArray<ProducedFile> ProducedFiles;
+static int ContentHash[CONTENT_HASH_SIZE];
+static int ContentObjHash[CONTENT_HASH_SIZE];
+
+// FNV-1a hash
+static uint64 HashBytes(uint64 Hash, const void *Data, int Size)
+{
+	const byte *p = (const byte*)Data;
+	for (int i = 0; i < Size; i++)
+	{
+		Hash ^= p[i];
+		Hash *= 0x100000001B3ULL;
+	}
+	return Hash;
+}
+
+// Returns true when the export is a copy of an object from another package, placed into
+// this package by cooker (UE3 forced export)
+static bool IsCookedCopy(const UnPackage *Package, const FObjectExport &Exp)
+{
+#if UNREAL3
+	if (Package->Game < GAME_UE3) return false;
+	// find the outermost package, it is marked as forced export
+	const FObjectExport *Outer = &Exp;
+	while (Outer->PackageIndex > 0)
+		Outer = &Package->GetExport(Outer->PackageIndex - 1);
+	return (Outer != &Exp) && (Outer->PackageIndex == 0) && (Outer->ExportFlags & EF_ForcedExport);
+#else
+	return false;
+#endif
+}
+
+// Fingerprint is computed from the export table only, the object data is not read. Copies
+// of the same object cooked into different packages have the same class, the same path in
+// the source package (including the source package name) and the same serialized size.
+// Serialized data itself is not comparable between packages: it refers names and objects
+// with package-local indices, and inline bulk data has package-local offsets.
+static uint64 GetExportFingerprint(const UnPackage *Package, int ExportIndex)
+{
+	guard(GetExportFingerprint);
+
+	const FObjectExport &Exp = Package->GetExport(ExportIndex);
+	uint64 Hash = 0xCBF29CE484222325ULL;
+
+	const char *Name = Package->GetObjectName(Exp.ClassIndex);
+	Hash = HashBytes(Hash, Name, strlen(Name) + 1);
+	char FullName[1024];
+	Package->GetFullExportName(Exp, ARRAY_ARG(FullName));
+	Hash = HashBytes(Hash, FullName, strlen(FullName) + 1);
+	Hash = HashBytes(Hash, &Exp.SerialSize, sizeof(Exp.SerialSize));
+
+	return Hash;
+
+	unguardf("%s:%d", Package->Filename, ExportIndex);
+}
+
+static const char* GetExportPath(const UnPackage *Package, int ExportIndex, const char *ObjName, const char *ClassName);
+
+// Export path for the object which is possibly not loaded yet
+static const char* GetExportPath(const UnPackage *Package, int ExportIndex)
+{
+	const FObjectExport &Exp = Package->GetExport(ExportIndex);
+	const CTypeInfo *Type = FindClassType(Package->GetObjectName(Exp.ClassIndex));
+	assert(Type);
+	return GetExportPath(Package, ExportIndex, Exp.ObjectName, Type->Name + 1);
+}
+
+static int FindContentEntry(const UnPackage *Package, int ExportIndex)
+{
+	if (!ContentEntries.Num()) return -1;
+
+	const ContentEntry *E;
+	for (int i = ContentObjHash[ContentEntry::GetObjHash(Package, ExportIndex)]; i >= 0; i = E->ObjHashNext)
+	{
+		E = &ContentEntries[i];
+		if (E->Package == Package && E->ExportIndex == ExportIndex)
+			return i;
+	}
+	return -1;
+}
+
+// Returns index of ContentEntry for the export, or -1 when this export is not a subject
+// for duplicate detection
+static int GetContentEntry(UnPackage *Package, int ExportIndex)
+{
+	guard(GetContentEntry);
+
+	int index = FindContentEntry(Package, ExportIndex);
+	if (index >= 0) return index;
+
+	const FObjectExport &Exp = Package->GetExport(ExportIndex);
+	if (Exp.SerialSize <= 0 || !strnicmp(Exp.ObjectName, "Default__", 9))
+		return -1;
+	if (!IsCookedCopy(Package, Exp))
+		return -1;					// object is stored in this package only
+	if (!FindExporter(Package->GetObjectName(Exp.ClassIndex)))
+		return -1;
+
+	if (ContentEntries.Num() == 0)
+	{
+		// we're adding first item here, initialize hash with -1
+		memset(ContentHash, -1, sizeof(ContentHash));
+		memset(ContentObjHash, -1, sizeof(ContentObjHash));
+	}
+
+	ContentEntry entry;
+	entry.Package     = Package;
+	entry.ExportIndex = ExportIndex;
+	entry.SerialSize  = Exp.SerialSize;
+	entry.Fingerprint = GetExportFingerprint(Package, ExportIndex);
+	entry.Original    = -1;
+	entry.ExportPath  = NULL;
+
+	int h = entry.GetHash();
+	const ContentEntry *E;
+	for (int i = ContentHash[h]; i >= 0; i = E->HashNext)
+	{
+		E = &ContentEntries[i];
+		if (E->Fingerprint == entry.Fingerprint && E->SerialSize == entry.SerialSize && E->Original < 0)
+		{
+			entry.Original = i;
+			break;
+		}
+	}
+	if (entry.Original >= 0)
+	{
+		const ContentEntry &Orig = ContentEntries[entry.Original];
+		appPrintf("Skipping %s %s from %s: duplicate of object from %s\n",
+			Package->GetObjectName(Exp.ClassIndex), *Exp.ObjectName, Package->Filename, Orig.Package->Filename);
+		entry.ExportPath = appStrdup(GetExportPath(Package, ExportIndex));
+	}
+
+	index = ContentEntries.Add(entry);
+	ContentEntries[index].HashNext = ContentHash[h];
+	ContentHash[h] = index;
+	int h2 = ContentEntry::GetObjHash(Package, ExportIndex);
+	ContentEntries[index].ObjHashNext = ContentObjHash[h2];
+	ContentObjHash[h2] = index;
+
+	return index;
+
+	unguardf("%s:%d", Package->Filename, ExportIndex);
+}
+
+bool IsDuplicateExport(UnPackage* Package, int ExportIndex)
+{
+	if (GDedupExports == DEDUP_NONE) return false;
+	int index = GetContentEntry(Package, ExportIndex);
+	return (index >= 0) && (ContentEntries[index].Original >= 0);
+}
+
+// Remember the file written for exported object, it will be used for its duplicates
+static void RegisterProducedFile(const UnPackage *Package, int ExportIndex, const char *filename)
+{
+	int index = FindContentEntry(Package, ExportIndex);
+	if (index < 0) return;
+	ContentEntry &E = ContentEntries[index];
+	if (E.Original >= 0) return;
+	if (!E.ExportPath)
+		E.ExportPath = appStrdup(GetExportPath(Package, ExportIndex));
+	int len = strlen(E.ExportPath);
+	if (strncmp(filename, E.ExportPath, len) != 0 || filename[len] != '/')
+		return;
+	ProducedFile *F = new (ProducedFiles) ProducedFile;
+	F->Entry = index;
+	F->Name  = appStrdup(filename + len + 1);
+}
+
+// Register the file which was created for the object (now or in previous export session)
+static void RegisterExportedFile(const UObject *Obj, const char *filename)
+{
+	if (!Obj->Package || Obj->PackageIndex < 0) return;
+	RegisterProducedFile(Obj->Package, Obj->PackageIndex, filename);
+	RegisterManifestFile(Obj->Package, filename + strlen(BaseExportDir) + 1);
+}
+
+
+/*-----------------------------------------------------------------------------
+	Checking for already exported objects
+-----------------------------------------------------------------------------*/
+
+// Names of exported objects, used to give unique names to objects with the same name and class
+static UniqueNameList ExportedNames;
+
+// Returns true when the package has another export with the same name and class. ExportObject()
+// renames such objects depending on the export order, so their file names can't be predicted
+// before loading.
+static bool HasDuplicateExportName(const UnPackage* Package, int ExportIndex)
+{
+	guard(HasDuplicateExportName);
+
+	static const UnPackage* CachedPackage = NULL;
+	static TArray<bool> Duplicates;
+
+	int Count = Package->Summary.ExportCount;
+	if (Package != CachedPackage || Duplicates.Num() != Count)
+	{
+		// find all duplicate names in the package at once
+		int HashSize = 256;
+		while (HashSize < Count * 2) HashSize <<= 1;
+		TArray<int> Hash, HashNext;
+		Hash.AddUninitialized(HashSize);
+		memset(Hash.GetData(), -1, HashSize * sizeof(int));
+		HashNext.AddUninitialized(Count);
+		Duplicates.Empty(Count);
+		Duplicates.AddZeroed(Count);
+		for (int i = 0; i < Count; i++)
+		{
+			const FObjectExport &Exp = Package->GetExport(i);
+			int h = (Exp.ObjectName.NameId * 31 + Exp.ClassIndex) & (HashSize - 1);
+			for (int j = Hash[h]; j >= 0; j = HashNext[j])
+			{
+				const FObjectExport &Exp2 = Package->GetExport(j);
+				if (Exp2.ObjectName == Exp.ObjectName && Exp2.ClassIndex == Exp.ClassIndex)
+					Duplicates[i] = Duplicates[j] = true;
+			}
+			HashNext[i] = Hash[h];
+			Hash[h] = i;
+		}
+		CachedPackage = Package;
+	}
+	return Duplicates[ExportIndex];
+
+	unguard;
+}
+
+bool IsExportFilePresent(UnPackage* Package, int ExportIndex, const char* ObjName)
+{
+	guard(IsExportFilePresent);
+
+	if (!GDontOverwriteFiles) return false;
+
+	const FObjectExport &Exp = Package->GetExport(ExportIndex);
+	const CExporterInfo *Info = FindExporter(Package->GetObjectName(Exp.ClassIndex));
+	if (!Info || !Info->FileNames) return false;
+	const char *Mask = Info->FileNames();
+	if (!Mask) return false;			// exporter can't predict file names now
+
+	char ExportPath[1024];
+	appStrncpyz(ExportPath, GetExportPath(Package, ExportIndex), ARRAY_COUNT(ExportPath));
+
+	if (!ObjName)
+	{
+		// checking before loading: the object will get a unique name when an object with the
+		// same name was already exported, or when the package has objects with the same name
+		const CTypeInfo *Type = FindClassType(Package->GetObjectName(Exp.ClassIndex));
+		char UniqueName[256];
+		appSprintf(ARRAY_ARG(UniqueName), "%s/%s.%s", ExportPath, *Exp.ObjectName, Type->Name + 1);
+		if (ExportedNames.GetCount(UniqueName) || HasDuplicateExportName(Package, ExportIndex))
+			return false;
+		ObjName = Exp.ObjectName;
+	}
+
+	// Mask is a list of files separated with ';', every item could contain alternative
+	// names separated with '|'
+	char Files[64][256];
+	int NumFiles = 0;
+	for (const char *s = Mask; *s; )
+	{
+		bool found = false;
+		while (true)
+		{
+			// get one file name mask
+			const char *e = s;
+			while (*e && *e != '|' && *e != ';') e++;
+			if (!found && e > s)
+			{
+				char FileMask[256], FileName[256];
+				appStrncpyz(FileMask, s, min((int)(e - s) + 1, (int)ARRAY_COUNT(FileMask)));
+				appSprintf(ARRAY_ARG(FileName), FileMask, ObjName);
+				if (appFileExists(va("%s/%s", ExportPath, FileName)))
+				{
+					found = true;
+					if (NumFiles < ARRAY_COUNT(Files))
+						strcpy(Files[NumFiles++], FileName);
+				}
+			}
+			s = e;
+			if (*s != '|') break;
+			s++;
+		}
+		if (!found) return false;		// this file is missing
+		if (*s == ';') s++;
+	}
+
+	// all files are present
+	for (int i = 0; i < NumFiles; i++)
+	{
+		const char *FileName = va("%s/%s", ExportPath, Files[i]);
+		RegisterProducedFile(Package, ExportIndex, FileName);
+		RegisterManifestFile(Package, FileName + strlen(BaseExportDir) + 1);
+	}
+	return true;
+
+	unguardf("%s:%d", Package->Filename, ExportIndex);
+}
+
+
 bool ExportObject(const UObject *Obj)
 {
 	guard(ExportObject);
@@ -129,8 +485,6 @@ bool ExportObject(const UObject *Obj)
 	if (strnicmp(Obj->Name, "Default__", 9) == 0)	// default properties object, nothing to export
 		return true;
 
-	static UniqueNameList ExportedNames;
-
 	// check for duplicate object export
 	if (!RegisterProcessedObject(Obj)) return true;
 
@@ -139,6 +493,15 @@ bool ExportObject(const UObject *Obj)
 		const CExporterInfo &Info = exporters[i];
 		if (Obj->IsA(Info.ClassName))
 		{
+			bool HasExport = (Obj->Package && Obj->PackageIndex >= 0);
+			// check for duplicate content
+			if (HasExport && IsDuplicateExport(Obj->Package, Obj->PackageIndex))
+			{
+				// will be linked or listed in ResetExportedList()
+				appLogObject("export", Obj->GetClassName(), Obj->Package->Name, Obj->Name, 0, 0, "duplicate");
+				return true;
+			}
+
 			char ExportPath[1024];
 			strcpy(ExportPath, GetExportPath(Obj));
 			const char *ClassName  = Obj->GetClassName();
@@ -157,11 +520,23 @@ bool ExportObject(const UObject *Obj)
 				const_cast<UObject*>(Obj)->Name = uniqueName;
 			}
 
-			appPrintf("Exporting %s %s to %s\n", Obj->GetClassName(), Obj->Name, ExportPath);
+			// check for files from previous export
+			if (HasExport && IsExportFilePresent(Obj->Package, Obj->PackageIndex, Obj->Name))
+			{
+				if (OriginalName) const_cast<UObject*>(Obj)->Name = OriginalName;
+				appLogObject("export", ClassName, Obj->Package->Name, Obj->Name, 0, 0, "present");
+				return true;
+			}
+
+			appPrintfVerbose("Exporting %s %s to %s\n", Obj->GetClassName(), Obj->Name, ExportPath);
+			unsigned StartTime = appMilliseconds();
+			int64 StartBytes = FFileWriter::TotalBytesWritten;
 			Info.Func(Obj);
 
 			//?? restore object name
 			if (OriginalName) const_cast<UObject*>(Obj)->Name = OriginalName;
+			appLogObject("export", ClassName, Obj->Package ? Obj->Package->Name : "", Obj->Name,
+				FFileWriter::TotalBytesWritten - StartBytes, appMilliseconds() - StartTime, "ok");
 			return true;
 		}
 	}
@@ -175,8 +550,6 @@ bool ExportObject(const UObject *Obj)
 	Export path functions
 -----------------------------------------------------------------------------*/
 
-static char BaseExportDir[512];
-
 bool GUncook    = false;
 bool GUseGroups = false;
 
@@ -186,7 +559,7 @@ void appSetBaseExportDirectory(const char *Dir)
 }
 
 
-const char* GetExportPath(const UObject *Obj)
+static const char* GetExportPath(const UnPackage *Package, int ExportIndex, const char *ObjName, const char *ClassName)
 {
 	guard(GetExportPath);
 
@@ -196,12 +569,12 @@ const char* GetExportPath(const UObject *Obj)
 		appSetBaseExportDirectory(".");	// to simplify code
 
 #if UNREAL4
-	if (Obj->Package && Obj->Package->Game >= GAME_UE4)
+	if (Package && Package->Game >= GAME_UE4)
 	{
 		// Special path for UE4 games - its packages are usually have 1 asset per file, plus
 		// package names could be duplicated across directory tree, with use of full package
 		// paths to identify packages.
-		const char* PackageName = Obj->Package->Filename;
+		const char* PackageName = Package->Filename;
 		// Package name could be:
 		// a) /(GameName|Engine)/Content/... - when loaded from pak file
 		// b) [[GameName/]Content/]... - when not packaged to pak file
@@ -220,7 +593,7 @@ const char* GetExportPath(const UObject *Obj)
 			}
 		}
 		int len = appSprintf(ARRAY_ARG(buf), "%s/%s", BaseExportDir, PackageName);
-		if (!stricmp(Obj->Name, Obj->Package->Name))
+		if (!stricmp(ObjName, Package->Name))
 		{
 			// Object's name matches with package name, so don't create a directory for it.
 			// Strip package name, leave only path.
@@ -238,9 +611,9 @@ const char* GetExportPath(const UObject *Obj)
 #endif // UNREAL4
 
 	const char *PackageName = "None";
-	if (Obj->Package)
+	if (Package)
 	{
-		PackageName = (GUncook) ? Obj->GetUncookedPackageName() : Obj->Package->Name;
+		PackageName = (GUncook) ? Package->GetUncookedPackageName(ExportIndex) : Package->Name;
 	}
 
 	static char group[512];
@@ -248,14 +621,16 @@ const char* GetExportPath(const UObject *Obj)
 	{
 		// get group name
 		// include cooked package name when not uncooking
-		Obj->GetFullName(ARRAY_ARG(group), false, !GUncook);
+		group[0] = 0;
+		if (Package)
+			Package->GetFullExportName(Package->GetExport(ExportIndex), ARRAY_ARG(group), false, !GUncook);
 		// replace all '.' with '/'
 		for (char *s = group; *s; s++)
 			if (*s == '.') *s = '/';
 	}
 	else
 	{
-		strcpy(group, Obj->GetClassName());
+		strcpy(group, ClassName);
 	}
 
 	appSprintf(ARRAY_ARG(buf), "%s/%s%s%s", BaseExportDir, PackageName,
@@ -266,6 +641,12 @@ const char* GetExportPath(const UObject *Obj)
 }
 
 
+const char* GetExportPath(const UObject *Obj)
+{
+	return GetExportPath(Obj->Package, Obj->PackageIndex, Obj->Name, Obj->GetClassName());
+}
+
+
 const char* GetExportFileName(const UObject *Obj, const char *fmt, va_list args)
 {
 	guard(GetExportFileName);
@@ -319,7 +700,11 @@ FArchive *CreateExportArchive(const UObject *Obj, const char *fmt, ...)
 	if (GDontOverwriteFiles)
 	{
 		// check file presence
-		if (appFileExists(filename)) return NULL;
+		if (appFileExists(filename))
+		{
+			RegisterExportedFile(Obj, filename);
+			return NULL;
+		}
 	}
 
 //	appPrintf("... writting %s'%s' to %s ...\n", Obj->GetClassName(), Obj->Name, filename);
@@ -335,7 +720,94 @@ FArchive *CreateExportArchive(const UObject *Obj, const char *fmt, ...)
 
 	Ar->ArVer = 128;			// less than UE3 version (required at least for VJointPos structure)
 
+	RegisterExportedFile(Obj, filename);
+
 	return Ar;
 
 	unguard;
 }
+
+
+/*-----------------------------------------------------------------------------
+	Processing of skipped duplicates
+-----------------------------------------------------------------------------*/
+
+static void ProcessDuplicateExports()
+{
+	guard(ProcessDuplicateExports);
+
+	FArchive *List = NULL;
+	int numDuplicates = 0, numLinks = 0;
+
+	for (int i = 0; i < ContentEntries.Num(); i++)
+	{
+		const ContentEntry &E = ContentEntries[i];
+		if (E.Original < 0) continue;
+		numDuplicates++;
+
+		const ContentEntry &Orig = ContentEntries[E.Original];
+		bool hasFiles = false;
+		for (int j = 0; j < ProducedFiles.Num(); j++)
+		{
+			const ProducedFile &F = ProducedFiles[j];
+			if (F.Entry != E.Original) continue;
+			hasFiles = true;
+
+			char SrcFile[1024], DstFile[1024];
+			appSprintf(ARRAY_ARG(SrcFile), "%s/%s", Orig.ExportPath, F.Name);
+			appSprintf(ARRAY_ARG(DstFile), "%s/%s", E.ExportPath, F.Name);
+
+			if (GDedupExports == DEDUP_LINK)
+			{
+				if (appFileExists(DstFile))
+				{
+					if (GDontOverwriteFiles) continue;
+					remove(DstFile);
+				}
+				appMakeDirectoryForFile(DstFile);
+				if (appMakeHardLink(SrcFile, DstFile))
+				{
+					numLinks++;
+					continue;
+				}
+			}
+
+			// list file which wasn't linked
+			if (!List)
+			{
+				const char *ListName = va("%s/duplicates.txt", BaseExportDir[0] ? BaseExportDir : ".");
+				appMakeDirectoryForFile(ListName);
+				List = new FFileWriter(ListName, FRO_NoOpenError);
+				if (!List->IsOpen())
+				{
+					appPrintf("Error opening file \"%s\" ...\n", ListName);
+					delete List;
+					List = NULL;
+					break;
+				}
+			}
+			List->Printf("%s -> %s\n", DstFile, SrcFile);
+		}
+
+		if (!hasFiles)
+		{
+			const FObjectExport &Exp = E.Package->GetExport(E.ExportIndex);
+			appPrintf("WARNING: %s from %s was skipped as duplicate, but original object wasn't exported\n",
+				*Exp.ObjectName, E.Package->Filename);
+		}
+	}
+
+	if (List) delete List;
+	if (numDuplicates)
+		appPrintf("Skipped %d duplicate object(s), created %d link(s)\n", numDuplicates, numLinks);
+
+	// cleanup
+	for (int i = 0; i < ContentEntries.Num(); i++)
+		if (ContentEntries[i].ExportPath) appFree(ContentEntries[i].ExportPath);
+	for (int i = 0; i < ProducedFiles.Num(); i++)
+		appFree(ProducedFiles[i].Name);
+	ContentEntries.Empty();
+	ProducedFiles.Empty();
+
+	unguard;
+}
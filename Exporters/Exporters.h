@@ -5,21 +5,60 @@
 // registration
 typedef void (*ExporterFunc_t)(const UObject*);
 
-void RegisterExporter(const char *ClassName, ExporterFunc_t Func);
+// Function which returns names of files created by exporter, used to skip already exported
+// objects before loading them. Files are separated with ';', alternative names of the same
+// file are separated with '|', "%s" is replaced with object name, for example "%s.psk|%s.pskx".
+// Function returns NULL when file names couldn't be predicted with current export options.
+typedef const char* (*ExportFileNamesFunc_t)();
+
+void RegisterExporter(const char *ClassName, ExporterFunc_t Func, ExportFileNamesFunc_t FileNames = NULL);
 
 // wrapper to avoid typecasts to ExporterFunc_t
 // T should be an UObject-derived class
 template<class T>
-FORCEINLINE void RegisterExporter(const char *ClassName, void (*Func)(const T*))
+FORCEINLINE void RegisterExporter(const char *ClassName, void (*Func)(const T*), ExportFileNamesFunc_t FileNames = NULL)
 {
-	RegisterExporter(ClassName, (ExporterFunc_t)Func);
+	RegisterExporter(ClassName, (ExporterFunc_t)Func, FileNames);
 }
 
-// This function will clear list of already exported objects
+// This function will clear list of already exported objects. When duplicate detection
+// is enabled, it will also link or list files for skipped duplicates.
 void ResetExportedList();
 
+class UnPackage;
+
+// Duplicate detection for objects which cooker has copied into many packages (UE3 forced
+// exports). Fingerprints the export by its class, source object path and serialized size,
+// without loading or reading its data. Returns true when the same object was already
+// registered from another package, so this export could be skipped. Always returns false
+// when GDedupExports is DEDUP_NONE.
+bool IsDuplicateExport(UnPackage* Package, int ExportIndex);
+
+// Returns true when GDontOverwriteFiles is set and all files which will be created by the
+// exporter are already present, so the export could be skipped. ObjName is the name used
+// for exported files (ExportObject() renames objects with duplicate names). When ObjName
+// is NULL, the check is done before loading, and it fails for objects which could be
+// renamed.
+bool IsExportFilePresent(UnPackage* Package, int ExportIndex, const char* ObjName = NULL);
+
 bool ExportObject(const UObject *Obj);
 
+// Incremental export manifest, active when GIncrementalExport is set. OptionsSignature
+// identifies export options: packages exported with other options are not up to date.
+struct CGameFileInfo;
+void OpenExportManifest(const char* ExportDir, uint32 OptionsSignature);
+// Returns true when the package wasn't changed since previous export. Should be called
+// before package loading (Package = NULL, uses file size and time) and, when it returns
+// false, after loading (compares package GUID when file time is not available, and
+// registers the package for export).
+bool IsPackageExported(const CGameFileInfo* info, const UnPackage* Package = NULL);
+// Append the package record to the manifest, called when all package objects were exported
+void FinishPackageExport(const UnPackage* Package);
+// Report stale files and compact the manifest
+void CloseExportManifest();
+// Register the file created for the package object, name is relative to the export directory
+void RegisterManifestFile(const UnPackage* Package, const char* RelativeName);
+
 // path
 void appSetBaseExportDirectory(const char *Dir);
 const char* GetExportPath(const UObject *Obj);
@@ -41,6 +80,15 @@ extern bool GUncook;
 extern bool GUseGroups;
 extern bool GDontOverwriteFiles;
 
+enum
+{
+	DEDUP_NONE,				// export every object
+	DEDUP_LIST,				// skip duplicates, list them in "duplicates.txt"
+	DEDUP_LINK,				// skip duplicates, create hard links to files of the first exported copy
+};
+extern int GDedupExports;
+extern bool GIncrementalExport;
+
 // forwards
 class UObject;
 class UVertMesh;
@@ -102,6 +150,16 @@ struct UniqueNameList
 		N->Count = 1;
 		return 1;
 	}
+
+	int GetCount(const char *Name) const
+	{
+		for (int i = 0; i < Items.Num(); i++)
+		{
+			const Item &V = Items[i];
+			if (strcmp(V.Name, Name) == 0) return V.Count;
+		}
+		return 0;
+	}
 };
 
 void WriteTGA(FArchive &Ar, int width, int height, byte *pic);
@@ -124,50 +124,6 @@ void CSkelMeshInstance::ClearSkelAnims()
 }
 
 
-//!! CSkeletalMesh has SortBones() method now!
-/* Iterate bone (sub)tree and do following:
- *	- find all direct childs of bone 'Index', check sort order; bones should be
- *	  sorted in hierarchy order (1st child and its children first, other childs next)
- *	  Example of tree:
- *		Bone1
- *		+- Bone11
- *		|  +- Bone111
- *		+- Bone12
- *		|  +- Bone121
- *		|  +- Bone122
- *		+- Bone13
- *	  Sorted order: Bone1, Bone11, Bone111, Bone12, Bone121, Bone122, Bone13
- *	  Note: it seems, Unreal already have sorted bone list (assumed in other code,
- *	  verified by 'assert(currIndex == Index)')
- *	- compute subtree sizes ('Sizes' array)
- *	- compute bone hierarchy depth ('Depth' array, for debugging only)
- */
-static int CheckBoneTree(const TArray<CSkelMeshBone> &Bones, int Index,
-	int *Sizes, int *Depth, int &numIndices, int maxIndices)
-{
-	assert(numIndices < maxIndices);
-	static int depth = 0;
-	// remember curerent index, increment for recustion
-	int currIndex = numIndices++;
-	// find children of Bone[Index]
-	int treeSize = 0;
-	for (int i = Index + 1; i < Bones.Num(); i++)
-		if (Bones[i].ParentIndex == Index)
-		{
-			// recurse
-			depth++;
-			treeSize += CheckBoneTree(Bones, i, Sizes, Depth, numIndices, maxIndices);
-			depth--;
-		}
-	// store gathered information
-//	assert(currIndex == Index);		//??
-	if (currIndex != Index) appNotify("Strange skeleton, check childs of bone %d (%s)", currIndex, *Bones[currIndex].Name);
-	Sizes[currIndex] = treeSize;
-	Depth[currIndex] = depth;
-	return treeSize + 1;
-}
-
-
 void CSkelMeshInstance::SetMesh(CSkeletalMesh *Mesh)
 {
 	guard(CSkelMeshInstance::SetMesh);
@@ -263,19 +219,10 @@ if (i == 32 || i == 34)
 		data->Scale = 1.0f;			// default bone scale
 	}
 
-	// check bones tree
-	if (NumBones)
-	{
-		//!! should be done in CSkeletalMesh
-		guard(VerifySkeleton);
-		int treeSizes[MAX_MESHBONES], depth[MAX_MESHBONES];
-		int numIndices = 0;
-		CheckBoneTree(Mesh->RefSkeleton, 0, treeSizes, depth, numIndices, MAX_MESHBONES);
-		assert(numIndices == NumBones);
-		for (i = 0; i < numIndices; i++)
-			BoneData[i].SubtreeSize = treeSizes[i];	// remember subtree size
-		unguard;
-	}
+	// remember subtree sizes, computed by CSkeletalMesh::SortBones()
+	assert(Mesh->Hierarchy.Bones.Num() == NumBones);
+	for (i = 0; i < NumBones; i++)
+		BoneData[i].SubtreeSize = Mesh->Hierarchy.Bones[i].SubtreeSize;
 
 	PlayAnim(NULL);
 
@@ -315,35 +262,35 @@ void CSkelMeshInstance::SetAnim(const CAnimSet *Anim)
 
 void CSkelMeshInstance::DumpBones()
 {
-	int treeSizes[MAX_MESHBONES], depth[MAX_MESHBONES];
-	int numIndices = 0;
-	CheckBoneTree(pMesh->RefSkeleton, 0, treeSizes, depth, numIndices, MAX_MESHBONES);
+	const TArray<CSkelMeshBoneInfo> &Info = pMesh->Hierarchy.Bones;
+	int numIndices = Info.Num();
 	//?? dump tree; separate function (requires depth information)
 	for (int i = 0; i < numIndices; i++)
 	{
 		const CSkelMeshBone &B = pMesh->RefSkeleton[i];
 		int parent = B.ParentIndex;
-		appPrintf("bone#%3d (parent %3d); tree size: %3d   ", i, parent, treeSizes[i]);
+		int depth = Info[i].Depth;
+		appPrintf("bone#%3d (parent %3d); tree size: %3d   ", i, parent, Info[i].SubtreeSize);
 #if 1
-		for (int j = 0; j < depth[i]; j++)
+		for (int j = 0; j < depth; j++)
 		{
 			// graph-like picture
 			bool found = false;
 			for (int n = i+1; n < numIndices; n++)
 			{
-				if (depth[n] >  j+1) continue;
-				if (depth[n] == j+1) found = true;
+				if (Info[n].Depth >  j+1) continue;
+				if (Info[n].Depth == j+1) found = true;
 				break;
 			}
 		#if _WIN32
 			// pseudographics
-			if (j == depth[i]-1)
+			if (j == depth-1)
 				appPrintf(found ? "\xC3\xC4\xC4" : "\xC0\xC4\xC4");	// [+--] : [\--]
 			else
                 appPrintf(found ? "\xB3  " : "   ");				// [|  ] : [   ]
 		#else
 			// ASCII
-			if (j == depth[i]-1)
+			if (j == depth-1)
 				appPrintf(found ? "+--" : "\\--");
 			else
 				appPrintf(found ? "|  " : "   ");
@@ -363,10 +310,7 @@ void CSkelMeshInstance::DumpBones()
 
 int CSkelMeshInstance::FindBone(const char *BoneName) const
 {
-	for (int i = 0; i < pMesh->RefSkeleton.Num(); i++)
-		if (!strcmp(pMesh->RefSkeleton[i].Name, BoneName))
-			return i;
-	return INDEX_NONE;
+	return pMesh->FindBone(BoneName);
 }
 
 
@@ -410,7 +354,7 @@ CVec3 CSkelMeshInstance::GetMeshOrigin() const
 -----------------------------------------------------------------------------*/
 
 #if SHOW_BONE_UPDATES
-static int BoneUpdateCounts[MAX_MESHBONES];
+static TArray<int> BoneUpdateCounts;
 #endif
 
 void CSkelMeshInstance::UpdateSkeleton()
@@ -422,7 +366,8 @@ void CSkelMeshInstance::UpdateSkeleton()
 	int Stage;
 	CAnimChan *Chn;
 #if SHOW_BONE_UPDATES
-	memset(BoneUpdateCounts, 0, sizeof(BoneUpdateCounts));
+	BoneUpdateCounts.Empty(pMesh->RefSkeleton.Num());
+	BoneUpdateCounts.AddZeroed(pMesh->RefSkeleton.Num());
 #endif
 	for (Stage = 0, Chn = Channels; Stage <= MaxAnimChannel; Stage++, Chn++)
 	{
@@ -1377,7 +1322,8 @@ void CSkelMeshInstance::BuildInfColors()
 
 	// get colors for bones
 	int NumBones = pMesh->RefSkeleton.Num();
-	CVec3 BoneColors[MAX_MESHBONES];
+	TArray<CVec3> BoneColors;
+	BoneColors.AddZeroed(NumBones);
 	for (i = 0; i < NumBones; i++)
 		GetBoneInfColor(i, BoneColors[i].v);
 
@@ -170,6 +170,10 @@ void CVertMeshInstance::Draw(unsigned flags)
 	Scale1.Scale(backLerp);
 	Scale2.Scale(frac);
 
+	// get normals, they could be computed on demand
+	const FMeshNorm *Normals1 = pMesh->GetFrameNormals(FrameNum1);
+	const FMeshNorm *Normals2 = pMesh->GetFrameNormals(FrameNum2);
+
 	// compute deformed mesh
 	const FMeshWedge *W = &pMesh->Wedges[0];
 	CVec3 *pVec    = Verts;
@@ -186,7 +190,7 @@ void CVertMeshInstance::Draw(unsigned flags)
 		tmp[2] = V.Z * pMesh->MeshScale.Z;
 		BaseTransform.TransformPoint(tmp, *pVec);
 		// normal
-		const FMeshNorm &N = pMesh->Normals[base1 + W->iVertex];
+		const FMeshNorm &N = Normals1[W->iVertex];
 		tmp[0] = (N.X - 512.0f) / 512;
 		tmp[1] = (N.Y - 512.0f) / 512;
 		tmp[2] = (N.Z - 512.0f) / 512;
@@ -200,8 +204,8 @@ void CVertMeshInstance::Draw(unsigned flags)
 		tmp[2] = V1.Z * Scale1[2] + V2.Z * Scale2[2];
 		BaseTransform.TransformPoint(tmp, *pVec);
 		// normal
-		const FMeshNorm &N1 = pMesh->Normals[base1 + W->iVertex];
-		const FMeshNorm &N2 = pMesh->Normals[base2 + W->iVertex];
+		const FMeshNorm &N1 = Normals1[W->iVertex];
+		const FMeshNorm &N2 = Normals2[W->iVertex];
 		tmp[0] = (N1.X * backLerp + N2.X * frac - 512.0f) / 512;
 		tmp[1] = (N1.Y * backLerp + N2.Y * frac - 512.0f) / 512;
 		tmp[2] = (N1.Z * backLerp + N2.Z * frac - 512.0f) / 512;
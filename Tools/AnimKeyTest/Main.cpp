@@ -0,0 +1,245 @@
+#include "Core.h"
+#include "UnCore.h"
+#include "UnObject.h"
+#include "UnMesh3.h"
+#include "UnMeshTypes.h"
+
+// Test for batch animation key decoders (Unreal/UnAnimKeys.cpp). Keys are decoded from random data
+// with the batch decoders and with the generic FArchive-based per-key code, results should be
+// bit-identical for all key formats and component masks.
+
+#define NUM_ITERATIONS		2000
+#define BUFFER_SIZE			65536
+
+static void FillRandomData(TArray<uint8> &Buf)
+{
+	int i;
+	for (i = 0; i < Buf.Num(); i++)
+		Buf[i] = rand();
+	// put some valid floats in [-1..1] range into data, so Float96NoW formats will have non-zero W
+	for (i = 0; i < Buf.Num() / 4; i += 3)
+	{
+		float f = (rand() % 2000 - 1000) / 1000.0f;
+		memcpy(&Buf[i * 4], &f, sizeof(float));
+	}
+}
+
+// Reference decoders, the same code as UAnimSequence::DecodeUE3Anims() uses
+
+static FVector DecodeTranslation(FArchive &Ar, AnimationCompressionFormat Format, bool PerTrack, int Mask,
+	const FVector &Mins, const FVector &Ranges)
+{
+	FVector v;
+	v.Set(0, 0, 0);
+	switch (Format)
+	{
+	case ACF_None:
+		Ar << v;
+		break;
+	case ACF_Float96NoW:
+		if (PerTrack && Mask)
+		{
+			if (Mask & 1) Ar << v.X;
+			if (Mask & 2) Ar << v.Y;
+			if (Mask & 4) Ar << v.Z;
+		}
+		else
+		{
+			Ar << v;
+		}
+		break;
+	case ACF_IntervalFixed32NoW:
+		{
+			FVectorIntervalFixed32 v2;
+			Ar << v2;
+			v = v2.ToVector(Mins, Ranges);
+		}
+		break;
+	case ACF_Fixed48NoW:
+		if (PerTrack)
+		{
+			uint16 c;
+			if (Mask & 1) { Ar << c; v.X = DecodeFixed48_PerTrackComponent<7>(c); }
+			if (Mask & 2) { Ar << c; v.Y = DecodeFixed48_PerTrackComponent<7>(c); }
+			if (Mask & 4) { Ar << c; v.Z = DecodeFixed48_PerTrackComponent<7>(c); }
+		}
+		else
+		{
+			FVectorFixed48 v2;
+			Ar << v2;
+			v = v2;
+		}
+		break;
+	case ACF_Identity:
+		break;
+	default:
+		appError("Unexpected translation format %d", Format);
+	}
+	return v;
+}
+
+template<class T>
+static FQuat ReadQuat(FArchive &Ar)
+{
+	T q;
+	Ar << q;
+	return q;
+}
+
+static FQuat DecodeRotation(FArchive &Ar, AnimationCompressionFormat Format, bool PerTrack, int Mask,
+	const FVector &Mins, const FVector &Ranges)
+{
+	FQuat q;
+	switch (Format)
+	{
+	case ACF_None:
+		Ar << q;
+		break;
+	case ACF_Float96NoW:
+		q = ReadQuat<FQuatFloat96NoW>(Ar);
+		break;
+	case ACF_Fixed48NoW:
+		if (PerTrack)
+		{
+			FQuatFixed48NoW q2;
+			q2.X = q2.Y = q2.Z = 32767;
+			if (Mask & 1) Ar << q2.X;
+			if (Mask & 2) Ar << q2.Y;
+			if (Mask & 4) Ar << q2.Z;
+			q = q2;
+		}
+		else
+		{
+			q = ReadQuat<FQuatFixed48NoW>(Ar);
+		}
+		break;
+	case ACF_Fixed32NoW:
+		q = ReadQuat<FQuatFixed32NoW>(Ar);
+		break;
+	case ACF_IntervalFixed32NoW:
+		{
+			FQuatIntervalFixed32NoW q2;
+			Ar << q2;
+			q = q2.ToQuat(Mins, Ranges);
+		}
+		break;
+	case ACF_Float32NoW:
+		q = ReadQuat<FQuatFloat32NoW>(Ar);
+		break;
+	case ACF_Identity:
+		q.Set(0, 0, 0, 1);
+		break;
+	default:
+		appError("Unexpected rotation format %d", Format);
+	}
+	return q;
+}
+
+// Check one track: Mode 0 = translation, 1 = rotation, 2 and 3 - the same for per-track compression
+static bool TestTrack(const TArray<uint8> &Buf, int Mode, AnimationCompressionFormat Format, int Mask, int Start, int NumKeys,
+	const FVector &Mins, const FVector &Ranges)
+{
+	bool PerTrack = (Mode >= 2);
+	int RefMask = Mask & 7;					// decoders use only 3 lower bits of ComponentMask
+	FMemReader Ar(Buf.GetData(), Buf.Num());
+	FMemReader RefAr(Buf.GetData(), Buf.Num());
+	Ar.Seek(Start);
+	RefAr.Seek(Start);
+
+	bool Same;
+	if (!(Mode & 1))
+	{
+		TArray<FVector> Keys;
+		bool Supported = PerTrack
+			? DecodePerTrackTranslationKeys(Ar, Buf.GetData(), Format, Mask, NumKeys, Mins, Ranges, Keys)
+			: DecodeTranslationKeys(Ar, Buf.GetData(), Format, NumKeys, Mins, Ranges, Keys);
+		if (!Supported) return true;
+		TArray<FVector> RefKeys;
+		for (int i = 0; i < NumKeys; i++)
+			RefKeys.Add(DecodeTranslation(RefAr, Format, PerTrack, RefMask, Mins, Ranges));
+		Same = Keys.Num() == NumKeys && memcmp(Keys.GetData(), RefKeys.GetData(), NumKeys * sizeof(FVector)) == 0;
+	}
+	else
+	{
+		TArray<FQuat> Keys;
+		bool Supported = PerTrack
+			? DecodePerTrackRotationKeys(Ar, Buf.GetData(), Format, Mask, NumKeys, Mins, Ranges, Keys)
+			: DecodeRotationKeys(Ar, Buf.GetData(), Format, NumKeys, Mins, Ranges, Keys);
+		if (!Supported) return true;
+		TArray<FQuat> RefKeys;
+		for (int i = 0; i < NumKeys; i++)
+			RefKeys.Add(DecodeRotation(RefAr, Format, PerTrack, RefMask, Mins, Ranges));
+		Same = Keys.Num() == NumKeys && memcmp(Keys.GetData(), RefKeys.GetData(), NumKeys * sizeof(FQuat)) == 0;
+	}
+	if (Same && Ar.Tell() == RefAr.Tell()) return true;
+
+	appPrintf("ERROR: %s%s format %d mask %d keys %d: %s\n", PerTrack ? "per-track " : "", (Mode & 1) ? "rotation" : "translation",
+		Format, Mask, NumKeys, Same ? "wrong archive position" : "different keys");
+	return false;
+}
+
+
+static int RunTests()
+{
+	guard(RunTests);
+
+	srand(1);
+	TArray<uint8> Buf;
+	Buf.AddZeroed(BUFFER_SIZE);
+
+	FVector Mins, Ranges;
+	Mins.Set(0.1f, -0.2f, 0.3f);
+	Ranges.Set(0.5f, 0.25f, 1.5f);
+
+	int NumTracks = 0, NumErrors = 0;
+	for (int Iter = 0; Iter < NUM_ITERATIONS; Iter++)
+	{
+		FillRandomData(Buf);
+		int NumKeys = rand() % 300;
+		int Start = rand() % 64;				// unaligned data
+		AnimationCompressionFormat Format = (AnimationCompressionFormat)(rand() % (ACF_Identity + 1));
+		int Mask = rand() % 16;
+		for (int Mode = 0; Mode < 4; Mode++)
+		{
+			NumTracks++;
+			if (!TestTrack(Buf, Mode, Format, Mask, Start, NumKeys, Mins, Ranges))
+				NumErrors++;
+		}
+	}
+
+	// byte-swapped data should be rejected
+	FMemReader SwapAr(Buf.GetData(), Buf.Num());
+	SwapAr.ReverseBytes = true;
+	TArray<FVector> Keys;
+	if (DecodeTranslationKeys(SwapAr, Buf.GetData(), ACF_Fixed48NoW, 1, Mins, Ranges, Keys) || SwapAr.Tell() != 0)
+	{
+		appPrintf("ERROR: byte-swapped data was not rejected\n");
+		NumErrors++;
+	}
+
+	appPrintf("Tested %d tracks, %d errors\n", NumTracks, NumErrors);
+	return NumErrors ? 1 : 0;
+
+	unguard;
+}
+
+
+int main(int argc, char **argv)
+{
+	// Note: this function shouldn't have objects with destructors because of TRY
+#if DO_GUARD
+	TRY {
+#endif
+
+	return RunTests();
+
+#if DO_GUARD
+	} CATCH {
+		if (GErrorHistory[0])
+			appPrintf("ERROR: %s\n", GErrorHistory);
+		else
+			appPrintf("Unknown error\n");
+		exit(1);
+	}
+#endif
+}
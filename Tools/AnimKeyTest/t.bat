@@ -0,0 +1,6 @@
+@echo off
+
+rm animkeytest.exe
+bash build.sh
+
+animkeytest.exe
@@ -2,22 +2,310 @@
 #include "UnrealClasses.h"
 #include "UnPackage.h"
 #include "GameDatabase.h"
+#include "Parallel.h"
+
+#include <sys/stat.h>				// for stat()
 
 #define DEF_UNP_DIR		"unpacked"
 #define HOMEPAGE		"http://www.gildor.org/"
 
 
-static void CopyStream(FArchive *Src, FILE *Dst, int Count)
+/*-----------------------------------------------------------------------------
+	Package decompression
+-----------------------------------------------------------------------------*/
+
+// Read raw data from the beginning of package file
+static void ReadRawHeader(const UnPackage *Package, byte *Buffer, int Size)
+{
+	guard(ReadRawHeader);
+
+	const CGameFileInfo *info = appFindGameFile(Package->Filename);
+	FArchive *Ar = info ? appCreateFileReader(info) : new FFileReader(Package->Filename);
+	Ar->Serialize(Buffer, Size);
+	delete Ar;
+
+	unguard;
+}
+
+struct CUnpackJob
+{
+	UnPackage	*Package;
+	char		OutFile[MAX_PACKAGE_PATH + 256];
+	bool		Failed;
+	// Buffers allocated by UnpackPackage(). They are owned by the job, so they are released
+	// with FreeUnpackBuffers() even when UnpackPackage() fails.
+	byte		*Data;
+	byte		*Header;
+};
+
+static void FreeUnpackBuffers(CUnpackJob &Job)
+{
+	if (Job.Data) appFree(Job.Data);
+	delete[] Job.Header;
+	Job.Data   = NULL;
+	Job.Header = NULL;
+}
+
+// Decompress the package and save it to OutFile. The whole file is decompressed into memory
+// (compressed blocks are processed in parallel), then written with a single call.
+static void UnpackPackage(CUnpackJob &Job)
 {
-	byte buffer[16384];
+	UnPackage *Package = Job.Package;
+	const char *OutFile = Job.OutFile;
+
+	guard(UnpackPackage);
+
+	const FPackageFileSummary &Summary = Package->Summary;
+	int uncompressedSize = Package->GetFileSize();
+	if (uncompressedSize == 0) appError("GetFileSize for %s returned 0", Package->Filename);
+	appPrintf("%s: uncompressed size %d\n", Package->Filename, uncompressedSize);
 
-	while (Count > 0)
+	byte *Data = Job.Data = (byte*)appMalloc(uncompressedSize);
+	Package->ReadUncompressedFile(Data, uncompressedSize);
+
+	/*!! Notes:
+	 *	- GOW1 (XBox360 core.u) is not decompressed
+	 *	- Bioshock core.u is not decompressed (because it has non-full compression, but
+	 *	  CompressionFlags are 0) -- should place compressed chunks to Package.Summary
+	 */
+	if (Summary.CompressionFlags)
 	{
-		int Size = min(Count, sizeof(buffer));
-		Src->Serialize(buffer, Size);
-		if (fwrite(buffer, Size, 1, Dst) != 1) appError("Write failed");
-		Count -= Size;
+		// compressed package, but header is not compressed
+
+		// read header (raw)
+		int compressedStart   = Summary.CompressedChunks[0].CompressedOffset;
+		int uncompressedStart = Summary.CompressedChunks[0].UncompressedOffset;
+		byte *buffer = Job.Header = new byte[compressedStart];
+		ReadRawHeader(Package, buffer, compressedStart);
+		FMemReader mem(buffer, compressedStart);
+		mem.SetupFrom(*Package);
+
+		int pos;
+		bool found;
+
+		// find package flags
+		found = false;
+		const FString &Group = Summary.PackageGroup;
+		int DataArrayLen = Group.GetDataArray().Num();
+		for (pos = 8; pos < 48; pos++)
+		{
+			mem.Seek(pos);
+			int tmp;
+			mem << tmp;
+			if (tmp != DataArrayLen && tmp != -DataArrayLen) continue;	// ANSI or Unicode string (MassEffect3 has unicode here)
+			mem.Seek(pos);
+			FString tmp2;
+			mem << tmp2;
+			if (strcmp(*tmp2, *Group) != 0) continue;
+			int flagsPos = mem.Tell();
+			mem << tmp;
+			if (tmp != Summary.PackageFlags) continue;
+			int *p = (int*)(buffer + flagsPos);
+			*p &= (!Package->ReverseBytes) ? ~0x2000000 : ~0x2;	// remove PKG_StoreCompressed flag (2 variants for different byte order)
+			found = true;
+			break;
+		}
+		if (!found) appError("Unable to find package flags");
+
+		// find compression info in a header
+		for (pos = 32; pos < compressedStart - Summary.CompressedChunks.Num() * 16; pos++)
+		{
+			mem.Seek(pos);
+			int tmpCompressionFlags, tmpNumChunks;
+			mem << tmpCompressionFlags << tmpNumChunks;
+			if (tmpCompressionFlags != Summary.CompressionFlags || tmpNumChunks != Summary.CompressedChunks.Num())
+				continue;
+			// validate table
+			bool valid = true;
+			for (int i = 0; i < Summary.CompressedChunks.Num(); i++)
+			{
+				FCompressedChunk RC;
+				const FCompressedChunk &C = Summary.CompressedChunks[i];
+				mem << RC;
+				if (C.UncompressedOffset != RC.UncompressedOffset ||
+					C.UncompressedSize   != RC.UncompressedSize   ||
+					C.CompressedOffset   != RC.CompressedOffset   ||
+					C.CompressedSize     != RC.CompressedSize)
+				{
+					valid = false;
+					break;
+				}
+			}
+			if (!valid) continue;
+			found = true;
+			break;
+		}
+		if (!found) appError("Unable to find compression table");
+//		printf("TABLE at %X\n", pos);
+
+		// remove compression table
+		int* p = (int*)(buffer + pos);
+		p[0] = p[1] = 0;
+		int cut = Summary.CompressedChunks.Num() * 16;
+#if BULLETSTORM
+		if (Package->Game == GAME_Bulletstorm)
+			cut = Summary.CompressedChunks.Num() * 20;
+#endif
+#if MKVSDC
+		if (Package->Game == GAME_MK && Package->ArVer >= 677) // MK X
+			cut = Summary.CompressedChunks.Num() * 24;
+#endif
+		int dstPos = pos + 8;	// skip CompressionFlags and CompressedChunks.Num
+		int srcPos = pos + 8 + cut;	// skip CompressedChunks
+		memcpy(buffer + dstPos, buffer + srcPos, compressedStart - srcPos);
+
+		if (compressedStart - cut != uncompressedStart)
+			appPrintf("WARNING: wrong size of %s: differs in %d bytes\n", Package->Filename, compressedStart - cut - uncompressedStart);
+
+		// replace the header
+		memcpy(Data, buffer, uncompressedStart);
+	}
+
+	// write the file
+	FILE *out = fopen(OutFile, "wb");
+	if (!out) appError("Unable to create file %s", OutFile);
+	int written = fwrite(Data, uncompressedSize, 1, out);
+	fclose(out);
+	if (written != 1) appError("Write failed");
+	FreeUnpackBuffers(Job);
+
+	unguardf("%s", Package->Filename);
+}
+
+/*-----------------------------------------------------------------------------
+	Directory mode: decompress all packages matching a wildcard
+-----------------------------------------------------------------------------*/
+
+// Number of packages opened at once for each worker thread
+#define PACKAGES_PER_THREAD		4
+
+static void UnpackWorker(int Index, void *Param)
+{
+	CUnpackJob &Job = (*(TArray<CUnpackJob>*)Param)[Index];
+	// Note: this function shouldn't have objects with destructors because of TRY
+	TRY
+	{
+		UnpackPackage(Job);
 	}
+	CATCH_CRASH
+	{
+#if DO_GUARD
+		appPrintf("ERROR: %s", GErrorHistory);
+		GErrorHistory[0] = 0;
+#endif
+		Job.Failed = true;
+	}
+	// release buffers left by a failed UnpackPackage()
+	FreeUnpackBuffers(Job);
+}
+
+static UnPackage* TryLoadPackage(const char *Name)
+{
+	UnPackage *Package = NULL;
+	// Note: this function shouldn't have objects with destructors because of TRY
+	TRY
+	{
+		Package = UnPackage::LoadPackage(Name);
+		if (Package) Package->Open();
+	}
+	CATCH_CRASH
+	{
+#if DO_GUARD
+		appPrintf("ERROR: %s", GErrorHistory);
+		GErrorHistory[0] = 0;
+#endif
+		Package = NULL;
+	}
+	return Package;
+}
+
+// Returns true when OutFile was produced from the package before: it has the same size and
+// is not older than the package
+static bool IsUnpackedFileValid(const char *OutFile, const CGameFileInfo *info, int Size)
+{
+	struct stat OutStat;
+	if (stat(OutFile, &OutStat) != 0 || OutStat.st_size != Size)
+		return false;
+	if (info->FileSystem)
+		return true;				// file in a virtual file system, no timestamp available
+	char SrcFile[MAX_PACKAGE_PATH * 2];
+	appSprintf(ARRAY_ARG(SrcFile), "%s/%s", appGetRootDirectory(), info->RelativeName);
+	struct stat SrcStat;
+	return stat(SrcFile, &SrcStat) == 0 && OutStat.st_mtime >= SrcStat.st_mtime;
+}
+
+// Decompress packages in parallel. Packages are opened by the main thread in batches, then
+// each batch is decompressed and saved by worker threads. Packages which are not compressed
+// are skipped, because the result would be the same file.
+static int UnpackPackages(const char *Mask, const char *BaseDir)
+{
+	guard(UnpackPackages);
+
+	TArray<const CGameFileInfo*> Files;
+	appFindGameFiles(Mask, Files);
+	if (!Files.Num())
+	{
+		appPrintf("ERROR: no packages found for %s\n", Mask);
+		return 1;
+	}
+
+	int NumUnpacked = 0, NumNotCompressed = 0, NumUpToDate = 0, NumFailed = 0;
+	int BatchSize = appGetNumThreads() * PACKAGES_PER_THREAD;
+	TArray<CUnpackJob> Jobs;
+	for (int First = 0; First < Files.Num(); First += BatchSize)
+	{
+		// open packages
+		Jobs.Empty(BatchSize);
+		for (int i = First; i < min(First + BatchSize, Files.Num()); i++)
+		{
+			const CGameFileInfo *info = Files[i];
+			UnPackage *Package = TryLoadPackage(info->RelativeName);
+			if (!Package)
+			{
+				NumFailed++;
+				continue;
+			}
+			if (!Package->IsCompressed())
+			{
+				Package->CloseReader();
+				NumNotCompressed++;
+				continue;
+			}
+			char OutFile[ARRAY_COUNT(Jobs[0].OutFile)];
+			appSprintf(ARRAY_ARG(OutFile), "%s/%s", BaseDir, info->RelativeName);
+			if (IsUnpackedFileValid(OutFile, info, Package->GetFileSize()))
+			{
+				Package->CloseReader();
+				NumUpToDate++;
+				continue;
+			}
+			// directories are created here, appMakeDirectory() is not thread-safe
+			appMakeDirectoryForFile(OutFile);
+			CUnpackJob *Job = new (Jobs) CUnpackJob;
+			Job->Package = Package;
+			Job->Failed  = false;
+			Job->Data    = NULL;
+			Job->Header  = NULL;
+			strcpy(Job->OutFile, OutFile);
+		}
+		// decompress them
+		appParallelFor(Jobs.Num(), UnpackWorker, &Jobs);
+		for (int i = 0; i < Jobs.Num(); i++)
+		{
+			const CUnpackJob &Job = Jobs[i];
+			if (Job.Failed) NumFailed++; else NumUnpacked++;
+			Job.Package->CloseReader();
+		}
+	}
+
+	appPrintf("Decompressed %d package(s)", NumUnpacked);
+	if (NumNotCompressed) appPrintf(", %d not compressed", NumNotCompressed);
+	if (NumUpToDate)      appPrintf(", %d up to date", NumUpToDate);
+	if (NumFailed)        appPrintf(", %d failed", NumFailed);
+	appPrintf("\n");
+	return NumFailed ? 1 : 0;
+
+	unguard;
 }
 
 
@@ -39,6 +327,11 @@ int main(int argc, char **argv)
 	help:
 		printf(	"Unreal Engine package decompressor\n"
 				"Usage: decompress [options] <package filename>\n"
+				"       decompress [options] <wildcard>\n"
+				"\n"
+				"When wildcard is used (for example, \"*.xxx\" or \"CookedPC/*\"), all matching\n"
+				"packages are decompressed in parallel, keeping their paths. Packages which are\n"
+				"not compressed or were already decompressed are skipped.\n"
 				"\n"
 				"Options:\n"
 				"    -path=PATH      path to game installation directory; if not specified,\n"
@@ -46,6 +339,7 @@ int main(int argc, char **argv)
 				"    -game=tag       override game autodetection (see -taglist for variants)\n"
 				"    -out=PATH       extract everything into PATH, default is \"" DEF_UNP_DIR "\"\n"
 				"    -lzo|lzx|zlib   force compression method for fully-compressed packages\n"
+				"    -threads=N      limit number of worker threads, 1 disables threading\n"
 				"    -log=file       write log to the specified file\n"
 				"    -taglist        list of tags to override game autodetection\n"
 				"    -help           display this help page\n"
@@ -63,6 +357,7 @@ int main(int argc, char **argv)
 	strcpy(BaseDir, DEF_UNP_DIR);
 
 	const char *argPkgName = NULL;
+	bool hasRootDir = false;
 
 	int arg;
 	for (arg = 1; arg < argc; arg++)
@@ -88,6 +383,7 @@ int main(int argc, char **argv)
 		else if (!strnicmp(opt, "path=", 5))
 		{
 			appSetRootDirectory(opt+5);
+			hasRootDir = true;
 		}
 		else if (!strnicmp(opt, "out=", 4))
 		{
@@ -103,6 +399,16 @@ int main(int argc, char **argv)
 			}
 			GForceGame = tag;
 		}
+		else if (!strnicmp(opt, "threads=", 8))
+		{
+			int num = atoi(opt+8);
+			if (num < 1)
+			{
+				appPrintf("ERROR: number of threads is not valid: %s\n", opt+8);
+				exit(0);
+			}
+			GNumThreads = num;
+		}
 		else if (!stricmp(opt, "lzo"))
 			GForceCompMethod = COMPRESS_LZO;
 		else if (!stricmp(opt, "zlib"))
@@ -128,13 +434,21 @@ int main(int argc, char **argv)
 	}
 	if (!argPkgName) goto help;
 
+	if (appContainsWildcard(argPkgName))
+	{
+		// directory mode
+		if (!hasRootDir)
+			appSetRootDirectory(".");
+		return UnpackPackages(argPkgName, BaseDir);
+	}
+
 	// setup NotifyInfo to describe package only
 	appSetNotifyHeader(argPkgName);
 	// load a package
 	UnPackage *Package = UnPackage::LoadPackage(argPkgName);
 	if (!Package)
 	{
-		printf("ERROR: Unable to find/load package %s\n", argPkgName);
+		appPrintf("ERROR: Unable to find/load package %s\n", argPkgName);
 		exit(1);
 	}
 	// prepare package for reading
@@ -148,135 +462,15 @@ int main(int argc, char **argv)
 	if (s) s++; else s = argPkgName;
 	appStrncpyz(PkgName, s, ARRAY_COUNT(PkgName));
 
-	char OutFile[256];
-	appSprintf(ARRAY_ARG(OutFile), "%s/%s", BaseDir, PkgName);
-	appMakeDirectoryForFile(OutFile);
-
-	const FPackageFileSummary &Summary = Package->Summary;
-	int uncompressedSize = Package->GetFileSize();
-	if (uncompressedSize == 0) appError("GetFileSize for %s returned 0", argPkgName);
-	printf("%s: uncompressed size %d\n", argPkgName, uncompressedSize);
-
-	FILE *out = fopen(OutFile, "wb");
-
-	/*!! Notes:
-	 *	- GOW1 (XBox360 core.u) is not decompressed
-	 *	- Bioshock core.u is not decompressed (because it has non-full compression, but
-	 *	  CompressionFlags are 0) -- should place compressed chunks to Package.Summary
-	 */
-	if (Summary.CompressionFlags)
-	{
-		// compressed package, but header is not compressed
-
-		// read header (raw)
-		int compressedStart   = Summary.CompressedChunks[0].CompressedOffset;
-		int uncompressedStart = Summary.CompressedChunks[0].UncompressedOffset;
-		FILE *h = fopen(Package->Filename, "rb");
-		byte *buffer = new byte[compressedStart];
-		fread(buffer, compressedStart, 1, h);
-		fclose(h);
-
-		FMemReader mem(buffer, compressedStart);
-		mem.SetupFrom(*Package);
-
-		int pos;
-		bool found;
-
-		// find package flags
-		found = false;
-		const FString &Group = Summary.PackageGroup;
-		int DataArrayLen = Group.GetDataArray().Num();
-		for (pos = 8; pos < 48; pos++)
-		{
-			mem.Seek(pos);
-			int tmp;
-			mem << tmp;
-			if (tmp != DataArrayLen && tmp != -DataArrayLen) continue;	// ANSI or Unicode string (MassEffect3 has unicode here)
-			mem.Seek(pos);
-			FString tmp2;
-			mem << tmp2;
-			if (strcmp(*tmp2, *Group) != 0) continue;
-			int flagsPos = mem.Tell();
-			mem << tmp;
-			if (tmp != Summary.PackageFlags) continue;
-			int *p = (int*)(buffer + flagsPos);
-			*p &= (!Package->ReverseBytes) ? ~0x2000000 : ~0x2;	// remove PKG_StoreCompressed flag (2 variants for different byte order)
-			found = true;
-			break;
-		}
-		if (!found) appError("Unable to find package flags");
-
-		// find compression info in a header
-		for (pos = 32; pos < compressedStart - Summary.CompressedChunks.Num() * 16; pos++)
-		{
-			mem.Seek(pos);
-			int tmpCompressionFlags, tmpNumChunks;
-			mem << tmpCompressionFlags << tmpNumChunks;
-			if (tmpCompressionFlags != Summary.CompressionFlags || tmpNumChunks != Summary.CompressedChunks.Num())
-				continue;
-			// validate table
-			bool valid = true;
-			for (int i = 0; i < Summary.CompressedChunks.Num(); i++)
-			{
-				FCompressedChunk RC;
-				const FCompressedChunk &C = Summary.CompressedChunks[i];
-				mem << RC;
-				if (C.UncompressedOffset != RC.UncompressedOffset ||
-					C.UncompressedSize   != RC.UncompressedSize   ||
-					C.CompressedOffset   != RC.CompressedOffset   ||
-					C.CompressedSize     != RC.CompressedSize)
-				{
-					valid = false;
-					break;
-				}
-			}
-			if (!valid) continue;
-			found = true;
-			break;
-		}
-		if (!found) appError("Unable to find compression table");
-//		printf("TABLE at %X\n", pos);
-
-		// remove compression table
-		int* p = (int*)(buffer + pos);
-		p[0] = p[1] = 0;
-		int cut = Summary.CompressedChunks.Num() * 16;
-#if BULLETSTORM
-		if (Package->Game == GAME_Bulletstorm)
-			cut = Summary.CompressedChunks.Num() * 20;
-#endif
-#if MKVSDC
-		if (Package->Game == GAME_MK && Package->ArVer >= 677) // MK X
-			cut = Summary.CompressedChunks.Num() * 24;
-#endif
-		int dstPos = pos + 8;	// skip CompressionFlags and CompressedChunks.Num
-		int srcPos = pos + 8 + cut;	// skip CompressedChunks
-		memcpy(buffer + dstPos, buffer + srcPos, compressedStart - srcPos);
-
-		if (compressedStart - cut != uncompressedStart)
-			appNotify("WARNING: wrong size of %s: differs in %d bytes", argPkgName, compressedStart - cut - uncompressedStart);
+	CUnpackJob Job;
+	Job.Package = Package;
+	Job.Failed  = false;
+	Job.Data    = NULL;
+	Job.Header  = NULL;
+	appSprintf(ARRAY_ARG(Job.OutFile), "%s/%s", BaseDir, PkgName);
+	appMakeDirectoryForFile(Job.OutFile);
 
-		// write the header
-		if (fwrite(buffer, uncompressedStart, 1, out) != 1) appError("Write failed");
-		delete buffer;
-
-		// copy data
-		Package->Seek(uncompressedStart);
-		CopyStream(Package, out, uncompressedSize - uncompressedStart);
-	}
-	else
-	{
-		// uncompressed package or fully compressed package
-		guard(LoadFullyCompressedPackage);
-
-		Package->Seek(0);
-		CopyStream(Package, out, uncompressedSize);
-
-		unguard;
-	}
-
-	// cleanup
-	fclose(out);
+	UnpackPackage(Job);
 
 	unguard;
 
@@ -0,0 +1,4 @@
+#define DO_GUARD		1
+
+// Use all supported games
+#include "GameDefines.h"
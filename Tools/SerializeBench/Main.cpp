@@ -0,0 +1,227 @@
+#include "Core.h"
+#include "UnCore.h"
+
+// Benchmark for FArchive serialization of simple types. Compares archives with memory window
+// (FMemReader, FFileReader) with FPlainMemReader, which calls virtual Serialize() for every value
+// just like all archives did before memory window was introduced. Before timing, results of
+// window archives are verified against FPlainMemReader.
+
+#define NUM_RECORDS			1000000		// each record is FVector + int, 16 bytes
+#define NUM_PASSES			20
+#define TEMP_FILE			"serializebench.tmp"
+
+// Memory reader without memory window
+class FPlainMemReader : public FArchive
+{
+	DECLARE_ARCHIVE(FPlainMemReader, FArchive);
+public:
+	FPlainMemReader(const void *data, int size)
+	:	DataPtr((const byte*)data)
+	,	DataSize(size)
+	{
+		IsLoading = true;
+		ArStopper = size;
+	}
+
+	virtual void Seek(int Pos)
+	{
+		ArPos = Pos;
+	}
+
+	virtual void Serialize(void *data, int size)
+	{
+		guard(FPlainMemReader::Serialize);
+		if (ArStopper > 0 && ArPos + size > ArStopper)
+			appError("Serializing behind stopper (%X+%X > %X)", ArPos, size, ArStopper);
+		if (ArPos + size > DataSize)
+			appError("Serializing behind end of buffer");
+		memcpy(data, DataPtr + ArPos, size);
+		ArPos += size;
+		unguard;
+	}
+
+	virtual int GetFileSize() const
+	{
+		return DataSize;
+	}
+
+protected:
+	const byte	*DataPtr;
+	int			DataSize;
+};
+
+
+static int NumErrors = 0;
+
+#define CHECK(expr)		\
+	if (!(expr))		\
+	{					\
+		appPrintf("ERROR: %s, line %d\n", #expr, __LINE__); \
+		NumErrors++;	\
+	}
+
+// Note: this function shouldn't have objects with destructors because of TRY
+static bool SerializeFails(FArchive &Ar)
+{
+	int Value;
+	TRY {
+		Ar << Value;
+	} CATCH {
+		return true;
+	}
+	return false;
+}
+
+static void TestMemReader(const byte *Data, int Size)
+{
+	FMemReader Ar(Data, Size);
+	FPlainMemReader Ref(Data, Size);
+	for (int i = 0; i < 1000; i++)
+	{
+		int a, b;
+		byte c, d;
+		Ar << a << c;
+		Ref << b << d;
+		CHECK(a == b && c == d && Ar.Tell() == Ref.Tell());
+	}
+	// stopper should limit the window
+	Ar.Seek(5);
+	Ref.Seek(5);
+	Ar.SetStopper(13);
+	int64 q, r;
+	Ar << q;
+	Ref << r;
+	CHECK(q == r && Ar.Tell() == 13 && Ar.IsStopper());
+	CHECK(SerializeFails(Ar));
+	Ar.SetStopper(0);
+	Ar.Seek(Size - 2);
+	int16 s;
+	Ar << s;
+	CHECK(Ar.IsEof());
+}
+
+static void TestFileReader(const byte *Data, int Size)
+{
+	FFileReader Ar(TEMP_FILE);
+	FPlainMemReader Ref(Data, Size);
+	int a, b;
+	for (int i = 0; i < 300000; i++)
+	{
+		Ar << a;
+		Ref << b;
+		CHECK(a == b);
+		if (i % 1000 == 7)
+		{
+			Ar.Seek(i * 3);
+			Ref.Seek(i * 3);
+		}
+		CHECK(Ar.Tell() == Ref.Tell());
+	}
+	Ar.Seek(100);
+	Ar.SetStopper(104);
+	Ar << a;
+	CHECK(SerializeFails(Ar));
+	Ar.SetStopper(0);
+	// reopen file, window should be dropped
+	Ar.Close();
+	Ar.Open();
+	Ar.Seek(8);
+	Ar << a;
+	CHECK(a == *(int*)(Data + 8) && Ar.Tell() == 12);
+}
+
+static FORCEINLINE uint32 FloatBits(float f)
+{
+	uint32 r;
+	memcpy(&r, &f, sizeof(r));
+	return r;
+}
+
+// Returns time in milliseconds; Checksum is used to compare data and to keep compiler from removing the loop
+static int Measure(FArchive &Ar, uint32 &Checksum)
+{
+	int StartTime = appMilliseconds();
+	for (int pass = 0; pass < NUM_PASSES; pass++)
+	{
+		Ar.Seek(0);
+		for (int i = 0; i < NUM_RECORDS; i++)
+		{
+			FVector V;
+			int x;
+			Ar << V << x;
+			Checksum += FloatBits(V.X) ^ FloatBits(V.Y) ^ FloatBits(V.Z) ^ x;
+		}
+	}
+	return appMilliseconds() - StartTime;
+}
+
+static void RunBenchmark(const byte *Data, int Size)
+{
+	guard(RunBenchmark);
+
+	uint32 Checksum1 = 0, Checksum2 = 0, Checksum3 = 0;
+	FPlainMemReader Plain(Data, Size);
+	int PlainTime = Measure(Plain, Checksum1);
+	FMemReader Mem(Data, Size);
+	int MemTime = Measure(Mem, Checksum2);
+	FFileReader File(TEMP_FILE);
+	int FileTime = Measure(File, Checksum3);
+	CHECK(Checksum1 == Checksum2 && Checksum1 == Checksum3);
+
+	appPrintf("%d records x %d passes:\n", NUM_RECORDS, NUM_PASSES);
+	appPrintf("  virtual Serialize():  %5d ms\n", PlainTime);
+	appPrintf("  FMemReader (window):  %5d ms, %.1fx faster\n", MemTime, (float)PlainTime / max(MemTime, 1));
+	appPrintf("  FFileReader (window): %5d ms\n", FileTime);
+
+	unguard;
+}
+
+static int RunTests()
+{
+	guard(RunTests);
+
+	int Size = NUM_RECORDS * 16;
+	byte *Data = (byte*)appMalloc(Size);
+	for (int i = 0; i < Size; i++)
+		Data[i] = (byte)(i * 7 + (i >> 8));
+
+	FILE *f = fopen(TEMP_FILE, "wb");
+	if (!f) appError("Unable to create %s", TEMP_FILE);
+	fwrite(Data, Size, 1, f);
+	fclose(f);
+
+	TestMemReader(Data, Size);
+	TestFileReader(Data, Size);
+	if (!NumErrors)
+		RunBenchmark(Data, Size);
+
+	remove(TEMP_FILE);
+	appFree(Data);
+
+	if (NumErrors) appPrintf("%d errors\n", NumErrors);
+	return NumErrors ? 1 : 0;
+
+	unguard;
+}
+
+
+int main(int argc, char **argv)
+{
+	// Note: this function shouldn't have objects with destructors because of TRY
+#if DO_GUARD
+	TRY {
+#endif
+
+	return RunTests();
+
+#if DO_GUARD
+	} CATCH {
+		if (GErrorHistory[0])
+			appPrintf("ERROR: %s\n", GErrorHistory);
+		else
+			appPrintf("Unknown error\n");
+		remove(TEMP_FILE);
+		exit(1);
+	}
+#endif
+}
@@ -0,0 +1,6 @@
+@echo off
+
+rm serializebench.exe
+bash build.sh
+
+serializebench.exe
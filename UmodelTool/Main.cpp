@@ -3,10 +3,14 @@
 #if _WIN32
 #include <direct.h>					// getcwd
 #else
-#include <unistd.h>					// getcwd
+#include <unistd.h>					// getcwd, fork
+#include <sys/mman.h>				// mmap
+#include <sys/wait.h>				// wait
 #endif
 
 // Classes for registration
+#include "Parallel.h"
+
 #include "UnrealClasses.h"
 #include "UnPackage.h"
 #include "UnAnimNotify.h"
@@ -293,33 +297,82 @@ static void ExportSkeleton(const USkeleton *Skeleton)
 }
 #endif // UNREAL4
 
+// Names of files created by exporters, see ExportFileNamesFunc_t
+
+static const char* SkeletalMeshFiles()
+{
+	if (GExportLods) return NULL;				// number of LODs is not known before loading
+	if (GSettings.ExportMd5Mesh) return "%s.md5mesh";
+	return GExportScripts ? "%s.psk|%s.pskx;%s.uc" : "%s.psk|%s.pskx";
+}
+
+static const char* StaticMeshFiles()
+{
+	return GExportLods ? NULL : "%s.pskx";
+}
+
+static const char* AnimationFiles()
+{
+	return GSettings.ExportMd5Mesh ? NULL : "%s.psa";	// md5anim: file per sequence
+}
+
+static const char* VertMeshFiles()
+{
+	return GExportScripts ? "%s_d.3d;%s_a.3d;%s.uc" : "%s_d.3d;%s_a.3d";
+}
+
+static const char* TextureFiles()
+{
+	return "%s.tga|%s.dds";
+}
+
+static const char* SoundFiles()
+{
+	return "%s.ogg|%s.wav|%s.fsb|%s.mp3|%s.xma|%s.x360audio|%s.ps3audio|%s.OGG|%s.unk";
+}
+
+static const char* GfxFiles()
+{
+	return "%s.gfx";
+}
+
+static const char* FaceFXFiles()
+{
+	return "%s.fxa";
+}
+
+static const char* MaterialFiles()
+{
+	return "%s.mat";
+}
+
 static void RegisterExporters()
 {
-	RegisterExporter("SkeletalMesh",  ExportSkeletalMesh2);
-	RegisterExporter("MeshAnimation", ExportMeshAnimation);
+	RegisterExporter("SkeletalMesh",  ExportSkeletalMesh2, SkeletalMeshFiles);
+	RegisterExporter("MeshAnimation", ExportMeshAnimation, AnimationFiles   );
 #if UNREAL3
-	RegisterExporter("SkeletalMesh3", ExportSkeletalMesh3);
-	RegisterExporter("AnimSet",       ExportAnimSet      );
+	RegisterExporter("SkeletalMesh3", ExportSkeletalMesh3, SkeletalMeshFiles);
+	RegisterExporter("AnimSet",       ExportAnimSet,       AnimationFiles   );
 #endif
-	RegisterExporter("VertMesh",      Export3D           );
-	RegisterExporter("StaticMesh",    ExportStaticMesh2  );
-	RegisterExporter("Texture",       ExportTexture      );
-	RegisterExporter("Sound",         ExportSound        );
+	RegisterExporter("VertMesh",      Export3D,            VertMeshFiles    );
+	RegisterExporter("StaticMesh",    ExportStaticMesh2,   StaticMeshFiles  );
+	RegisterExporter("Texture",       ExportTexture,       TextureFiles     );
+	RegisterExporter("Sound",         ExportSound,         SoundFiles       );
 #if UNREAL3
-	RegisterExporter("StaticMesh3",   ExportStaticMesh3  );
-	RegisterExporter("Texture2D",     ExportTexture      );
-	RegisterExporter("SoundNodeWave", ExportSoundNodeWave);
-	RegisterExporter("SwfMovie",      ExportGfx          );
-	RegisterExporter("FaceFXAnimSet", ExportFaceFXAnimSet);
-	RegisterExporter("FaceFXAsset",   ExportFaceFXAsset  );
+	RegisterExporter("StaticMesh3",   ExportStaticMesh3,   StaticMeshFiles  );
+	RegisterExporter("Texture2D",     ExportTexture,       TextureFiles     );
+	RegisterExporter("SoundNodeWave", ExportSoundNodeWave, SoundFiles       );
+	RegisterExporter("SwfMovie",      ExportGfx,           GfxFiles         );
+	RegisterExporter("FaceFXAnimSet", ExportFaceFXAnimSet, FaceFXFiles      );
+	RegisterExporter("FaceFXAsset",   ExportFaceFXAsset,   FaceFXFiles      );
 #endif // UNREAL3
 #if UNREAL4
-	RegisterExporter("SkeletalMesh4", ExportSkeletalMesh4);
-	RegisterExporter("StaticMesh4",   ExportStaticMesh4  );
-	RegisterExporter("Skeleton",      ExportSkeleton     );
-	RegisterExporter("SoundWave",     ExportSoundWave4   );
+	RegisterExporter("SkeletalMesh4", ExportSkeletalMesh4, SkeletalMeshFiles);
+	RegisterExporter("StaticMesh4",   ExportStaticMesh4,   StaticMeshFiles  );
+	RegisterExporter("Skeleton",      ExportSkeleton,      AnimationFiles   );
+	RegisterExporter("SoundWave",     ExportSoundWave4,    SoundFiles       );
 #endif // UNREAL4
-	RegisterExporter("UnrealMaterial", ExportMaterial    );			// register this after Texture/Texture2D exporters
+	RegisterExporter("UnrealMaterial", ExportMaterial,     MaterialFiles    );	// register this after Texture/Texture2D exporters
 }
 
 
@@ -371,12 +424,16 @@ static void PrintUsage()
 			"                    will load whole package\n"
 			"    -list           list contents of package\n"
 			"    -export         export specified object or whole package\n"
+			"    -deps           save dependencies of packages to the export directory,\n"
+			"                    they are used by -export -depgroups\n"
 			"    -taglist        list of tags to override game autodetection\n"
 			"    -version        display umodel version information\n"
 			"    -help           display this help page\n"
 			"\n"
 			"Developer commands:\n"
 			"    -log=file       write log to the specified file\n"
+			"    -objlog=file    write tab-separated statistics for every loaded and\n"
+			"                    exported object to the specified file\n"
 			"    -dump           dump object information to console\n"
 			"    -pkginfo        load package and display its information\n"
 #if SHOW_HIDDEN_SWITCHES
@@ -393,6 +450,19 @@ static void PrintUsage()
 			"    -pkgver=nnn     override package version (advanced option!)\n"
 			"    -pkg=package    load extra package (in addition to <package>)\n"
 			"    -obj=object     specify object(s) to load\n"
+			"    -threads=N      limit number of worker threads, 1 disables threading\n"
+			"    -prefetch=N     load up to N imported packages in background threads\n"
+			"                    (0 = disabled, default)\n"
+#if !_WIN32
+			"    -workers=N      export packages in N processes, a package which crashes\n"
+			"                    its process is skipped\n"
+#endif
+			"    -summary        don't print messages for every loaded or exported object\n"
+			"    -quiet          don't print anything to console except errors\n"
+#if UNREAL3
+			"    -bulkmem=N      limit memory used for texture and sound data which could\n"
+			"                    be reloaded, in megabytes (0 = unlimited, default 256)\n"
+#endif
 #if HAS_UI
 			"    -gui            force startup UI to appear\n" //?? debug-only option?
 #endif
@@ -431,6 +501,13 @@ static void PrintUsage()
 			"    -notgacomp      disable TGA compression\n"
 			"    -nooverwrite    prevent existing files from being overwritten (better\n"
 			"                    performance)\n"
+			"    -dedup          skip cooked copies of already exported objects, list\n"
+			"                    them in duplicates.txt\n"
+			"    -dedup=link     same as -dedup, but create hard links to exported files\n"
+			"    -incremental    skip packages which weren't changed since previous export,\n"
+			"                    report stale files\n"
+			"    -depgroups      export whole packages in groups of dependent packages,\n"
+			"                    releasing objects after every group (see -deps)\n"
 			"\n"
 			"Supported resources for export:\n"
 			"    SkeletalMesh    exported as ActorX psk file or MD5Mesh\n"
@@ -490,11 +567,16 @@ bool ExportObjects(const TArray<UObject*> *Objects, IProgressCallback* progress)
 
 		if (notifyPackage != ExpObj->Package)
 		{
+			if (notifyPackage) FinishPackageExport(notifyPackage);
 			notifyPackage = ExpObj->Package;
 			appSetNotifyHeader(notifyPackage->Filename);
 		}
 
 		bool done = ExportObject(ExpObj);
+#if UNREAL3
+		// exported data is not needed anymore
+		FByteBulkData::TrimMemory();
+#endif
 
 		if (!done && hasObjectList)
 		{
@@ -502,6 +584,9 @@ bool ExportObjects(const TArray<UObject*> *Objects, IProgressCallback* progress)
 			appPrintf("ERROR: Export object %s: unsupported type %s\n", ExpObj->Name, ExpObj->GetClassName());
 		}
 	}
+	if (notifyPackage) FinishPackageExport(notifyPackage);
+	// release files which were opened for loading bulk data
+	UnPackage::CloseAllReaders();
 
 	return true;
 
@@ -509,6 +594,318 @@ bool ExportObjects(const TArray<UObject*> *Objects, IProgressCallback* progress)
 }
 
 
+static bool SkipExportedObject(UnPackage* Package, int ExportIndex)
+{
+	return IsDuplicateExport(Package, ExportIndex) || IsExportFilePresent(Package, ExportIndex);
+}
+
+// Options which affect the set of exported files or their content. Signature is stored in
+// the export manifest, so packages exported with different options are exported again.
+static uint32 GetExportOptionsSignature()
+{
+	char Options[256];
+	appSprintf(ARRAY_ARG(Options), "%d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %X %d",
+		GSettings.UseSkeletalMesh, GSettings.UseAnimation, GSettings.UseStaticMesh,
+		GSettings.UseTexture, GSettings.UseLightmapTexture, GSettings.UseSound,
+		GSettings.UseScaleForm, GSettings.UseFaceFx, GSettings.ExportMd5Mesh,
+		GExportScripts, GExportLods, GNoTgaCompress, GExportDDS, GUncook, GUseGroups,
+		GDedupExports, GSettings.GameOverride, GSettings.Platform);
+	return appStrHashNoCase(Options);
+}
+
+
+// Build dependency graph for packages and save it. Packages which are not in the list are
+// kept in the graph.
+static void SavePackageDeps(const TArray<UnPackage*> &Packages)
+{
+	guard(SavePackageDeps);
+
+	char Filename[1024];
+	appSprintf(ARRAY_ARG(Filename), "%s/%s", *GSettings.ExportPath, PACKAGE_DEPS_FILENAME);
+	CPackageDeps Deps;
+	Deps.Load(Filename);
+	for (int i = 0; i < Packages.Num(); i++)
+		Deps.AddPackage(Packages[i]);
+	if (!Deps.Save(Filename)) return;
+
+	TArray<UnPackage*> Scheduled;
+	CopyArray(Scheduled, Packages);
+	TArray<int> GroupSizes;
+	Deps.Schedule(Scheduled, GroupSizes);
+	appPrintf("Saved dependencies of %d package(s) to %s, %d export group(s)\n", Packages.Num(), Filename, GroupSizes.Num());
+
+	unguard;
+}
+
+
+static bool GExportDepGroups = false;
+
+// Export whole packages in groups which don't share objects (-depgroups). The dependency graph
+// is built from tables of the loaded packages, and extended with the graph saved with -deps
+// when it is available. Objects are released after exporting every group, so memory usage
+// doesn't grow with the number of packages. Groups are independent, so imports of the next
+// group are loaded by prefetch threads while the current group is exported.
+static void ExportPackageGroups(TArray<UnPackage*> &Packages)
+{
+	guard(ExportPackageGroups);
+
+	CPackageDeps Deps;
+	bool HasSavedDeps = Deps.Load(va("%s/%s", *GSettings.ExportPath, PACKAGE_DEPS_FILENAME));
+	// update the graph with actual information
+	for (int i = 0; i < Packages.Num(); i++)
+		Deps.AddPackage(Packages[i]);
+
+	TArray<int> GroupSizes;
+	Deps.Schedule(Packages, GroupSizes);
+	appPrintf("Grouped export: %d package(s) in %d group(s), %s dependency graph\n", Packages.Num(), GroupSizes.Num(),
+		HasSavedDeps ? "saved" : "no saved");
+
+	int First = 0;
+	for (int Group = 0; Group < GroupSizes.Num(); Group++)
+	{
+		int Next = First + GroupSizes[Group];
+		UObject::BeginLoad();
+		for (int i = First; i < Next; i++)
+			LoadWholePackage(Packages[i], NULL, SkipExportedObject);
+		UObject::EndLoad();
+
+		// start loading imports of the next group in background (when -prefetch is used)
+		if (Group + 1 < GroupSizes.Num())
+		{
+			for (int i = Next; i < Next + GroupSizes[Group + 1]; i++)
+				Packages[i]->PrefetchImports();
+		}
+		First = Next;
+
+		ExportObjects(NULL);
+		// objects of the next group don't reference these objects
+		ReleaseAllObjects();
+	}
+
+	unguard;
+}
+
+
+/*-----------------------------------------------------------------------------
+	Export in worker processes
+
+	Supervisor process finds packages once, then forks worker processes which
+	take batches of packages from the queue placed in shared memory. A worker
+	which failed to export a package exits, so an error doesn't affect other
+	packages; the supervisor marks the package and starts a new worker. A worker
+	which died without failing on a package is not restarted.
+-----------------------------------------------------------------------------*/
+
+static int GNumExportWorkers = 0;
+
+#if !_WIN32
+
+#define MAX_EXPORT_WORKERS			64
+#define WORKER_BATCH_SIZE			8
+#define EXPORT_REPORT_FILENAME		"umodel_report.txt"
+
+enum EWorkerPackageState
+{
+	WPS_Pending,
+	WPS_Working,
+	WPS_Done,
+	WPS_UpToDate,					// skipped by incremental export
+	WPS_Failed,						// error was detected by the worker
+	WPS_Crashed,					// worker has died while exporting the package
+};
+
+static const char* WorkerStateNames[] =
+{
+	"not processed", "not processed", "ok", "up to date", "failed", "crashed"
+};
+
+struct CExportWorkerSlot
+{
+	volatile int	Current;		// package being exported, or the next package of the batch
+	volatile int	BatchEnd;
+	int				Pid;			// used by the supervisor only
+};
+
+// Shared between the supervisor and worker processes
+struct CExportWorkerQueue
+{
+	volatile int	NextPackage;
+	CExportWorkerSlot Slots[MAX_EXPORT_WORKERS];
+	volatile byte	State[1];		// EWorkerPackageState for every package, variable size
+};
+
+// Export the package in a worker process. Exits the process when export has failed.
+static void ExportPackageInWorker(const CGameFileInfo *info, volatile byte &State)
+{
+	// Note: this function shouldn't have objects with destructors because of TRY
+	TRY
+	{
+		if (IsPackageExported(info))
+		{
+			State = WPS_UpToDate;
+			return;
+		}
+		UnPackage *Package = UnPackage::LoadPackage(info->RelativeName);
+		if (!Package)
+		{
+			State = WPS_Failed;
+			return;
+		}
+		if (IsPackageExported(info, Package))
+		{
+			State = WPS_UpToDate;
+			return;
+		}
+		InitClassAndExportSystems(Package->Game);
+		UObject::BeginLoad();
+		LoadWholePackage(Package, NULL, SkipExportedObject);
+		UObject::EndLoad();
+		ExportObjects(NULL);
+		ReleaseAllObjects();
+		State = WPS_Done;
+	}
+	CATCH_CRASH
+	{
+		// state of the process is not consistent anymore
+		State = WPS_Failed;
+		FFileWriter::CleanupOnError();
+#if DO_GUARD
+		appNotify("ERROR: %s\n", GErrorHistory);
+#endif
+		exit(1);
+	}
+}
+
+static void ExportWorkerProcess(CExportWorkerQueue *Queue, int SlotIndex, const TArray<const CGameFileInfo*> &Files)
+{
+	CExportWorkerSlot &Slot = Queue->Slots[SlotIndex];
+	if (GIncrementalExport)
+		OpenExportManifest(*GSettings.ExportPath, GetExportOptionsSignature());
+	while (true)
+	{
+		if (Slot.Current >= Slot.BatchEnd)
+		{
+			// take the next batch from the queue
+			int First = appInterlockedAdd(&Queue->NextPackage, WORKER_BATCH_SIZE) - WORKER_BATCH_SIZE;
+			if (First >= Files.Num()) break;
+			Slot.BatchEnd = min(First + WORKER_BATCH_SIZE, Files.Num());
+			Slot.Current  = First;
+		}
+		int Index = Slot.Current;
+		Queue->State[Index] = WPS_Working;
+		ExportPackageInWorker(Files[Index], Queue->State[Index]);
+		Slot.Current = Index + 1;
+	}
+	// note: the manifest is not compacted here, the supervisor will do that
+	exit(0);
+}
+
+static void StartExportWorker(CExportWorkerQueue *Queue, int SlotIndex, const TArray<const CGameFileInfo*> &Files)
+{
+	int Pid = appFork();
+	if (Pid < 0)
+		appError("Unable to start a worker process");
+	if (Pid == 0)
+		ExportWorkerProcess(Queue, SlotIndex, Files);		// never returns
+	Queue->Slots[SlotIndex].Pid = Pid;
+}
+
+// Export packages using worker processes, returns process exit code
+static int ExportWithWorkers(const TArray<const CGameFileInfo*> &Files)
+{
+	guard(ExportWithWorkers);
+
+	if (GDedupExports != DEDUP_NONE)
+	{
+		appPrintf("WARNING: -dedup is not supported by export workers, disabled\n");
+		GDedupExports = DEDUP_NONE;
+	}
+
+	int NumWorkers = min(GNumExportWorkers, MAX_EXPORT_WORKERS);
+	NumWorkers = min(NumWorkers, (Files.Num() + WORKER_BATCH_SIZE - 1) / WORKER_BATCH_SIZE);
+	size_t QueueSize = sizeof(CExportWorkerQueue) + Files.Num();
+	CExportWorkerQueue *Queue = (CExportWorkerQueue*)mmap(NULL, QueueSize, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+	if (Queue == MAP_FAILED)
+		appError("Unable to allocate shared memory");
+
+	appPrintf("Exporting %d package(s) with %d worker process(es)\n", Files.Num(), NumWorkers);
+	for (int i = 0; i < NumWorkers; i++)
+		StartExportWorker(Queue, i, Files);
+
+	int NumActive = NumWorkers, NumRestarts = 0, NumLostWorkers = 0;
+	while (NumActive > 0)
+	{
+		int Status;
+		int Pid = wait(&Status);
+		if (Pid < 0) break;
+		int SlotIndex;
+		for (SlotIndex = 0; SlotIndex < NumWorkers; SlotIndex++)
+			if (Queue->Slots[SlotIndex].Pid == Pid) break;
+		if (SlotIndex == NumWorkers) continue;
+		CExportWorkerSlot &Slot = Queue->Slots[SlotIndex];
+		Slot.Pid = 0;
+		NumActive--;
+		if (WIFEXITED(Status) && WEXITSTATUS(Status) == 0)
+			continue;						// the worker has finished its work
+		// the worker has failed, skip the package and continue with a new process
+		int Index = Slot.Current;
+		if (Index >= Slot.BatchEnd || (Queue->State[Index] != WPS_Working && Queue->State[Index] != WPS_Failed))
+		{
+			// the worker has died without failing on a package (for example, during startup), so
+			// a new worker would fail the same way; packages of its batch remain unprocessed
+			appPrintf("ERROR: worker process has failed\n");
+			NumLostWorkers++;
+			continue;
+		}
+		if (Queue->State[Index] != WPS_Failed)
+		{
+			appPrintf("ERROR: worker process has crashed while exporting %s\n", Files[Index]->RelativeName);
+			Queue->State[Index] = WPS_Crashed;
+		}
+		Slot.Current = Index + 1;
+		StartExportWorker(Queue, SlotIndex, Files);
+		NumActive++;
+		NumRestarts++;
+	}
+
+	// write the report
+	int Counts[ARRAY_COUNT(WorkerStateNames)];
+	memset(Counts, 0, sizeof(Counts));
+	char ReportFile[1024];
+	appSprintf(ARRAY_ARG(ReportFile), "%s/%s", *GSettings.ExportPath, EXPORT_REPORT_FILENAME);
+	appMakeDirectoryForFile(ReportFile);
+	FILE *f = fopen(ReportFile, "w");
+	for (int i = 0; i < Files.Num(); i++)
+	{
+		int State = Queue->State[i];
+		Counts[State]++;
+		if (f) fprintf(f, "%s\t%s\n", Files[i]->RelativeName, WorkerStateNames[State]);
+		if (State == WPS_Failed || State == WPS_Crashed)
+			appPrintf("%s: %s\n", Files[i]->RelativeName, WorkerStateNames[State]);
+	}
+	if (f) fclose(f);
+	munmap(Queue, QueueSize);
+
+	// workers have appended records to the manifest, compact it
+	if (GIncrementalExport)
+	{
+		OpenExportManifest(*GSettings.ExportPath, GetExportOptionsSignature());
+		CloseExportManifest();
+	}
+
+	int NumNotProcessed = Counts[WPS_Pending] + Counts[WPS_Working];
+	appPrintf("Exported %d package(s), %d up to date, %d failed, %d crashed, %d worker restart(s). Report: %s\n",
+		Counts[WPS_Done], Counts[WPS_UpToDate], Counts[WPS_Failed], Counts[WPS_Crashed], NumRestarts, ReportFile);
+	if (NumLostWorkers)
+		appPrintf("%d worker process(es) failed, %d package(s) not processed\n", NumLostWorkers, NumNotProcessed);
+	return (Counts[WPS_Failed] || Counts[WPS_Crashed] || NumNotProcessed) ? 1 : 0;
+
+	unguard;
+}
+
+#endif // !_WIN32
+
+
 struct ClassStats
 {
 	const char*	Name;
@@ -701,6 +1098,7 @@ int main(int argc, char **argv)
 		CMD_PkgInfo,
 		CMD_List,
 		CMD_Export,
+		CMD_Deps,
 	};
 
 	static byte mainCmd = CMD_View;
@@ -727,6 +1125,7 @@ int main(int argc, char **argv)
 			OPT_VALUE("export",  mainCmd, CMD_Export)
 			OPT_VALUE("pkginfo", mainCmd, CMD_PkgInfo)
 			OPT_VALUE("list",    mainCmd, CMD_List)
+			OPT_VALUE("deps",    mainCmd, CMD_Deps)
 #if VSTUDIO_INTEGRATION
 			OPT_BOOL ("debug",   GUseDebugger)
 #endif
@@ -751,6 +1150,12 @@ int main(int argc, char **argv)
 			OPT_BOOL ("dds",     GExportDDS)
 			OPT_BOOL ("notgacomp", GNoTgaCompress)
 			OPT_BOOL ("nooverwrite", GDontOverwriteFiles)
+			OPT_VALUE("dedup",   GDedupExports, DEDUP_LIST)
+			OPT_VALUE("dedup=link", GDedupExports, DEDUP_LINK)
+			OPT_BOOL ("incremental", GIncrementalExport)
+			OPT_BOOL ("depgroups", GExportDepGroups)
+			OPT_VALUE("summary", GLogLevel, LOG_Summary)
+			OPT_VALUE("quiet",   GLogLevel, LOG_Quiet)
 #if HAS_UI
 			OPT_BOOL ("gui",     forceUI)
 #endif
@@ -770,6 +1175,10 @@ int main(int argc, char **argv)
 		{
 			appOpenLogFile(opt+4);
 		}
+		else if (!strnicmp(opt, "objlog=", 7))
+		{
+			appOpenObjectLog(opt+7);
+		}
 		else if (!strnicmp(opt, "path=", 5))
 		{
 			SetPathOption(GSettings.GamePath, opt+5);
@@ -799,6 +1208,48 @@ int main(int argc, char **argv)
 			}
 			GForcePackageVersion = ver;
 		}
+		else if (!strnicmp(opt, "threads=", 8))
+		{
+			int num = atoi(opt+8);
+			if (num < 1)
+			{
+				appPrintf("ERROR: number of threads is not valid: %s\n", opt+8);
+				exit(0);
+			}
+			GNumThreads = num;
+		}
+		else if (!strnicmp(opt, "prefetch=", 9))
+		{
+			int num = atoi(opt+9);
+			if (num < 0)
+			{
+				appPrintf("ERROR: number of prefetched packages is not valid: %s\n", opt+9);
+				exit(0);
+			}
+			GPrefetchPackages = num;
+		}
+		else if (!strnicmp(opt, "workers=", 8))
+		{
+			int num = atoi(opt+8);
+			if (num < 0)
+			{
+				appPrintf("ERROR: number of workers is not valid: %s\n", opt+8);
+				exit(0);
+			}
+			GNumExportWorkers = num;
+		}
+#if UNREAL3
+		else if (!strnicmp(opt, "bulkmem=", 8))
+		{
+			int mem = atoi(opt+8);
+			if (mem < 0)
+			{
+				appPrintf("ERROR: memory limit is not valid: %s\n", opt+8);
+				exit(0);
+			}
+			GMaxBulkDataMemory = mem;
+		}
+#endif // UNREAL3
 		else if (!strnicmp(opt, "pkg=", 4))
 		{
 			const char *pkg = opt+4;
@@ -943,8 +1394,26 @@ int main(int argc, char **argv)
 		appSetRootDirectory(".");			// scan for packages
 	}
 
+	if (mainCmd == CMD_Export && GNumExportWorkers && !objectsToLoad.Num() && packagesToLoad.Num())
+	{
+#if !_WIN32
+		// export whole packages in worker processes
+		TArray<const CGameFileInfo*> Files;
+		for (int i = 0; i < packagesToLoad.Num(); i++)
+			appFindGameFiles(packagesToLoad[i], Files);
+		if (!Files.Num())
+			CommandLineError("failed to find provided packages");
+		return ExportWithWorkers(Files);
+#else
+		appPrintf("WARNING: -workers option is not supported on this platform\n");
+#endif
+	}
+
 	// Try to load all packages first.
 	// Note: in this code, packages will be loaded without creating any exported objects.
+	if (mainCmd == CMD_Export && GIncrementalExport && !objectsToLoad.Num())
+		OpenExportManifest(*GSettings.ExportPath, GetExportOptionsSignature());	// whole packages are exported
+	int numUpToDate = 0;
 	for (int i = 0; i < packagesToLoad.Num(); i++)
 	{
 //		UnPackage *Package = UnPackage::LoadPackage(packagesToLoad[i]);
@@ -959,12 +1428,33 @@ int main(int argc, char **argv)
 		{
 			for (int j = 0; j < Files.Num(); j++)
 			{
+				// skip packages which weren't changed since previous incremental export
+				if (IsPackageExported(Files[j]))
+				{
+					numUpToDate++;
+					continue;
+				}
 				UnPackage* Package = UnPackage::LoadPackage(Files[j]->RelativeName);
+				if (Package && IsPackageExported(Files[j], Package))
+				{
+					numUpToDate++;
+					continue;
+				}
 				Packages.Add(Package);
 			}
 		}
 	}
 
+	if (numUpToDate)
+	{
+		appPrintf("Skipped %d up-to-date package(s)\n", numUpToDate);
+		if (!Packages.Num())
+		{
+			CloseExportManifest();
+			return 0;
+		}
+	}
+
 #if !HAS_UI
 	if (!Packages.Num())
 	{
@@ -1001,6 +1491,12 @@ int main(int argc, char **argv)
 		return 0;
 	}
 
+	if (mainCmd == CMD_Deps)
+	{
+		SavePackageDeps(Packages);
+		return 0;
+	}
+
 	// register exporters and classes
 	InitClassAndExportSystems(Packages[0]->Game);
 
@@ -1010,6 +1506,18 @@ int main(int argc, char **argv)
 		return 0;					// already displayed when loaded package; extend it?
 	}
 
+	if (GExportDepGroups)
+	{
+		if (mainCmd == CMD_Export && !objectsToLoad.Num() && !GApplication.GuiShown)
+		{
+			ExportPackageGroups(Packages);
+			ResetExportedList();
+			CloseExportManifest();
+			return 0;
+		}
+		appPrintf("WARNING: -depgroups is used only for export of whole packages, ignored\n");
+	}
+
 	// load requested objects if any, or fully load everything
 	UObject::BeginLoad();
 	if (objectsToLoad.Num())
@@ -1057,8 +1565,11 @@ int main(int argc, char **argv)
 	else
 	{
 		// fully load all packages
+		// when exporting, don't load objects which are duplicates of already loaded ones, or
+		// which were exported before
+		SkipExportFunc_t skipExport = (mainCmd == CMD_Export) ? SkipExportedObject : NULL;
 		for (int pkg = 0; pkg < Packages.Num(); pkg++)
-			LoadWholePackage(Packages[pkg]);
+			LoadWholePackage(Packages[pkg], NULL, skipExport);
 	}
 	UObject::EndLoad();
 
@@ -1072,6 +1583,7 @@ int main(int argc, char **argv)
 		appPrintf("\n");
 		// display list of classes
 		DisplayPackageStats(Packages);
+		CloseExportManifest();
 		return 0;
 	}
 
@@ -1083,6 +1595,7 @@ int main(int argc, char **argv)
 	{
 		ExportObjects(exprtAll ? NULL : &Objects);
 		ResetExportedList();
+		CloseExportManifest();
 		if (!GApplication.GuiShown)
 			return 0;
 		// switch to a viewer in GUI mode
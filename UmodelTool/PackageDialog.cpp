@@ -706,17 +706,53 @@ void UIPackageDialog::ScanContent()
 }
 
 
-static void CopyStream(FArchive *Src, FILE *Dst, int Count)
+#define COPY_BUFFER_SIZE		(1024*1024)
+
+// Copy the file to the "saved" directory. Regular files are copied by the system when
+// possible, files from archives are copied with large blocks.
+static void SaveFile(const CGameFileInfo* file)
 {
-	byte buffer[16384];
+	FArchive *Ar = appCreateFileReader(file);
+	if (!Ar) return;
+
+	guard(SaveFile);
 
-	while (Count > 0)
+	// prepare destination file
+	char OutFile[1024];
+	appSprintf(ARRAY_ARG(OutFile), "UmodelSaved/%s", file->ShortFilename);	//!! make an option, add menu item to open "saved" directory
+	appMakeDirectoryForFile(OutFile);
+	FFileWriter *Out = new FFileWriter(OutFile, FRO_NoOpenError);
+	if (Out->IsOpen())
+	{
+		// copy data
+		int64 Size = Ar->GetFileSize64();
+		FFileReader *FileReader = Ar->CastTo<FFileReader>();
+		if (FileReader)
+		{
+			Out->CopyFrom(*FileReader, 0, Size);
+		}
+		else
+		{
+			byte *Buffer = (byte*)appMalloc(COPY_BUFFER_SIZE);
+			while (Size > 0)
+			{
+				int Count = (int)min(Size, (int64)COPY_BUFFER_SIZE);
+				Ar->Serialize(Buffer, Count);
+				Out->Serialize(Buffer, Count);
+				Size -= Count;
+			}
+			appFree(Buffer);
+		}
+	}
+	else
 	{
-		int Size = min(Count, sizeof(buffer));
-		Src->Serialize(buffer, Size);
-		if (fwrite(buffer, Size, 1, Dst) != 1) appError("Write failed");
-		Count -= Size;
+		appPrintf("Error opening file \"%s\" ...\n", OutFile);
 	}
+	// cleanup
+	delete Out;
+	delete Ar;
+
+	unguardf("%s", file->RelativeName);
 }
 
 //!! TODO: move to PackageUtils.cpp
@@ -745,22 +781,7 @@ void UIPackageDialog::SavePackages()
 		if (!progress.Progress(file->RelativeName, i, GNumPackageFiles))
 			break;
 
-		FArchive *Ar = appCreateFileReader(file);
-		if (Ar)
-		{
-			guard(SaveFile);
-			// prepare destination file
-			char OutFile[1024];
-			appSprintf(ARRAY_ARG(OutFile), "UmodelSaved/%s", file->ShortFilename);	//!! make an option, add menu item to open "saved" directory
-			appMakeDirectoryForFile(OutFile);
-			FILE *out = fopen(OutFile, "wb");
-			// copy data
-			CopyStream(Ar, out, Ar->GetFileSize());
-			// cleanup
-			delete Ar;
-			fclose(out);
-			unguardf("%s", file->RelativeName);
-		}
+		SaveFile(file);
 
 		// TODO: refactor the code! Should process linked content by adding them to SelectedPackages list etc
 		// Save ubulk files too
@@ -775,20 +796,7 @@ void UIPackageDialog::SavePackages()
 			// then repeat saving procedure for new file
 			const CGameFileInfo* file = appFindGameFile(SrcFile);
 			if (file)
-			{
-				FArchive *Ar = appCreateFileReader(file);
-				if (Ar)
-				{
-					guard(SaveUbulk);
-					char OutFile[1024];
-					appSprintf(ARRAY_ARG(OutFile), "UmodelSaved/%s", file->ShortFilename);	//!! make an option, add menu item to open "saved" directory
-					FILE *out = fopen(OutFile, "wb");
-					CopyStream(Ar, out, Ar->GetFileSize());
-					fclose(out);
-					delete Ar;
-					unguardf("%s", SrcFile);
-				}
-			}
+				SaveFile(file);
 		}
 	}
 
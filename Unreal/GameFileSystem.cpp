@@ -135,14 +135,47 @@ static TArray<CGameFileInfo*> GameFiles;
 int GNumPackageFiles = 0;
 int GNumForeignFiles = 0;
 
-#define GAME_FILE_HASH_SIZE		4096
-#define GAME_FILE_HASH_MASK		(GAME_FILE_HASH_SIZE-1)
+#define GAME_FILE_HASH_SIZE		4096	// initial size of hash table
+#define GAME_FILE_HASH_LOAD		1		// maximal average number of files per hash chain
 
 //#define PRINT_HASH_DISTRIBUTION	1
 //#define DEBUG_HASH				1
 //#define DEBUG_HASH_NAME			"MiniMap"
 
-static CGameFileInfo* GGameFileHash[GAME_FILE_HASH_SIZE];
+// Hash table of CGameFileInfo, size is power of 2. Table is grown when number of files
+// exceeds GameFileHashSize * GAME_FILE_HASH_LOAD.
+static CGameFileInfo** GGameFileHash = NULL;
+static int GameFileHashSize = 0;
+
+
+// Directory tree. It is used to limit wildcard search to a subtree.
+struct CGameFolder
+{
+	char*			Path;			// relative to RootDirectory, without trailing '/'; root is ""
+	int				PathLen;
+	CGameFolder*	FirstChild;
+	CGameFolder*	LastChild;
+	CGameFolder*	NextSibling;
+	CGameFileInfo*	FirstFile;		// files are linked with CGameFileInfo::FolderNext
+	CGameFileInfo*	LastFile;
+	CGameFolder*	HashNext;
+};
+
+#define GAME_FOLDER_HASH_SIZE	4096
+
+static CGameFolder* GGameFolderHash[GAME_FOLDER_HASH_SIZE];
+static CGameFolder* GRootFolder = NULL;
+
+
+// Extension index. It is used to enumerate files of particular type.
+struct CGameFileExtension
+{
+	const char*		Ext;			// points to Extension of the first file with this extension
+	CGameFileInfo*	FirstFile;		// files are linked with CGameFileInfo::ExtNext
+	CGameFileInfo*	LastFile;
+};
+
+static TArray<CGameFileExtension> GameFileExtensions;
 
 
 #if UNREAL3
@@ -152,22 +185,21 @@ static int            GStartupPackageInfoWeight = 0;
 #endif
 
 
-static int GetHashForFileName(const char* FileName, bool stripExtension)
+// Returns full hash value, caller should mask it with hash table size
+static unsigned GetHashForFileName(const char* FileName, bool stripExtension)
 {
 	const char* s1 = strrchr(FileName, '/'); // assume path delimiters are normalized
 	s1 = (s1 != NULL) ? s1 + 1 : FileName;
 	const char* s2 = stripExtension ? strrchr(s1, '.') : NULL;
 	int len = (s2 != NULL) ? s2 - s1 : strlen(s1);
 
-	uint16 hash = 0;
+	unsigned hash = 0;
 	for (int i = 0; i < len; i++)
 	{
 		char c = s1[i];
 		if (c >= 'A' && c <= 'Z') c += 'a' - 'A'; // lowercase a character
-		hash = ROL16(hash, 5) - hash + ((c << 4) + c ^ 0x13F);	// some crazy hash function
+		hash = ROL32(hash, 5) - hash + ((c << 4) + c ^ 0x13F);	// some crazy hash function
 	}
-//	hash += (len << 6) - len;
-	hash &= GAME_FILE_HASH_MASK;
 #ifdef DEBUG_HASH_NAME
 	if (strstr(FileName, DEBUG_HASH_NAME))
 		printf("-> hash[%s] (%s,%d) -> %X\n", FileName, s1, len, hash);
@@ -175,13 +207,131 @@ static int GetHashForFileName(const char* FileName, bool stripExtension)
 	return hash;
 }
 
+static void ResizeGameFileHash(int NewSize)
+{
+	guard(ResizeGameFileHash);
+
+	if (GGameFileHash) appFree(GGameFileHash);
+	GameFileHashSize = NewSize;
+	GGameFileHash = (CGameFileInfo**)appMalloc(NewSize * sizeof(CGameFileInfo*));
+	// reinsert files in registration order, so hash chains will have the same order as before
+	for (int i = 0; i < GameFiles.Num(); i++)
+	{
+		CGameFileInfo* info = GameFiles[i];
+		int hash = GetHashForFileName(info->ShortFilename, true) & (NewSize - 1);
+		info->HashNext = GGameFileHash[hash];
+		GGameFileHash[hash] = info;
+	}
+
+	unguard;
+}
+
+static unsigned GetHashForFolder(const char* Path, int PathLen)
+{
+	unsigned hash = 0;
+	for (int i = 0; i < PathLen; i++)
+	{
+		char c = Path[i];
+		if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+		hash = ROL32(hash, 5) - hash + ((c << 4) + c ^ 0x13F);
+	}
+	return hash & (GAME_FOLDER_HASH_SIZE - 1);
+}
+
+static CGameFolder* FindGameFolder(const char* Path, int PathLen)
+{
+	for (CGameFolder* Folder = GGameFolderHash[GetHashForFolder(Path, PathLen)]; Folder; Folder = Folder->HashNext)
+	{
+		if (Folder->PathLen == PathLen && !strnicmp(Folder->Path, Path, PathLen))
+			return Folder;
+	}
+	return NULL;
+}
+
+static CGameFolder* FindOrAddGameFolder(const char* Path, int PathLen)
+{
+	if (!PathLen && GRootFolder) return GRootFolder;
+
+	CGameFolder* Folder = FindGameFolder(Path, PathLen);
+	if (Folder) return Folder;
+
+	Folder = new CGameFolder;
+	memset(Folder, 0, sizeof(CGameFolder));
+	Folder->Path = (char*)appMalloc(PathLen + 1);
+	memcpy(Folder->Path, Path, PathLen);
+	Folder->PathLen = PathLen;
+	int hash = GetHashForFolder(Path, PathLen);
+	Folder->HashNext = GGameFolderHash[hash];
+	GGameFolderHash[hash] = Folder;
+
+	if (!PathLen)
+	{
+		GRootFolder = Folder;
+		return Folder;
+	}
+
+	// link to parent folder
+	int ParentLen = PathLen - 1;
+	while (ParentLen > 0 && Path[ParentLen] != '/') ParentLen--;
+	CGameFolder* Parent = FindOrAddGameFolder(Path, ParentLen);
+	if (Parent->LastChild)
+		Parent->LastChild->NextSibling = Folder;
+	else
+		Parent->FirstChild = Folder;
+	Parent->LastChild = Folder;
+
+	return Folder;
+}
+
+static CGameFileExtension* FindGameFileExtension(const char* Ext)
+{
+	static CGameFileExtension* Last = NULL;
+	if (Last && !stricmp(Last->Ext, Ext)) return Last;
+	for (int i = 0; i < GameFileExtensions.Num(); i++)
+	{
+		CGameFileExtension* E = &GameFileExtensions[i];
+		if (!stricmp(E->Ext, Ext))
+		{
+			Last = E;
+			return E;
+		}
+	}
+	return NULL;
+}
+
+// Add registered file to folder and extension indices
+static void IndexGameFile(CGameFileInfo* info)
+{
+	// folder
+	CGameFolder* Folder = FindOrAddGameFolder(info->RelativeName, max(info->ShortFilename - info->RelativeName - 1, 0));
+	if (Folder->LastFile)
+		Folder->LastFile->FolderNext = info;
+	else
+		Folder->FirstFile = info;
+	Folder->LastFile = info;
+
+	// extension
+	const char* Ext = info->Extension ? info->Extension : "";
+	CGameFileExtension* E = FindGameFileExtension(Ext);
+	if (!E)
+	{
+		E = &GameFileExtensions[GameFileExtensions.AddZeroed()];
+		E->Ext = Ext;
+	}
+	if (E->LastFile)
+		E->LastFile->ExtNext = info;
+	else
+		E->FirstFile = info;
+	E->LastFile = info;
+}
+
 #if PRINT_HASH_DISTRIBUTION
 
 static void PrintHashDistribution()
 {
 	int hashCounts[1024];
 	memset(hashCounts, 0, sizeof(hashCounts));
-	for (int hash = 0; hash < GAME_FILE_HASH_SIZE; hash++)
+	for (int hash = 0; hash < GameFileHashSize; hash++)
 	{
 		int count = 0;
 		for (CGameFileInfo* info = GGameFileHash[hash]; info; info = info->HashNext)
@@ -290,6 +440,10 @@ static bool RegisterGameFile(const char *FullName, FVirtualFileSystem* parentVfs
 		}
 	}
 
+	// grow hash table when needed
+	if (GameFiles.Num() >= GameFileHashSize * GAME_FILE_HASH_LOAD)
+		ResizeGameFileHash(GameFileHashSize ? GameFileHashSize * 2 : GAME_FILE_HASH_SIZE);
+
 	// create entry
 	CGameFileInfo *info = new CGameFileInfo;
 	GameFiles.Add(info);
@@ -358,9 +512,10 @@ static bool RegisterGameFile(const char *FullName, FVirtualFileSystem* parentVfs
 #endif // UNREAL3
 
 	// insert CGameFileInfo into hash table
-	int hash = GetHashForFileName(info->ShortFilename, true);
+	int hash = GetHashForFileName(info->ShortFilename, true) & (GameFileHashSize - 1);
 	info->HashNext = GGameFileHash[hash];
 	GGameFileHash[hash] = info;
+	IndexGameFile(info);
 #if DEBUG_HASH
 	printf("--> add(%s) pkg=%d hash=%X\n", info->ShortFilename, info->IsPackage, hash);
 #endif
@@ -578,7 +733,8 @@ const CGameFileInfo *appFindGameFile(const char *Filename, const char *Ext)
 	}
 
 	// Get hash before stripping extension (could be required for files with double extension, like .hdr.rtc for games with Redux textures)
-	int hash = GetHashForFileName(buf, /* stripExtension = */ Ext == NULL);
+	if (!GameFileHashSize) return NULL;		// no files registered
+	int hash = GetHashForFileName(buf, /* stripExtension = */ Ext == NULL) & (GameFileHashSize - 1);
 #if DEBUG_HASH
 	printf("--> find(%s) hash=%X\n", buf, hash);
 #endif
@@ -684,6 +840,18 @@ static bool FindPackageWildcardCallback(const CGameFileInfo *file, FindPackageWi
 }
 
 
+static void FindPackagesInFolder(const CGameFolder* Folder, FindPackageWildcardData &data)
+{
+	for (const CGameFileInfo* info = Folder->FirstFile; info; info = info->FolderNext)
+	{
+		if (info->IsPackage)
+			FindPackageWildcardCallback(info, data);
+	}
+	for (const CGameFolder* Child = Folder->FirstChild; Child; Child = Child->NextSibling)
+		FindPackagesInFolder(Child, data);
+}
+
+
 //?? TODO: may be pass "Ext" here
 void appFindGameFiles(const char *Filename, TArray<const CGameFileInfo*>& Files)
 {
@@ -720,6 +888,34 @@ void appFindGameFiles(const char *Filename, TArray<const CGameFileInfo*>& Files)
 	FindPackageWildcardData findData;
 	findData.WildcardContainsPath = containsPath;
 	findData.Wildcard = buf;
+
+	// If wildcard begins with a path, iterate only over this directory subtree
+	const char* FixedPart = buf + strcspn(buf, "*?");
+	const char* PathEnd = FixedPart;
+	while (PathEnd > buf && PathEnd[0] != '/') PathEnd--;
+	if (containsPath && PathEnd[0] == '/')
+	{
+		const CGameFolder* Folder = FindGameFolder(buf, PathEnd - buf);
+		if (Folder)
+			FindPackagesInFolder(Folder, findData);
+		CopyArray(Files, findData.FoundFiles);
+		return;
+	}
+	// If wildcard has an extension, iterate only over files with this extension
+	const char* Ext = strrchr(buf, '.');
+	if (Ext && Ext > FixedPart && !strpbrk(Ext, "/*?"))
+	{
+		const CGameFileExtension* E = FindGameFileExtension(Ext + 1);
+		for (const CGameFileInfo* info = E ? E->FirstFile : NULL; info; info = info->ExtNext)
+		{
+			if (info->IsPackage)
+				FindPackageWildcardCallback(info, findData);
+		}
+		CopyArray(Files, findData.FoundFiles);
+		return;
+	}
+
+	// iterate over all packages
 	appEnumGameFiles(FindPackageWildcardCallback, findData);
 
 	CopyArray(Files, findData.FoundFiles);
@@ -773,19 +969,22 @@ FArchive *appCreateFileReader(const CGameFileInfo *info)
 
 void appEnumGameFilesWorker(bool (*Callback)(const CGameFileInfo*, void*), const char *Ext, void *Param)
 {
-	for (int i = 0; i < GameFiles.Num(); i++)
+	if (Ext)
 	{
-		const CGameFileInfo *info = GameFiles[i];
-		if (!Ext)
+		// use extension index
+		const CGameFileExtension* E = FindGameFileExtension(Ext);
+		for (const CGameFileInfo* info = E ? E->FirstFile : NULL; info; info = info->ExtNext)
 		{
-			// enumerate packages
-			if (!info->IsPackage) continue;
-		}
-		else
-		{
-			// check extension
-			if (stricmp(info->Extension, Ext) != 0) continue;
+			if (!Callback(info, Param)) break;
 		}
+		return;
+	}
+
+	// enumerate packages
+	for (int i = 0; i < GameFiles.Num(); i++)
+	{
+		const CGameFileInfo *info = GameFiles[i];
+		if (!info->IsPackage) continue;
 		if (!Callback(info, Param)) break;
 	}
 }
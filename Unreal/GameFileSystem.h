@@ -21,4 +21,75 @@ public:
 };
 
 
+#define VFS_FILE_BUFFER_SIZE	16384
+
+// Base class for reading a file stored inside VFS container. Container data is accessed with
+// FArchive::ReadAt(), so the container reader has no shared position, and files from the same
+// container could be read from different threads. Every file has its own read buffer.
+class FVirtualFileReader : public FArchive
+{
+	DECLARE_ARCHIVE(FVirtualFileReader, FArchive);
+public:
+	FVirtualFileReader(FArchive* InReader)
+	:	Reader(InReader)
+	,	ReadBuffer(NULL)
+	,	ReadBufferPos(0)
+	,	ReadBufferSize(0)
+	{}
+
+	virtual ~FVirtualFileReader()
+	{
+		if (ReadBuffer)
+			appFree(ReadBuffer);
+	}
+
+protected:
+	FArchive*	Reader;
+	byte*		ReadBuffer;
+	int			ReadBufferPos;			// position of ReadBuffer in the file
+	int			ReadBufferSize;
+
+	// Read 'size' bytes from the current position of the file which is stored in container
+	// at DataPos and has DataSize bytes, and advance the position. Caller should release
+	// the memory window before calling this function.
+	void ReadBuffered(int64 DataPos, int DataSize, void *data, int size)
+	{
+		guard(FVirtualFileReader::ReadBuffered);
+		if (ArPos + size > DataSize)
+			appError("Serializing behind end of file (%X+%X > %X)", ArPos, size, DataSize);
+
+		if (size >= VFS_FILE_BUFFER_SIZE)
+		{
+			// large block, read directly
+			Reader->ReadAt(DataPos + ArPos, data, size);
+			ArPos += size;
+			return;
+		}
+
+		while (size > 0)
+		{
+			if (!ReadBuffer || ArPos < ReadBufferPos || ArPos >= ReadBufferPos + ReadBufferSize)
+			{
+				// fill the buffer
+				if (!ReadBuffer)
+					ReadBuffer = (byte*)appMalloc(VFS_FILE_BUFFER_SIZE);
+				ReadBufferPos  = ArPos;
+				ReadBufferSize = min(VFS_FILE_BUFFER_SIZE, DataSize - ArPos);
+				Reader->ReadAt(DataPos + ReadBufferPos, ReadBuffer, ReadBufferSize);
+			}
+			int LocalPos = ArPos - ReadBufferPos;
+			int CanCopy = min(ReadBufferSize - LocalPos, size);
+			memcpy(data, ReadBuffer + LocalPos, CanCopy);
+			data = OffsetPointer(data, CanCopy);
+			size  -= CanCopy;
+			ArPos += CanCopy;
+		}
+		// remaining buffered data could be read without Serialize() call
+		if (ArPos >= ReadBufferPos && ArPos < ReadBufferPos + ReadBufferSize)
+			SetWindow(ReadBuffer + ArPos - ReadBufferPos, ReadBufferPos + ReadBufferSize - ArPos, ArPos);
+		unguard;
+	}
+};
+
+
 #endif // __GAME_FILE_SYSTEM_H__
@@ -5,13 +5,14 @@
 #include "UnPackage.h"
 
 #include "PackageUtils.h"
+#include "TexturePrepare.h"
 
 /*-----------------------------------------------------------------------------
 	Package loader/unloader
 -----------------------------------------------------------------------------*/
 
 TArray<UnPackage*> GFullyLoadedPackages;
-bool LoadWholePackage(UnPackage* Package, IProgressCallback* progress)
+bool LoadWholePackage(UnPackage* Package, IProgressCallback* progress, SkipExportFunc_t skipExport)
 {
 	guard(LoadWholePackage);
 
@@ -27,6 +28,8 @@ bool LoadWholePackage(UnPackage* Package, IProgressCallback* progress)
 		if (!IsKnownClass(Package->GetObjectName(Package->GetExport(idx).ClassIndex)))
 			continue;
 		if (progress && !progress->Tick()) return false;
+		if (skipExport && skipExport(Package, idx))
+			continue;
 		Package->CreateExport(idx);
 	}
 	UObject::EndLoad();
@@ -49,6 +52,9 @@ void ReleaseAllObjects()
 	appPrintf("Memory: allocated " FORMAT_SIZE("d") " bytes in %d blocks\n", GTotalAllocationSize, GTotalAllocationCount);
 	appDumpMemoryAllocations();
 #endif
+	// worker threads could use textures
+	CancelAllTexturePreparations();
+
 	for (int i = UObject::GObjObjects.Num() - 1; i >= 0; i--)
 		delete UObject::GObjObjects[i];
 	UObject::GObjObjects.Empty();
@@ -194,3 +200,254 @@ bool ScanPackages(TArray<FileInfo>& info, IProgressCallback* progress)
 
 	return !data.Cancelled;
 }
+
+
+/*-----------------------------------------------------------------------------
+	Package dependency graph
+
+	Graph is built from package import tables, objects are not loaded. It is
+	stored as a text file, one line per package:
+		<package>\t<imported package 1>\t<imported package 2>...
+	Package names are relative to the game root directory; imported packages
+	which weren't found are stored with their import names.
+-----------------------------------------------------------------------------*/
+
+// Dependency which is used by many packages (Engine, shared texture packages etc) doesn't
+// join its users into a single export group: when more than 1/DEPS_HUB_SHARE of packages
+// and more than DEPS_MIN_HUB_USERS packages import it.
+#define DEPS_HUB_SHARE			4
+#define DEPS_MIN_HUB_USERS		8
+
+int CPackageDeps::FindNode(const char *Name) const
+{
+	if (!Nodes.Num()) return INDEX_NONE;
+	for (int i = Hash[appStrHashNoCase(Name) & (DEPS_HASH_SIZE - 1)]; i >= 0; i = Nodes[i].HashNext)
+	{
+		if (!stricmp(*Nodes[i].Name, Name)) return i;
+	}
+	return INDEX_NONE;
+}
+
+int CPackageDeps::AddNode(const char *Name)
+{
+	int Index = FindNode(Name);
+	if (Index >= 0) return Index;
+	if (!Nodes.Num())
+	{
+		// we're adding first item here, initialize hash with -1
+		memset(Hash, -1, sizeof(Hash));
+	}
+	int h = appStrHashNoCase(Name) & (DEPS_HASH_SIZE - 1);
+	Index = Nodes.AddZeroed();
+	CPackageDepsNode &N = Nodes[Index];
+	N.Name     = Name;
+	N.HashNext = Hash[h];
+	Hash[h] = Index;
+	return Index;
+}
+
+void CPackageDeps::AddPackage(UnPackage *Package)
+{
+	guard(CPackageDeps::AddPackage);
+
+	int Node = AddNode(Package->Filename);
+	Nodes[Node].Imports.Empty();			// replace information loaded from file
+	Nodes[Node].HasImports = true;
+
+	for (int i = 0; i < Package->Summary.ImportCount; i++)
+	{
+		const FObjectImport &Imp = Package->GetImport(i);
+		// packages and classes are not loaded by CreateImport()
+		if (Imp.PackageIndex == 0 || Imp.ClassName == "Class") continue;
+		const char *PackageName = Package->GetObjectPackageName(Imp.PackageIndex);
+		if (!PackageName) continue;
+		const CGameFileInfo *info = appFindGameFile(PackageName);
+		int Dep = AddNode((info && info->IsPackage) ? info->RelativeName : PackageName);
+		if (Dep != Node) Nodes[Node].Imports.AddUnique(Dep);
+	}
+
+	unguardf("%s", Package->Filename);
+}
+
+bool CPackageDeps::Save(const char *Filename) const
+{
+	guard(CPackageDeps::Save);
+
+	appMakeDirectoryForFile(Filename);
+	FILE *f = fopen(Filename, "w");
+	if (!f)
+	{
+		appPrintf("Unable to create file \"%s\"\n", Filename);
+		return false;
+	}
+	fprintf(f, "# umodel package dependencies\n");
+	for (int i = 0; i < Nodes.Num(); i++)
+	{
+		const CPackageDepsNode &N = Nodes[i];
+		if (!N.HasImports) continue;
+		fprintf(f, "%s", *N.Name);
+		for (int j = 0; j < N.Imports.Num(); j++)
+			fprintf(f, "\t%s", *Nodes[N.Imports[j]].Name);
+		fprintf(f, "\n");
+	}
+	fclose(f);
+	return true;
+
+	unguardf("%s", Filename);
+}
+
+bool CPackageDeps::Load(const char *Filename)
+{
+	guard(CPackageDeps::Load);
+
+	FILE *f = fopen(Filename, "rb");
+	if (!f) return false;
+	fseek(f, 0, SEEK_END);
+	int Size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	char *Text = (char*)appMalloc(Size + 1);
+	int Read = fread(Text, 1, Size, f);
+	Text[Read] = 0;
+	fclose(f);
+
+	char *Line = Text;
+	while (true)
+	{
+		char *End = strchr(Line, '\n');
+		if (!End) break;
+		*End = 0;
+		if (End > Line && End[-1] == '\r') End[-1] = 0;
+
+		if (Line[0] && Line[0] != '#')
+		{
+			char *s = strchr(Line, '\t');
+			if (s) *s++ = 0;
+			int Node = AddNode(Line);
+			Nodes[Node].HasImports = true;
+			while (s)
+			{
+				char *Dep = s;
+				s = strchr(s, '\t');
+				if (s) *s++ = 0;
+				if (Dep[0]) Nodes[Node].Imports.AddUnique(AddNode(Dep));
+			}
+		}
+
+		Line = End + 1;
+	}
+
+	appFree(Text);
+	return true;
+
+	unguardf("%s", Filename);
+}
+
+void CPackageDeps::Empty()
+{
+	Nodes.Empty();
+}
+
+
+static int FindGroupRoot(TArray<int> &Parent, int Node)
+{
+	while (Parent[Node] != Node)
+	{
+		Parent[Node] = Parent[Parent[Node]];	// path halving
+		Node = Parent[Node];
+	}
+	return Node;
+}
+
+// Add Node to Result after all its dependencies which are in the same group
+static void AddScheduledNode(const CPackageDeps &Deps, TArray<int> &State, TArray<int> &Result, int Node, int Group)
+{
+	if (State[Node] != Group) return;		// not scheduled, from another group, or already processed
+	State[Node] = -2;						// mark as processed; this also breaks dependency loops
+	const TArray<int> &Imports = Deps.Nodes[Node].Imports;
+	for (int i = 0; i < Imports.Num(); i++)
+		AddScheduledNode(Deps, State, Result, Imports[i], Group);
+	Result.Add(Node);
+}
+
+void CPackageDeps::Schedule(TArray<UnPackage*> &Packages, TArray<int> &GroupSizes) const
+{
+	guard(CPackageDeps::Schedule);
+
+	GroupSizes.Empty();
+	int NumNodes = Nodes.Num();
+	if (!Packages.Num()) return;
+
+	// count users of every package
+	TArray<int> Users;
+	Users.AddZeroed(NumNodes);
+	int NumImporters = 0;
+	for (int i = 0; i < NumNodes; i++)
+	{
+		const CPackageDepsNode &N = Nodes[i];
+		if (N.HasImports) NumImporters++;
+		for (int j = 0; j < N.Imports.Num(); j++)
+			Users[N.Imports[j]]++;
+	}
+
+	// join packages and their dependencies into groups, ignoring widely used dependencies
+	TArray<int> Parent;
+	Parent.AddUninitialized(NumNodes);
+	for (int i = 0; i < NumNodes; i++)
+		Parent[i] = i;
+	for (int i = 0; i < NumNodes; i++)
+	{
+		int u = Users[i];
+		if (u > DEPS_MIN_HUB_USERS && u * DEPS_HUB_SHARE > NumImporters) continue;
+		const TArray<int> &Imports = Nodes[i].Imports;
+		for (int j = 0; j < Imports.Num(); j++)
+		{
+			int Dep = Imports[j];
+			u = Users[Dep];
+			if (u > DEPS_MIN_HUB_USERS && u * DEPS_HUB_SHARE > NumImporters) continue;
+			int r1 = FindGroupRoot(Parent, i);
+			int r2 = FindGroupRoot(Parent, Dep);
+			if (r1 != r2) Parent[r2] = r1;
+		}
+	}
+
+	// assign group indices in order of packages, State[node] = group of scheduled package
+	TArray<int> State, GroupOfRoot, PackageNodes;
+	State.AddUninitialized(NumNodes);
+	GroupOfRoot.AddUninitialized(NumNodes);
+	for (int i = 0; i < NumNodes; i++)
+		State[i] = GroupOfRoot[i] = INDEX_NONE;
+	PackageNodes.AddUninitialized(Packages.Num());
+	int NumGroups = 0;
+	for (int i = 0; i < Packages.Num(); i++)
+	{
+		int Node = FindNode(Packages[i]->Filename);
+		assert(Node >= 0);
+		PackageNodes[i] = Node;
+		int Root = FindGroupRoot(Parent, Node);
+		if (GroupOfRoot[Root] < 0) GroupOfRoot[Root] = NumGroups++;
+		State[Node] = GroupOfRoot[Root];
+	}
+
+	// place groups one after another, with dependencies first
+	TArray<int> Result;
+	Result.Empty(Packages.Num());
+	GroupSizes.AddZeroed(NumGroups);
+	for (int Group = 0; Group < NumGroups; Group++)
+	{
+		int First = Result.Num();
+		for (int i = 0; i < Packages.Num(); i++)
+			AddScheduledNode(*this, State, Result, PackageNodes[i], Group);
+		GroupSizes[Group] = Result.Num() - First;
+	}
+	assert(Result.Num() == Packages.Num());
+
+	// reorder packages
+	TArray<UnPackage*> NodePackages;
+	NodePackages.AddZeroed(NumNodes);
+	for (int i = 0; i < Packages.Num(); i++)
+		NodePackages[PackageNodes[i]] = Packages[i];
+	for (int i = 0; i < Result.Num(); i++)
+		Packages[i] = NodePackages[Result[i]];
+
+	unguard;
+}
@@ -21,7 +21,10 @@ public:
 };
 
 
-bool LoadWholePackage(UnPackage* Package, IProgressCallback* progress = NULL);
+// Optional filter for LoadWholePackage(): returns true when the export shouldn't be loaded.
+typedef bool (*SkipExportFunc_t)(UnPackage* Package, int ExportIndex);
+
+bool LoadWholePackage(UnPackage* Package, IProgressCallback* progress = NULL, SkipExportFunc_t skipExport = NULL);
 void ReleaseAllObjects();
 
 
@@ -38,4 +41,44 @@ struct FileInfo
 bool ScanPackages(TArray<FileInfo>& info, IProgressCallback* progress = NULL);
 
 
+// Package dependency graph
+
+#define PACKAGE_DEPS_FILENAME	"umodel_deps.txt"
+#define DEPS_HASH_SIZE			4096
+
+struct CPackageDepsNode
+{
+	FString		Name;				// package name relative to the game root, or import name of missing package
+	TArray<int>	Imports;			// nodes of packages which this package imports objects from
+	bool		HasImports;			// information about imports is available
+	int			HashNext;
+};
+
+class CPackageDeps
+{
+public:
+	TArray<CPackageDepsNode> Nodes;
+
+	int FindNode(const char *Name) const;
+	int AddNode(const char *Name);
+	// Add package and its imports using tables of the loaded package.
+	void AddPackage(UnPackage *Package);
+
+	bool Save(const char *Filename) const;
+	// Load graph saved with Save(). Returns false when the file doesn't exist.
+	bool Load(const char *Filename);
+	void Empty();
+
+	// Reorder packages for batch export. Packages which import objects from each other or from
+	// the same packages are placed into one group; groups don't share dependencies except
+	// widely used ones, so objects could be released after exporting each group, and groups
+	// could be loaded independently. Dependencies are placed before packages which use them.
+	// All packages should be added to the graph. Returns number of packages in every group.
+	void Schedule(TArray<UnPackage*> &Packages, TArray<int> &GroupSizes) const;
+
+protected:
+	int			Hash[DEPS_HASH_SIZE];
+};
+
+
 #endif // __PACKAGE_UTILS_H__
@@ -2,89 +2,172 @@
 #include "UnCore.h"
 #include "UnObject.h"		// for typeinfo
 #include "SkeletalMesh.h"
+#include "Parallel.h"
 
 
 /*-----------------------------------------------------------------------------
 	CSkeletalMesh
 -----------------------------------------------------------------------------*/
 
-struct CBoneProxy
+void CSkelMeshHierarchy::Build(const TArray<CSkelMeshBone> &Skeleton)
 {
-	CBoneProxy		*Parent;
-	CSkelMeshBone	*Bone;
+	guard(CSkelMeshHierarchy::Build);
 
-/*	bool IsChildOf(const CBoneProxy *Other) const
-	{
-		if (Other == this) return false;
+	int NumBones = Skeleton.Num();
+	int i;
+
+	Bones.Empty(NumBones);
+	Bones.AddZeroed(NumBones);
+	Children.Empty(NumBones);
+	Children.AddZeroed(NumBones);
+	memset(Hash, -1, sizeof(Hash));
 
-		int i = 0;
-		for (const CBoneProxy *Bone = Parent; Bone; Bone = Bone->Parent)
+	// count children, compute depth and name hash
+	for (i = 0; i < NumBones; i++)
+	{
+		CSkelMeshBoneInfo &Info = Bones[i];
+		if (i > 0)
 		{
-			if (Bone == Other) return true;
-			if (++i >= MAX_MESHBONES) appError("Loop in skeleton");
+			int Parent = Skeleton[i].ParentIndex;
+			assert(Parent < i);
+			Bones[Parent].NumChildren++;
+			Info.Depth = Bones[Parent].Depth + 1;
 		}
-		return false;
-	} */
-};
+		int h = appStrHashNoCase(Skeleton[i].Name) & (BONE_HASH_SIZE - 1);
+		Info.HashNext = Hash[h];
+		Hash[h] = i;
+	}
 
+	// allocate child lists
+	int Offset = 0;
+	for (i = 0; i < NumBones; i++)
+	{
+		Bones[i].FirstChild = Offset;
+		Offset += Bones[i].NumChildren;
+		Bones[i].NumChildren = 0;
+	}
+	// fill child lists; compute subtree sizes in reverse order, so children are processed before parents
+	for (i = NumBones - 1; i > 0; i--)
+	{
+		CSkelMeshBoneInfo &Parent = Bones[Skeleton[i].ParentIndex];
+		Parent.SubtreeSize += Bones[i].SubtreeSize + 1;
+		Parent.NumChildren++;
+		// children are filled from the end, so resulting lists are in index order
+		Children[Parent.FirstChild + Parent.NumChildren - 1] = i;
+	}
+	for (i = 0; i < NumBones; i++)
+	{
+		// reverse child list
+		int *C = Children.GetData() + Bones[i].FirstChild;
+		for (int a = 0, b = Bones[i].NumChildren - 1; a < b; a++, b--)
+			Exchange(C[a], C[b]);
+	}
 
-static CBoneProxy Bones[MAX_MESHBONES];		//!! rename or pass to SortBones()
-static CBoneProxy *SortedBones[MAX_MESHBONES];
-static int NumSortedBones;
+	unguard;
+}
 
-static void SortBoneArray(CBoneProxy *Parent, int NumBones)
+
+int CSkelMeshHierarchy::FindBone(const TArray<CSkelMeshBone> &Skeleton, const char *Name) const
 {
-	for (int i = 0; i < NumBones; i++)
+	if (!Bones.Num()) return INDEX_NONE;
+	for (int i = Hash[appStrHashNoCase(Name) & (BONE_HASH_SIZE - 1)]; i >= 0; i = Bones[i].HashNext)
 	{
-		CBoneProxy *Bone = &Bones[i];
-		if (Bone->Parent == Parent)
-		{
-			if (NumSortedBones >= NumBones) appError("Loop in skeleton");
-			SortedBones[NumSortedBones++] = Bone;
-			SortBoneArray(Bone, NumBones);
-		}
+		if (!stricmp(Skeleton[i].Name, Name))
+			return i;
 	}
+	return INDEX_NONE;
 }
 
 
 void CSkeletalMesh::SortBones()
 {
+	guard(CSkeletalMesh::SortBones);
+
 	int NumBones = RefSkeleton.Num();
 	int i;
 
-	// prepare CBoneProxy array
+	if (!NumBones)
+	{
+		Hierarchy.Build(RefSkeleton);
+		return;
+	}
+
+	// build child lists for the original bone order
+	TArray<int> Parents, FirstChild, NextSibling;
+	Parents.AddZeroed(NumBones);
+	FirstChild.AddZeroed(NumBones);
+	NextSibling.AddZeroed(NumBones);
 	for (i = 0; i < NumBones; i++)
 	{
-		Bones[i].Bone   = &RefSkeleton[i];
-		Bones[i].Parent = (i > 0) ? &Bones[RefSkeleton[i].ParentIndex] : NULL;
-		SortedBones[i]  = &Bones[i];
+		int Parent = (i > 0) ? RefSkeleton[i].ParentIndex : INDEX_NONE;
+		if (Parent == i || Parent >= NumBones || (i > 0 && Parent < 0))
+		{
+			appPrintf("WARNING: bone %d (%s) has bad parent %d, attaching to root\n", i, *RefSkeleton[i].Name, Parent);
+			Parent = 0;
+		}
+		Parents[i]     = Parent;
+		FirstChild[i]  = INDEX_NONE;
+		NextSibling[i] = INDEX_NONE;
+	}
+	// link children in reverse order, so lists will be in index order
+	for (i = NumBones - 1; i > 0; i--)
+	{
+		int Parent = Parents[i];
+		NextSibling[i] = FirstChild[Parent];
+		FirstChild[Parent] = i;
 	}
 
-	// sort bones
-	NumSortedBones = 1;
-	SortedBones[0] = &Bones[0];
-	SortBoneArray(&Bones[0], NumBones);
+	// sort bones: depth-first traversal, children in original order
+	TArray<int> RemapBack, Stack;
+	TArray<bool> Visited;
+	RemapBack.Empty(NumBones);
+	Stack.Empty(64);
+	Visited.AddZeroed(NumBones);
+	int Start = 0;
+	while (true)
+	{
+		Stack.Add(Start);
+		while (Stack.Num())
+		{
+			int Bone = Stack[Stack.Num() - 1];
+			Stack.RemoveAt(Stack.Num() - 1);
+			Visited[Bone] = true;
+			RemapBack.Add(Bone);
+			// push children in reverse order, so the first child is popped first
+			int NumPushed = 0;
+			for (int Child = FirstChild[Bone]; Child >= 0; Child = NextSibling[Child])
+			{
+				if (Visited[Child]) continue;		// could happen when skeleton has a loop
+				Stack.Add(Child);
+				NumPushed++;
+			}
+			for (int a = Stack.Num() - NumPushed, b = Stack.Num() - 1; a < b; a++, b--)
+				Exchange(Stack[a], Stack[b]);
+		}
+		if (RemapBack.Num() == NumBones) break;
+		// there're bones which are not reachable from root: loop in skeleton; break the
+		// loop by attaching the first such bone to root
+		for (Start = 1; Start < NumBones; Start++)
+			if (!Visited[Start]) break;
+		appPrintf("WARNING: loop in skeleton, attaching bone %d (%s) to root\n", Start, *RefSkeleton[Start].Name);
+		Parents[Start] = 0;
+	}
 
 	// build remap table
-	int Remap[MAX_MESHBONES];
-	int RemapBack[MAX_MESHBONES];
+	TArray<int> Remap;
+	Remap.AddZeroed(NumBones);
 	for (i = 0; i < NumBones; i++)
-	{
-		const CBoneProxy *P = SortedBones[i];
-		int OldIndex = P - Bones;
-		Remap[OldIndex] = i;
-		RemapBack[i] = OldIndex;
-//		appPrintf("%s[%d] -> [%d] %s <- %s\n", (i != OldIndex) ? "*" : "", i, OldIndex, *P->Bone->Name, P->Parent ? *P->Parent->Bone->Name : "None");
-	}
+		Remap[RemapBack[i]] = i;
 
 	// build new RefSkeleton
 	TArray<CSkelMeshBone> NewSkeleton;
 	NewSkeleton.Empty(NumBones);
 	for (i = 0; i < NumBones; i++)
 	{
+		int OldIndex = RemapBack[i];
 		CSkelMeshBone *Bone = new (NewSkeleton) CSkelMeshBone;
-		*Bone = RefSkeleton[RemapBack[i]];
-		int oldParent = Bone->ParentIndex;
+		*Bone = RefSkeleton[OldIndex];
+		int oldParent = Parents[OldIndex];
 		Bone->ParentIndex = (oldParent > 0) ? Remap[oldParent] : 0;
 	}
 	CopyArray(RefSkeleton, NewSkeleton);
@@ -104,17 +187,10 @@ void CSkeletalMesh::SortBones()
 			}
 		}
 	}
-}
 
+	Hierarchy.Build(RefSkeleton);
 
-int CSkeletalMesh::FindBone(const char *Name) const
-{
-	for (int i = 0; i < RefSkeleton.Num(); i++)
-	{
-		if (!stricmp(RefSkeleton[i].Name, Name))
-			return i;
-	}
-	return -1;
+	unguard;
 }
 
 
@@ -422,3 +498,50 @@ void CAnimTrack::CopyFrom(const CAnimTrack &Src)
 	CopyArray(KeyQuatTime, Src.KeyQuatTime);
 	CopyArray(KeyPosTime,  Src.KeyPosTime );
 }
+
+
+/*-----------------------------------------------------------------------------
+	CAnimSet
+-----------------------------------------------------------------------------*/
+
+struct CBakeKeysContext
+{
+	const CAnimSet	*Anim;
+	const int		*SeqIndices;
+	CAnimBoneKey	*const *SeqKeys;
+	int				KeyStride;
+};
+
+static void BakeSequenceKeysWorker(int Index, void *Param)
+{
+	const CBakeKeysContext &Ctx = *(CBakeKeysContext*)Param;
+	const CAnimSequence &S = *Ctx.Anim->Sequences[Ctx.SeqIndices[Index]];
+	int NumBones = Ctx.Anim->TrackBoneNames.Num();
+
+	// every sequence writes to its own destination
+	byte *Dst = (byte*)Ctx.SeqKeys[Index];
+	for (int t = 0; t < S.NumFrames; t++)
+	{
+		for (int b = 0; b < NumBones; b++, Dst += Ctx.KeyStride)
+		{
+			CAnimBoneKey *K = (CAnimBoneKey*)Dst;
+			K->Position.Set(0, 0, 0);		// GetBonePosition() will not alter these values when track has no keys
+			K->Orientation.Set(0, 0, 0, 1);
+			S.Tracks[b].GetBonePosition(t, S.NumFrames, false, K->Position, K->Orientation);
+		}
+	}
+}
+
+void CAnimSet::BakeKeys(int NumSeqs, const int *SeqIndices, CAnimBoneKey *const *SeqKeys, int KeyStride) const
+{
+	guard(CAnimSet::BakeKeys);
+
+	CBakeKeysContext Ctx;
+	Ctx.Anim       = this;
+	Ctx.SeqIndices = SeqIndices;
+	Ctx.SeqKeys    = SeqKeys;
+	Ctx.KeyStride  = KeyStride;
+	appParallelFor(NumSeqs, BakeSequenceKeysWorker, &Ctx);
+
+	unguard;
+}
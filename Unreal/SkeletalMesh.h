@@ -26,7 +26,6 @@ TODO:
 */
 
 
-#define MAX_MESHBONES				2048
 #define NUM_INFLUENCES				4
 //#define ANIM_DEBUG_INFO				1
 
@@ -59,6 +58,48 @@ struct CSkelMeshBone
 };
 
 
+#define BONE_HASH_SIZE				256
+
+// Information about bone placement in hierarchy. Bones are sorted by CSkeletalMesh::SortBones()
+// in depth-first order: parent bone goes before its children, and each child is followed by its
+// own children. So the subtree of bone N occupies [N, N + SubtreeSize] range of indices, and
+// iterating bones in index order is a valid topological order.
+struct CSkelMeshBoneInfo
+{
+	int						FirstChild;				// index of the first child in CSkelMeshHierarchy::Children
+	int						NumChildren;			// count of direct children
+	int						SubtreeSize;			// count of all children bones (0 for leaf bone)
+	int						Depth;					// 0 for root bone
+	int						HashNext;				// next bone with the same name hash
+};
+
+// Bone hierarchy, built once per mesh and not modified after that, so it could be used from
+// any thread.
+class CSkelMeshHierarchy
+{
+public:
+	TArray<CSkelMeshBoneInfo> Bones;
+	TArray<int>				Children;				// indices of child bones, grouped by parent
+
+	CSkelMeshHierarchy()
+	{
+		memset(Hash, -1, sizeof(Hash));
+	}
+
+	// Skeleton should be sorted
+	void Build(const TArray<CSkelMeshBone> &Skeleton);
+	int FindBone(const TArray<CSkelMeshBone> &Skeleton, const char *Name) const;
+
+	FORCEINLINE const int* GetChildren(int Bone) const
+	{
+		return Children.GetData() + Bones[Bone].FirstChild;
+	}
+
+protected:
+	int						Hash[BONE_HASH_SIZE];
+};
+
+
 struct CSkelMeshLod : public CBaseMeshLod
 {
 	CSkelMeshVertex			*Verts;
@@ -124,6 +165,7 @@ public:
 	TArray<CSkelMeshBone>	RefSkeleton;
 	TArray<CSkelMeshLod>	Lods;
 	TArray<CSkelMeshSocket>	Sockets;
+	CSkelMeshHierarchy		Hierarchy;				// built by SortBones()
 
 	CSkeletalMesh(UObject *Original)
 	:	OriginalMesh(Original)
@@ -145,8 +187,13 @@ public:
 	}
 #endif
 
+	// Sort bones in hierarchy order and rebuild Hierarchy. Should be called after any change
+	// of RefSkeleton.
 	void SortBones();
-	int FindBone(const char *Name) const;
+	int FindBone(const char *Name) const
+	{
+		return Hierarchy.FindBone(RefSkeleton, Name);
+	}
 	int GetRootBone() const;
 
 #if DECLARE_VIEWER_PROPS
@@ -213,6 +260,14 @@ struct CAnimTrack
 };
 
 
+// Bone transform sampled at some animation frame
+struct CAnimBoneKey
+{
+	CVec3					Position;
+	CQuat					Orientation;
+};
+
+
 class CAnimSequence
 {
 public:
@@ -276,6 +331,13 @@ public:
 			return true;
 		return false;
 	}
+
+	// Sample every track of the selected sequences at every frame. Keys of the sequence
+	// SeqIndices[i] are written to SeqKeys[i] frame by frame, then bone by bone, KeyStride
+	// bytes apart, so they could be placed directly into structures which start with
+	// CAnimBoneKey fields. Sequences are sampled in parallel. Tracks without keys produce
+	// identity transform.
+	void BakeKeys(int NumSeqs, const int *SeqIndices, CAnimBoneKey *const *SeqKeys, int KeyStride) const;
 };
 
 
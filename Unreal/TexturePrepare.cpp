@@ -0,0 +1,691 @@
+#include "Core.h"
+#include "UnCore.h"
+#include "UnObject.h"
+#include "UnMaterial.h"
+
+#include "Parallel.h"
+#include "TexturePrepare.h"
+
+#define MAX_IMG_SIZE			4096			// maximal texture dimension used for rendering
+#define MAX_PREPARE_THREADS		4
+
+#define USE_SSE					1
+
+#if USE_SSE
+#include <emmintrin.h>			// SSE2
+#endif
+
+
+// Add RGBA8 mipmap, TexData takes ownership of the data
+static void AddMip(CTextureData &TexData, byte *Data, int USize, int VSize)
+{
+	CMipMap *Mip = new (TexData.Mips) CMipMap;
+	Mip->CompressedData = Data;
+	Mip->DataSize       = USize * VSize * 4;
+	Mip->USize          = USize;
+	Mip->VSize          = VSize;
+	Mip->ShouldFreeData = true;
+}
+
+/*-----------------------------------------------------------------------------
+	Mipmapping and resampling
+
+	Images are processed in tiles of rows, large images are processed by
+	several threads. Kernels process all 4 channels of a pixel at once with
+	SSE2 16-bit arithmetic.
+-----------------------------------------------------------------------------*/
+
+#define RESAMPLE_TILE_ROWS		64				// number of destination rows processed in a single job
+#define MIN_THREADED_PIXELS		(256*256)		// smaller images are processed in the calling thread
+
+#if USE_SSE
+// Scale factors for division of a sum of 'n' pixels: (Sum * 4 * Scale[n]) >> 16 == Sum / n
+// for Sum <= 4*255. Division by 3 uses rounded up reciprocal, which is exact in this range.
+static const int16 ResampleScale[5] = { 0, 16384, 8192, 5462, 4096 };
+// Number of bits in 4-bit value
+static const byte BitCount4[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+#endif
+
+struct CResampleContext
+{
+	const byte	*Src;
+	int			SrcWidth;
+	byte		*Dst;
+	int			DstWidth;
+	int			DstHeight;
+	const int	*Col1, *Col2;					// source byte offsets for each destination column
+	const int	*Row1, *Row2;					// source rows for each destination row
+};
+
+static void ResampleWorker(int Tile, void *Param)
+{
+	const CResampleContext &Ctx = *(CResampleContext*)Param;
+
+	int y0 = Tile * RESAMPLE_TILE_ROWS;
+	int y1 = min(y0 + RESAMPLE_TILE_ROWS, Ctx.DstHeight);
+	int outwidth = Ctx.DstWidth;
+	const int *p1 = Ctx.Col1;
+	const int *p2 = Ctx.Col2;
+
+	for (int i = y0; i < y1; i++)
+	{
+		const byte *inrow  = Ctx.Src + Ctx.Row1[i] * Ctx.SrcWidth * 4;
+		const byte *inrow2 = Ctx.Src + Ctx.Row2[i] * Ctx.SrcWidth * 4;
+		unsigned *out = (unsigned*)(Ctx.Dst + i * outwidth * 4);
+		for (int j = 0; j < outwidth; j++)
+		{
+#if USE_SSE
+			// average samples with non-zero alpha
+			const __m128i Zero = _mm_setzero_si128();
+			__m128i v = _mm_set_epi32(*(const int*)(inrow2 + p2[j]), *(const int*)(inrow2 + p1[j]),
+				*(const int*)(inrow + p2[j]), *(const int*)(inrow + p1[j]));
+			__m128i NoAlpha = _mm_cmpeq_epi32(_mm_srli_epi32(v, 24), Zero);
+			int n = 4 - BitCount4[_mm_movemask_ps(_mm_castsi128_ps(NoAlpha))];
+			v = _mm_andnot_si128(NoAlpha, v);
+			__m128i Sum = _mm_add_epi16(_mm_unpacklo_epi8(v, Zero), _mm_unpackhi_epi8(v, Zero));
+			Sum = _mm_add_epi16(Sum, _mm_srli_si128(Sum, 8));
+			Sum = _mm_mulhi_epu16(_mm_slli_epi16(Sum, 2), _mm_set1_epi16(ResampleScale[n]));
+			out[j] = _mm_cvtsi128_si32(_mm_packus_epi16(Sum, Sum));
+#else
+			int		n, r, g, b, a;
+			const byte *pix;
+
+			n = r = g = b = a = 0;
+#define PROCESS_PIXEL(row,col)	\
+	pix = row + col[j];		\
+	if (pix[3])	\
+	{			\
+		n++;	\
+		r += *pix++; g += *pix++; b += *pix++; a += *pix;	\
+	}
+			PROCESS_PIXEL(inrow,  p1);
+			PROCESS_PIXEL(inrow,  p2);
+			PROCESS_PIXEL(inrow2, p1);
+			PROCESS_PIXEL(inrow2, p2);
+#undef PROCESS_PIXEL
+
+			switch (n)		// NOTE: generic version ("x /= n") is 50% slower
+			{
+			// case 1 - divide by 1 - do nothing
+			case 2: r >>= 1; g >>= 1; b >>= 1; a >>= 1; break;
+			case 3: r /= 3;  g /= 3;  b /= 3;  a /= 3;  break;
+			case 4: r >>= 2; g >>= 2; b >>= 2; a >>= 2; break;
+			case 0: r = g = b = 0; break;
+			}
+
+			((byte *)(out+j))[0] = r;
+			((byte *)(out+j))[1] = g;
+			((byte *)(out+j))[2] = b;
+			((byte *)(out+j))[3] = a;
+#endif // USE_SSE
+		}
+	}
+}
+
+void ResampleImage(const byte *Src, int SrcWidth, int SrcHeight, byte *Dst, int DstWidth, int DstHeight)
+{
+	guard(ResampleImage);
+
+	int i;
+	int *Offsets = new int [DstWidth * 2 + DstHeight * 2];
+	int *p1 = Offsets;
+	int *p2 = p1 + DstWidth;
+	int *r1 = p2 + DstWidth;
+	int *r2 = r1 + DstHeight;
+
+	// each destination pixel is an average of 4 source pixels: columns are taken at 1/4 and
+	// 3/4 of the source span, in 16.16 fixed point
+	uint64 fracstep = ((uint64)SrcWidth << 16) / DstWidth;
+	uint64 frac = fracstep >> 2;
+	for (i = 0; i < DstWidth; i++)
+	{
+		p1[i] = 4 * int(frac >> 16);
+		frac += fracstep;
+	}
+	frac = 3 * (fracstep >> 2);
+	for (i = 0; i < DstWidth; i++)
+	{
+		p2[i] = 4 * int(frac >> 16);
+		frac += fracstep;
+	}
+
+	float f, f1, f2;
+	f = (float)SrcHeight / DstHeight;
+	for (i = 0, f1 = 0.25f * f, f2 = 0.75f * f; i < DstHeight; i++, f1 += f, f2 += f)
+	{
+		r1[i] = appFloor(f1);
+		r2[i] = appFloor(f2);
+	}
+
+	CResampleContext Ctx;
+	Ctx.Src       = Src;
+	Ctx.SrcWidth  = SrcWidth;
+	Ctx.Dst       = Dst;
+	Ctx.DstWidth  = DstWidth;
+	Ctx.DstHeight = DstHeight;
+	Ctx.Col1      = p1;
+	Ctx.Col2      = p2;
+	Ctx.Row1      = r1;
+	Ctx.Row2      = r2;
+
+	int NumTiles = (DstHeight + RESAMPLE_TILE_ROWS - 1) / RESAMPLE_TILE_ROWS;
+	if (DstWidth * DstHeight >= MIN_THREADED_PIXELS && NumTiles > 1)
+	{
+		appParallelFor(NumTiles, ResampleWorker, &Ctx);
+	}
+	else
+	{
+		for (i = 0; i < NumTiles; i++)
+			ResampleWorker(i, &Ctx);
+	}
+
+	delete[] Offsets;
+
+	unguard;
+}
+
+
+struct CMipMapContext
+{
+	const byte	*Src;
+	int			SrcWidth;
+	int			SrcHeight;
+	byte		*Dst;
+	int			DstWidth;
+	int			DstHeight;
+};
+
+static void MipMapWorker(int Tile, void *Param)
+{
+	const CMipMapContext &Ctx = *(CMipMapContext*)Param;
+
+	int y0 = Tile * RESAMPLE_TILE_ROWS;
+	int y1 = min(y0 + RESAMPLE_TILE_ROWS, Ctx.DstHeight);
+	int width = Ctx.DstWidth;
+	// when one of dimensions is 1, the same source row or column is used twice
+	int dx = (Ctx.SrcWidth  > 1) ? 4 : 0;
+	int dy = (Ctx.SrcHeight > 1) ? Ctx.SrcWidth * 4 : 0;
+	int sx = (Ctx.SrcWidth  > 1) ? 8 : 4;
+
+	for (int i = y0; i < y1; i++)
+	{
+		const byte *in = Ctx.Src + i * ((Ctx.SrcHeight > 1) ? 2 : 1) * Ctx.SrcWidth * 4;
+		byte *out = Ctx.Dst + i * width * 4;
+		int j = 0;
+#if USE_SSE
+		if (dx && dy)
+		{
+			// 2 destination pixels per iteration
+			const __m128i Zero      = _mm_setzero_si128();
+			const __m128i AlphaMask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+			for ( ; j + 2 <= width; j += 2, in += 16, out += 8)
+			{
+				__m128i r0 = _mm_loadu_si128((const __m128i*)in);
+				__m128i r1 = _mm_loadu_si128((const __m128i*)(in + dy));
+				// sum of 2x2 blocks
+				__m128i a = _mm_add_epi16(_mm_unpacklo_epi8(r0, Zero), _mm_unpacklo_epi8(r1, Zero));
+				__m128i b = _mm_add_epi16(_mm_unpackhi_epi8(r0, Zero), _mm_unpackhi_epi8(r1, Zero));
+				a = _mm_add_epi16(a, _mm_srli_si128(a, 8));
+				b = _mm_add_epi16(b, _mm_srli_si128(b, 8));
+				__m128i Avg = _mm_srli_epi16(_mm_unpacklo_epi64(a, b), 2);
+				// maximal value of 2x2 blocks
+				__m128i m = _mm_max_epu8(r0, r1);
+				m = _mm_max_epu8(m, _mm_srli_epi64(m, 32));
+				__m128i Max = _mm_unpacklo_epi64(_mm_unpacklo_epi8(m, Zero), _mm_unpackhi_epi8(m, Zero));
+				// alpha = (max + avg) / 2
+				__m128i Alpha = _mm_srli_epi16(_mm_add_epi16(Max, Avg), 1);
+				__m128i Res = _mm_or_si128(_mm_andnot_si128(AlphaMask, Avg), _mm_and_si128(AlphaMask, Alpha));
+				_mm_storel_epi64((__m128i*)out, _mm_packus_epi16(Res, Res));
+			}
+		}
+#endif // USE_SSE
+		for ( ; j < width; j++, in += sx, out += 4)
+		{
+			int r, g, b, a, am;
+			r = g = b = a = am = 0;
+//!! should perform removing of alpha-channel when IMAGE_NOALPHA specified
+//!! should perform removing (making black) color channel when alpha==0 (NOT ALWAYS?)
+//!!  - should analyze shader, and it will not use blending with alpha (or no blending at all)
+//!!    then remove alpha channel (require to process shader's *map commands after all other commands, this
+//!!    can be done with delaying [map|animmap|clampmap|animclampmap] lines and executing after all)
+#define PROCESS_PIXEL(idx)	\
+	{	\
+		r += in[idx]; g += in[idx+1]; b += in[idx+2]; a += in[idx+3];	\
+		am = max(am, in[idx+3]);	\
+	}
+			PROCESS_PIXEL(0);
+			PROCESS_PIXEL(dx);
+			PROCESS_PIXEL(dy);
+			PROCESS_PIXEL(dy+dx);
+#undef PROCESS_PIXEL
+			out[0] = r >> 2; out[1] = g >> 2; out[2] = b >> 2;
+			// generate alpha-channel for mipmaps (don't let it be transparent)
+			// dest alpha = (MAX(a[0]..a[3]) + AVG(a[0]..a[3])) / 2
+			// if alpha = 255 or 0 (for all 4 points) -- it will holds its value
+			out[3] = (am + (a >> 2)) / 2;
+		}
+	}
+}
+
+void MipMapImage(const byte *Src, int Width, int Height, byte *Dst)
+{
+	guard(MipMapImage);
+
+	CMipMapContext Ctx;
+	Ctx.Src       = Src;
+	Ctx.SrcWidth  = Width;
+	Ctx.SrcHeight = Height;
+	Ctx.Dst       = Dst;
+	Ctx.DstWidth  = max(Width >> 1, 1);
+	Ctx.DstHeight = max(Height >> 1, 1);
+
+	int NumTiles = (Ctx.DstHeight + RESAMPLE_TILE_ROWS - 1) / RESAMPLE_TILE_ROWS;
+	if (Ctx.DstWidth * Ctx.DstHeight >= MIN_THREADED_PIXELS && NumTiles > 1)
+	{
+		appParallelFor(NumTiles, MipMapWorker, &Ctx);
+	}
+	else
+	{
+		for (int i = 0; i < NumTiles; i++)
+			MipMapWorker(i, &Ctx);
+	}
+
+	unguard;
+}
+
+
+void BuildMipChain(CTextureData &TexData, byte *Image, int Width, int Height)
+{
+	guard(BuildMipChain);
+
+	AddMip(TexData, Image, Width, Height);
+	while (Width > 1 || Height > 1)
+	{
+		int NewWidth  = max(Width >> 1, 1);
+		int NewHeight = max(Height >> 1, 1);
+		byte *Data = (byte*)appMalloc(NewWidth * NewHeight * 4);
+		MipMapImage(Image, Width, Height, Data);
+		AddMip(TexData, Data, NewWidth, NewHeight);
+		Image  = Data;
+		Width  = NewWidth;
+		Height = NewHeight;
+	}
+
+	unguard;
+}
+
+
+static void GetImageDimensions(int width, int height, int* scaledWidth, int* scaledHeight)
+{
+	int sw, sh;
+	for (sw = 1; sw < width;  sw <<= 1) ;
+	for (sh = 1; sh < height; sh <<= 1) ;
+
+	// scale down only when new image dimension is larger than 64 and
+	// larger than 4/3 of original image dimension
+	if (sw > 64 && sw > (width * 4 / 3))  sw >>= 1;
+	if (sh > 64 && sh > (height * 4 / 3)) sh >>= 1;
+
+	while (sw > MAX_IMG_SIZE) sw >>= 1;
+	while (sh > MAX_IMG_SIZE) sh >>= 1;
+
+	if (sw < 1) sw = 1;
+	if (sh < 1) sh = 1;
+
+	*scaledWidth  = sw;
+	*scaledHeight = sh;
+}
+
+
+/*-----------------------------------------------------------------------------
+	Texture preparation
+-----------------------------------------------------------------------------*/
+
+// Move mipmaps from Src to Dst, previous Dst data is released
+static void MoveMips(CTextureData &Dst, CTextureData &Src)
+{
+	Dst.ReleaseCompressedData();
+	Dst.Mips.Empty(Src.Mips.Num());
+	for (int i = 0; i < Src.Mips.Num(); i++)
+	{
+		CMipMap &Mip = Src.Mips[i];
+		Dst.Mips.Add(Mip);
+		Mip.ShouldFreeData = false;
+	}
+	Src.Mips.Empty();
+}
+
+#if DEBUG_MIPS
+
+static void ColorizeMip(byte *pic, int USize, int VSize, int mipLevel)
+{
+	static const FVector cc[] = { {1,1,0}, {0,1,1}, {1,0,1}, {1,0,0}, {0,1,0}, {0,0,1} };
+	byte* d = pic;
+	FVector v = cc[min(mipLevel-1, 5)];
+	for (int i = 0; i < USize * VSize; i++, d += 4)
+	{
+		float r = d[0], g = d[1], b = d[2];
+		float c = (r + g + b) / 3.0f;
+		d[0] = byte(c * v.X);
+		d[1] = byte(c * v.Y);
+		d[2] = byte(c * v.Z);
+	}
+}
+
+#endif // DEBUG_MIPS
+
+// Decompress texture to RGBA8, resample the first mipmap to power-of-2 dimensions and
+// make mipmap chain
+static bool DecompressTexture(CTextureData &TexData, const CTexturePrepareParams &Params, CTextureData &Out)
+{
+	guard(DecompressTexture);
+
+	byte *pic = TexData.Decompress(0);
+	if (!pic)
+	{
+		// some internal decompression error, message should be already printed to log
+		return false;
+	}
+
+	const CMipMap& Mip0 = TexData.Mips[0];
+
+	// Calculate internal dimensions of the new texture
+	int scaledWidth, scaledHeight;
+	GetImageDimensions(Mip0.USize, Mip0.VSize, &scaledWidth, &scaledHeight);
+
+	// Resample texture to new buffer when needed
+	byte *scaledPic = pic;
+	if (Mip0.USize != scaledWidth || Mip0.VSize != scaledHeight)
+	{
+		scaledPic = new byte [scaledWidth * scaledHeight * 4];
+		ResampleImage(pic, Mip0.USize, Mip0.VSize, scaledPic, scaledWidth, scaledHeight);
+		delete pic; // no longer needed
+	}
+
+	if (Params.DoMipmap && Params.UseProvidedMips && TexData.Mips.Num() > 1)
+	{
+		guard(ProvidedMips);
+		// use provided mipmaps; assume all have power-of-2 dimensions
+		AddMip(Out, scaledPic, scaledWidth, scaledHeight);
+		for (int mipLevel = 1; mipLevel < TexData.Mips.Num(); mipLevel++)
+		{
+			const CMipMap& Mip = TexData.Mips[mipLevel];
+			pic = TexData.Decompress(mipLevel);
+			if (!pic) return false;
+#if DEBUG_MIPS
+			ColorizeMip(pic, Mip.USize, Mip.VSize, mipLevel);
+#endif
+			AddMip(Out, pic, Mip.USize, Mip.VSize);
+		}
+		unguard;
+	}
+	else if (Params.DoMipmap)
+	{
+		BuildMipChain(Out, scaledPic, scaledWidth, scaledHeight);
+	}
+	else
+	{
+		AddMip(Out, scaledPic, scaledWidth, scaledHeight);
+	}
+
+	return true;
+
+	unguard;
+}
+
+
+bool PrepareTextureData(const UUnrealMaterial *Tex, const CTexturePrepareParams &Params, CTextureData &TexData)
+{
+	guard(PrepareTextureData);
+
+	if (!Tex->GetTextureData(TexData))
+		return false;
+
+	if (Params.KeepFormats & (1 << TexData.Format))
+	{
+		// keep original format, copy data which belongs to the texture object
+		for (int i = 0; i < TexData.Mips.Num(); i++)
+		{
+			CMipMap &Mip = TexData.Mips[i];
+			if (Mip.ShouldFreeData || !Mip.CompressedData) continue;
+			byte *Data = (byte*)appMalloc(Mip.DataSize);
+			memcpy(Data, Mip.CompressedData, Mip.DataSize);
+			Mip.CompressedData = Data;
+			Mip.ShouldFreeData = true;
+		}
+	}
+	else
+	{
+		CTextureData Decompressed;
+		if (!DecompressTexture(TexData, Params, Decompressed))
+			return false;
+		MoveMips(TexData, Decompressed);
+		TexData.Format = TPF_RGBA8;
+	}
+	TexData.Palette = NULL;
+
+	return true;
+
+	unguardf("%s", Tex->Name);
+}
+
+
+/*-----------------------------------------------------------------------------
+	Asynchronous preparation
+
+	Requests are stored in a list in order of queueing. Only the main thread
+	adds and removes requests, worker threads change the state of requests.
+	Worker threads are started when there is work for them, and exit when the
+	queue has nothing to process.
+-----------------------------------------------------------------------------*/
+
+enum
+{
+	JOB_Queued,
+	JOB_Working,
+	JOB_Done,
+	JOB_Failed,
+};
+
+struct CTexturePrepareJob
+{
+	const UUnrealMaterial	*Tex;
+	CTexturePrepareParams	Params;
+	CTextureData			TexData;
+	int						State;
+};
+
+static CMutex JobLock;								// protects everything below
+static TArray<CTexturePrepareJob*> Jobs;
+static CThread Workers[MAX_PREPARE_THREADS];
+static bool WorkerActive[MAX_PREPARE_THREADS];
+
+
+static void TexturePrepareWorker(void *Arg)
+{
+	int WorkerIndex = (int)(size_t)Arg;
+	// Note: this function shouldn't have objects with destructors because of TRY
+	while (true)
+	{
+		// get the first queued job
+		CTexturePrepareJob *Job = NULL;
+		JobLock.Lock();
+		for (int i = 0; i < Jobs.Num(); i++)
+		{
+			if (Jobs[i]->State == JOB_Queued)
+			{
+				Job = Jobs[i];
+				Job->State = JOB_Working;
+				break;
+			}
+		}
+		if (!Job) WorkerActive[WorkerIndex] = false;
+		JobLock.Unlock();
+		if (!Job) return;
+
+		bool Ok = false;
+#if UNREAL3
+		// main thread shouldn't release bulk data while we're using it
+		FByteBulkData::PinMemory();
+#endif
+		TRY
+		{
+			Ok = PrepareTextureData(Job->Tex, Job->Params, Job->TexData);
+		}
+		CATCH_CRASH
+		{
+#if DO_GUARD
+			appPrintf("ERROR: %s", GErrorHistory);
+			GErrorHistory[0] = 0;
+#endif
+		}
+#if UNREAL3
+		FByteBulkData::UnpinMemory();
+#endif
+
+		JobLock.Lock();
+		Job->State = Ok ? JOB_Done : JOB_Failed;
+		JobLock.Unlock();
+	}
+}
+
+
+// Start an idle worker thread. JobLock should be held.
+static void StartWorker()
+{
+	// leave one core for the main thread
+	int NumWorkers = bound(appGetNumThreads() - 1, 1, MAX_PREPARE_THREADS);
+	for (int i = 0; i < NumWorkers; i++)
+	{
+		if (WorkerActive[i]) continue;
+		// the thread has finished its work, release it before reusing
+		Workers[i].Join();
+		WorkerActive[i] = true;
+		Workers[i].Start(TexturePrepareWorker, (void*)(size_t)i);
+		return;
+	}
+	// all workers are busy, one of them will pick up the new job
+}
+
+
+static int FindJob(const UUnrealMaterial *Tex)
+{
+	for (int i = 0; i < Jobs.Num(); i++)
+		if (Jobs[i]->Tex == Tex) return i;
+	return INDEX_NONE;
+}
+
+
+ETexturePrepareStatus PrepareTextureAsync(const UUnrealMaterial *Tex, const CTexturePrepareParams &Params, CTextureData *TexData)
+{
+	guard(PrepareTextureAsync);
+
+	if (appGetNumThreads() <= 1)
+	{
+		// threading is disabled, do the work immediately
+		if (!TexData) return TPS_Pending;
+		return PrepareTextureData(Tex, Params, *TexData) ? TPS_Ready : TPS_Failed;
+	}
+
+	JobLock.Lock();
+
+	int Index = FindJob(Tex);
+	if (Index < 0)
+	{
+		CTexturePrepareJob *Job = new CTexturePrepareJob;
+		Job->Tex    = Tex;
+		Job->Params = Params;
+		Job->State  = JOB_Queued;
+		Jobs.Add(Job);
+		StartWorker();
+		JobLock.Unlock();
+		return TPS_Pending;
+	}
+
+	CTexturePrepareJob *Job = Jobs[Index];
+	int State = Job->State;
+	if (State == JOB_Queued || State == JOB_Working || (State == JOB_Done && !TexData))
+	{
+		JobLock.Unlock();
+		return (State == JOB_Done) ? TPS_Ready : TPS_Pending;
+	}
+	// the job is finished, worker threads doesn't use it anymore
+	Jobs.RemoveAt(Index);
+	JobLock.Unlock();
+
+	if (State == JOB_Done)
+	{
+		MoveMips(*TexData, Job->TexData);
+		TexData->Format             = Job->TexData.Format;
+		TexData->Platform           = Job->TexData.Platform;
+		TexData->OriginalFormatName = Job->TexData.OriginalFormatName;
+		TexData->OriginalFormatEnum = Job->TexData.OriginalFormatEnum;
+		TexData->Obj                = Job->TexData.Obj;
+		TexData->Palette            = NULL;
+	}
+	delete Job;
+	return (State == JOB_Done) ? TPS_Ready : TPS_Failed;
+
+	unguardf("%s", Tex->Name);
+}
+
+
+void CancelTexturePreparation(const UUnrealMaterial *Tex)
+{
+	guard(CancelTexturePreparation);
+
+	// Jobs list is modified by the main thread only, so it could be checked without locking
+	if (!Jobs.Num()) return;
+
+	while (true)
+	{
+		JobLock.Lock();
+		int Index = FindJob(Tex);
+		if (Index < 0)
+		{
+			JobLock.Unlock();
+			return;
+		}
+		CTexturePrepareJob *Job = Jobs[Index];
+		if (Job->State != JOB_Working)
+		{
+			Jobs.RemoveAt(Index);
+			JobLock.Unlock();
+			delete Job;
+			return;
+		}
+		// worker thread uses the texture, wait for it
+		JobLock.Unlock();
+		appSleep(1);
+	}
+
+	unguard;
+}
+
+
+void CancelAllTexturePreparations()
+{
+	guard(CancelAllTexturePreparations);
+
+	while (Jobs.Num())
+	{
+		JobLock.Lock();
+		bool Busy = false;
+		for (int i = Jobs.Num() - 1; i >= 0; i--)
+		{
+			CTexturePrepareJob *Job = Jobs[i];
+			if (Job->State == JOB_Working)
+			{
+				Busy = true;
+				continue;
+			}
+			Jobs.RemoveAt(i);
+			delete Job;
+		}
+		JobLock.Unlock();
+		// wait for jobs which are processed now
+		if (Busy) appSleep(1);
+	}
+
+	unguard;
+}
@@ -0,0 +1,74 @@
+#ifndef __TEXTURE_PREPARE_H__
+#define __TEXTURE_PREPARE_H__
+
+/*-----------------------------------------------------------------------------
+	Texture preparation
+
+	Converts texture data to a form which could be passed to the GPU as is:
+	either keeps the original compressed format, or decompresses the texture
+	to RGBA8 with power-of-2 dimensions and builds a mipmap chain. This work
+	doesn't require OpenGL, so it could be performed in worker threads or
+	without a renderer at all.
+-----------------------------------------------------------------------------*/
+
+//#define DEBUG_MIPS			1			// use to debug decompression of lower mip levels, especially for XBox360
+
+// forwards
+class UUnrealMaterial;
+struct CTextureData;
+
+struct CTexturePrepareParams
+{
+	bool		DoMipmap;				// result should have mipmaps
+	bool		UseProvidedMips;		// use mipmaps stored in texture instead of generating them
+	unsigned	KeepFormats;			// mask of (1 << TPF_...) formats which shouldn't be decompressed
+
+	CTexturePrepareParams()
+	:	DoMipmap(false)
+	,	UseProvidedMips(false)
+	,	KeepFormats(0)
+	{}
+};
+
+// Image processing functions for RGBA8 images. Large images are processed in several threads.
+// Resampling ignores pixels with zero alpha. Mipmap alpha is (max + average) / 2 of source
+// pixels, so masked textures don't become transparent in lower mips.
+
+// Resample image to arbitrary dimensions.
+void ResampleImage(const byte *Src, int SrcWidth, int SrcHeight, byte *Dst, int DstWidth, int DstHeight);
+// Make the next mipmap level, Dst has dimensions max(Width/2,1) x max(Height/2,1).
+void MipMapImage(const byte *Src, int Width, int Height, byte *Dst);
+// Add Image and all its mipmap levels down to 1x1 to TexData. TexData takes ownership of Image,
+// which should be allocated with appMalloc() or operator new.
+void BuildMipChain(CTextureData &TexData, byte *Image, int Width, int Height);
+
+// Load texture data and prepare it according to Params. Resulting TexData owns all its
+// data and doesn't reference the texture object. Returns false when texture has no data
+// or decompression failed.
+bool PrepareTextureData(const UUnrealMaterial *Tex, const CTexturePrepareParams &Params, CTextureData &TexData);
+
+
+// Asynchronous preparation
+
+enum ETexturePrepareStatus
+{
+	TPS_Pending,						// texture is queued or being processed now
+	TPS_Ready,
+	TPS_Failed,
+};
+
+// Queue texture for preparation in a worker thread, or check the state of the previously
+// queued request. When the result is ready and TexData is not NULL, the data is moved to
+// TexData and the request is removed from the queue. Should be called from the main thread.
+ETexturePrepareStatus PrepareTextureAsync(const UUnrealMaterial *Tex, const CTexturePrepareParams &Params, CTextureData *TexData);
+
+// Remove the texture from the queue. If the texture is being processed now, waits for the
+// worker thread. Should be called before texture data is released or accessed from the
+// main thread.
+void CancelTexturePreparation(const UUnrealMaterial *Tex);
+
+// Cancel all requests, used when objects are destroyed.
+void CancelAllTexturePreparations();
+
+
+#endif // __TEXTURE_PREPARE_H__
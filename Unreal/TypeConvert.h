@@ -37,6 +37,8 @@ CONVERTER(FVector2D,       CMeshUVFloat   )
 CONVERTER(TArray<FVector>, TArray<CVec3>  )
 CONVERTER(TArray<FQuat>,   TArray<CQuat>  )
 CONVERTER(TArray<FCoords>, TArray<CCoords>)
+CONVERTER(TArray<CVec3>,   TArray<FVector>)
+CONVERTER(TArray<CQuat>,   TArray<FQuat>  )
 
 #undef CONVERTER
 
@@ -263,6 +263,19 @@ static void ReadTimeArray(FArchive &Ar, int NumKeys, TArray<float> &Times, int N
 
 #if ARGONAUTS
 
+// Argonauts has "half" with biased exponent: exponent values 0 and 31 are not special,
+// and the result is 2 times smaller than for standard half
+static float ArgonautsHalfToFloat(uint16 h)
+{
+	union
+	{
+		float		f;
+		unsigned	df;
+	} f;
+	f.df = ((h & 0x8000) << 16) | ((((h >> 10) & 0x1F) + (127 - 16)) << 23) | ((h & 0x3FF) << 13);
+	return f.f;
+}
+
 static void ReadArgonautsTimeArray(const TArray<unsigned> &SourceArray, int FirstKey, int NumKeys, TArray<float> &Times, float TimeScale)
 {
 	guard(ReadArgonautsTimeArray);
@@ -768,6 +781,10 @@ void UAnimSet::ConvertAnims()
 						if (ComponentMask & 2) Reader << Mins.Y << Ranges.Y;
 						if (ComponentMask & 4) Reader << Mins.Z << Ranges.Z;
 					}
+					// try batch decoder first
+					if (DecodePerTrackTranslationKeys(Reader, Seq->CompressedByteStream.GetData(), KeyFormat, ComponentMask,
+							NumKeys, Mins, Ranges, CVT(A->KeyPos)))
+						goto per_track_trans_done;
 					for (k = 0; k < NumKeys; k++)
 					{
 						switch (KeyFormat)
@@ -819,6 +836,7 @@ void UAnimSet::ConvertAnims()
 							appError("Unknown translation compression method: %d (%s)", KeyFormat, EnumToName(KeyFormat));
 						}
 					}
+				per_track_trans_done:
 					// align to 4 bytes
 					Reader.Seek(Align(Reader.Tell(), 4));
 					if (HasTimeTracks)
@@ -866,6 +884,10 @@ void UAnimSet::ConvertAnims()
 						if (ComponentMask & 2) Reader << Mins.Y << Ranges.Y;
 						if (ComponentMask & 4) Reader << Mins.Z << Ranges.Z;
 					}
+					// try batch decoder first
+					if (DecodePerTrackRotationKeys(Reader, Seq->CompressedByteStream.GetData(), KeyFormat, ComponentMask,
+							NumKeys, Mins, Ranges, CVT(A->KeyQuat)))
+						goto per_track_rot_done;
 					for (k = 0; k < NumKeys; k++)
 					{
 						switch (KeyFormat)
@@ -904,6 +926,7 @@ void UAnimSet::ConvertAnims()
 							appError("Unknown rotation compression method: %d (%s)", KeyFormat, EnumToName(KeyFormat));
 						}
 					}
+				per_track_rot_done:
 					// align to 4 bytes
 					Reader.Seek(Align(Reader.Tell(), 4));
 					if (HasTimeTracks)
@@ -993,6 +1016,11 @@ void UAnimSet::ConvertAnims()
 				} // else - original code for uncompressed vector
 #endif // TRANSFORMERS
 
+				// try batch decoder first
+				if (DecodeTranslationKeys(Reader, Seq->CompressedByteStream.GetData(), TranslationCompressionFormat, TransKeys,
+						Mins, Ranges, CVT(A->KeyPos)))
+					goto trans_keys_done;
+
 				for (k = 0; k < TransKeys; k++)
 				{
 					switch (TranslationCompressionFormat)
@@ -1028,9 +1056,9 @@ void UAnimSet::ConvertAnims()
 							uint16 x, y, z;
 							Reader << x << y << z;
 							FVector v;
-							v.X = half2float(x) / 2;	// Argonauts has "half" with biased exponent, so fix it with division by 2
-							v.Y = half2float(y) / 2;
-							v.Z = half2float(z) / 2;
+							v.X = ArgonautsHalfToFloat(x);
+							v.Y = ArgonautsHalfToFloat(y);
+							v.Z = ArgonautsHalfToFloat(z);
 							A->KeyPos.Add(CVT(v));
 						}
 						break;
@@ -1095,6 +1123,11 @@ void UAnimSet::ConvertAnims()
 				Reader << TransQuatBase;
 #endif // TRANSFORMERS
 
+			// try batch decoder first
+			if (DecodeRotationKeys(Reader, Seq->CompressedByteStream.GetData(), RotationCompressionFormat, RotKeys,
+					Mins, Ranges, CVT(A->KeyQuat)))
+				goto rot_keys_decoded;
+
 			for (k = 0; k < RotKeys; k++)
 			{
 				switch (RotationCompressionFormat)
@@ -1167,6 +1200,7 @@ void UAnimSet::ConvertAnims()
 				}
 			}
 
+		rot_keys_decoded:
 #if TRANSFORMERS
 			if (ArGame == GAME_Transformers && RotKeys >= 2 &&
 				(RotationCompressionFormat == ACF_IntervalFixed32NoW || RotationCompressionFormat == ACF_IntervalFixed48NoW))
@@ -377,6 +377,10 @@ void USkeleton::ConvertAnims(UAnimSequence4* Seq)
 					if (ComponentMask & 2) Reader << Mins.Y << Ranges.Y;
 					if (ComponentMask & 4) Reader << Mins.Z << Ranges.Z;
 				}
+				// try batch decoder first
+				if (DecodePerTrackTranslationKeys(Reader, Seq->CompressedByteStream.GetData(), KeyFormat, ComponentMask,
+						NumKeys, Mins, Ranges, CVT(A->KeyPos)))
+					goto per_track_trans_done;
 				for (k = 0; k < NumKeys; k++)
 				{
 					switch (KeyFormat)
@@ -428,6 +432,7 @@ void USkeleton::ConvertAnims(UAnimSequence4* Seq)
 						appError("Unknown translation compression method: %d (%s)", KeyFormat, EnumToName(KeyFormat));
 					}
 				}
+			per_track_trans_done:
 				// align to 4 bytes
 				Reader.Seek(Align(Reader.Tell(), 4));
 				if (HasTimeTracks)
@@ -460,6 +465,10 @@ void USkeleton::ConvertAnims(UAnimSequence4* Seq)
 					if (ComponentMask & 2) Reader << Mins.Y << Ranges.Y;
 					if (ComponentMask & 4) Reader << Mins.Z << Ranges.Z;
 				}
+				// try batch decoder first
+				if (DecodePerTrackRotationKeys(Reader, Seq->CompressedByteStream.GetData(), KeyFormat, ComponentMask,
+						NumKeys, Mins, Ranges, CVT(A->KeyQuat)))
+					goto per_track_rot_done;
 				for (k = 0; k < NumKeys; k++)
 				{
 					switch (KeyFormat)
@@ -494,6 +503,7 @@ void USkeleton::ConvertAnims(UAnimSequence4* Seq)
 						appError("Unknown rotation compression method: %d (%s)", KeyFormat, EnumToName(KeyFormat));
 					}
 				}
+			per_track_rot_done:
 				// align to 4 bytes
 				Reader.Seek(Align(Reader.Tell(), 4));
 				if (HasTimeTracks)
@@ -533,6 +543,11 @@ void USkeleton::ConvertAnims(UAnimSequence4* Seq)
 				Reader << Mins << Ranges;
 			}
 
+			// try batch decoder first
+			if (DecodeTranslationKeys(Reader, Seq->CompressedByteStream.GetData(), TranslationCompressionFormat, TransKeys,
+					Mins, Ranges, CVT(A->KeyPos)))
+				goto trans_keys_done;
+
 			for (k = 0; k < TransKeys; k++)
 			{
 				switch (TranslationCompressionFormat)
@@ -549,6 +564,7 @@ void USkeleton::ConvertAnims(UAnimSequence4* Seq)
 				}
 			}
 
+		trans_keys_done:
 			// align to 4 bytes
 			Reader.Seek(Align(Reader.Tell(), 4));
 			if (HasTimeTracks)
@@ -578,6 +594,11 @@ void USkeleton::ConvertAnims(UAnimSequence4* Seq)
 			Reader << Mins << Ranges;
 		}
 
+		// try batch decoder first
+		if (DecodeRotationKeys(Reader, Seq->CompressedByteStream.GetData(), RotationCompressionFormat, RotKeys,
+				Mins, Ranges, CVT(A->KeyQuat)))
+			goto rot_keys_done;
+
 		for (k = 0; k < RotKeys; k++)
 		{
 			switch (RotationCompressionFormat)
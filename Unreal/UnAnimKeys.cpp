@@ -0,0 +1,575 @@
+#include "Core.h"
+
+#if UNREAL3
+
+#include "UnCore.h"
+#include "UnObject.h"
+#include "UnMesh3.h"
+#include "UnMeshTypes.h"
+#include "MeshCommon.h"			// USE_SSE
+
+
+/*-----------------------------------------------------------------------------
+	Batch key decoders
+-----------------------------------------------------------------------------*/
+
+// Keys of a single track are placed contiguously in CompressedByteStream, so they are decoded
+// directly from memory with loops specialized for the key format and component mask, without
+// per-key format switch and virtual FArchive calls. Keys are converted with the same code as
+// FArchive-based decoder uses, so results are bit-identical (this is checked by Tools/AnimKeyTest).
+
+// Returns pointer to Size bytes at the current archive position and skips these bytes
+static const uint8* GetKeyData(FArchive &Ar, const uint8 *Data, int Size)
+{
+	int Pos = Ar.Tell();
+	if (Pos + Size > Ar.GetFileSize())
+		appError("Serializing behind end of buffer (%X+%X > %X)", Pos, Size, Ar.GetFileSize());
+	Ar.Seek(Pos + Size);
+	return Data + Pos;
+}
+
+template<class VecType>
+static void DecodeVectors(const uint8 *Src, int NumKeys, FVector *Dst)
+{
+	for (int i = 0; i < NumKeys; i++, Src += sizeof(VecType))
+	{
+		VecType v;
+		memcpy(&v, Src, sizeof(VecType));
+		Dst[i] = v;
+	}
+}
+
+template<class VecType>
+static void DecodeVectorsRanged(const uint8 *Src, int NumKeys, FVector *Dst, const FVector &Mins, const FVector &Ranges)
+{
+	for (int i = 0; i < NumKeys; i++, Src += sizeof(VecType))
+	{
+		VecType v;
+		memcpy(&v, Src, sizeof(VecType));
+		Dst[i] = v.ToVector(Mins, Ranges);
+	}
+}
+
+template<class QuatType>
+static void DecodeQuats(const uint8 *Src, int NumKeys, FQuat *Dst)
+{
+	for (int i = 0; i < NumKeys; i++, Src += sizeof(QuatType))
+	{
+		QuatType q;
+		memcpy(&q, Src, sizeof(QuatType));
+		Dst[i] = q;
+	}
+}
+
+template<class QuatType>
+static void DecodeQuatsRanged(const uint8 *Src, int NumKeys, FQuat *Dst, const FVector &Mins, const FVector &Ranges)
+{
+	for (int i = 0; i < NumKeys; i++, Src += sizeof(QuatType))
+	{
+		QuatType q;
+		memcpy(&q, Src, sizeof(QuatType));
+		Dst[i] = q.ToQuat(Mins, Ranges);
+	}
+}
+
+#if USE_SSE
+
+// SSE2 versions of the decoders above, working with 4 keys at once. These functions decode the
+// largest multiple of 4 keys and return the number of decoded keys, remaining keys should be
+// decoded with the scalar code. Math operations are the same as in UnMeshTypes.h and executed
+// in the same order, so results are bit-identical with the scalar code.
+
+// Split 4 keys with 3 components, stored as X0 Y0 Z0 X1 | Y1 Z1 X2 Y2 | Z2 X3 Y3 Z3, to X, Y and Z
+static FORCEINLINE void Deinterleave3(__m128 A, __m128 B, __m128 C, __m128 &X, __m128 &Y, __m128 &Z)
+{
+	__m128 T0 = _mm_shuffle_ps(B, C, _MM_SHUFFLE(2,1,3,2));		// X2 Y2 X3 Y3
+	__m128 T1 = _mm_shuffle_ps(A, B, _MM_SHUFFLE(1,0,2,1));		// Y0 Z0 Y1 Z1
+	X = _mm_shuffle_ps(A, T0, _MM_SHUFFLE(2,0,3,0));
+	Y = _mm_shuffle_ps(T1, T0, _MM_SHUFFLE(3,1,2,0));
+	Z = _mm_shuffle_ps(T1, C, _MM_SHUFFLE(3,0,3,1));
+}
+
+// Load 4 keys with 3 uint16 components and convert them to (Value - Offset) as floats
+static FORCEINLINE void LoadFixed48(const uint8 *Src, int Offset, __m128 &A, __m128 &B, __m128 &C)
+{
+	__m128i Lo   = _mm_loadu_si128((const __m128i*)Src);
+	__m128i Hi   = _mm_loadl_epi64((const __m128i*)(Src + 16));
+	__m128i Zero = _mm_setzero_si128();
+	__m128i Ofs  = _mm_set1_epi32(Offset);
+	A = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_unpacklo_epi16(Lo, Zero), Ofs));
+	B = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_unpackhi_epi16(Lo, Zero), Ofs));
+	C = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_unpacklo_epi16(Hi, Zero), Ofs));
+}
+
+// Same as RESTORE_QUAT_W()
+static FORCEINLINE __m128 RestoreQuatW(__m128 X, __m128 Y, __m128 Z)
+{
+	__m128 wSq = _mm_sub_ps(_mm_set1_ps(1.0f), _mm_add_ps(_mm_add_ps(_mm_mul_ps(X, X), _mm_mul_ps(Y, Y)), _mm_mul_ps(Z, Z)));
+	// sqrt of negative value is NaN, it is masked out
+	return _mm_and_ps(_mm_cmpgt_ps(wSq, _mm_setzero_ps()), _mm_sqrt_ps(wSq));
+}
+
+static FORCEINLINE void StoreQuats(FQuat *Dst, __m128 X, __m128 Y, __m128 Z, __m128 W)
+{
+	_MM_TRANSPOSE4_PS(X, Y, Z, W);
+	_mm_storeu_ps(&Dst[0].X, X);
+	_mm_storeu_ps(&Dst[1].X, Y);
+	_mm_storeu_ps(&Dst[2].X, Z);
+	_mm_storeu_ps(&Dst[3].X, W);
+}
+
+static FORCEINLINE void StoreVectors(FVector *Dst, __m128 X, __m128 Y, __m128 Z)
+{
+	__m128 W = _mm_setzero_ps();
+	_MM_TRANSPOSE4_PS(X, Y, Z, W);
+	// 16-byte store overlaps with the next vector, which is written after that
+	_mm_storeu_ps(&Dst[0].X, X);
+	_mm_storeu_ps(&Dst[1].X, Y);
+	_mm_storeu_ps(&Dst[2].X, Z);
+	_mm_storel_pi((__m64*)&Dst[3].X, W);
+	_mm_store_ss(&Dst[3].Z, _mm_movehl_ps(W, W));
+}
+
+// FVectorFixed48 or per-track Fixed48 vector with all 3 components: (Value - Offset) * Scale
+static int DecodeFixed48Vectors_SSE(const uint8 *Src, int NumKeys, FVector *Dst, int Offset, float Scale)
+{
+	__m128 S = _mm_set1_ps(Scale);
+	int i;
+	for (i = 0; i + 4 <= NumKeys; i += 4, Src += 4 * 3 * sizeof(uint16))
+	{
+		__m128 A, B, C, X, Y, Z;
+		LoadFixed48(Src, Offset, A, B, C);
+		Deinterleave3(_mm_mul_ps(A, S), _mm_mul_ps(B, S), _mm_mul_ps(C, S), X, Y, Z);
+		StoreVectors(Dst + i, X, Y, Z);
+	}
+	return i;
+}
+
+static int DecodeFixed48Quats_SSE(const uint8 *Src, int NumKeys, FQuat *Dst)
+{
+	__m128 Div = _mm_set1_ps(32767.0f);
+	int i;
+	for (i = 0; i + 4 <= NumKeys; i += 4, Src += 4 * sizeof(FQuatFixed48NoW))
+	{
+		__m128 A, B, C, X, Y, Z;
+		LoadFixed48(Src, 32767, A, B, C);
+		Deinterleave3(_mm_div_ps(A, Div), _mm_div_ps(B, Div), _mm_div_ps(C, Div), X, Y, Z);
+		StoreQuats(Dst + i, X, Y, Z, RestoreQuatW(X, Y, Z));
+	}
+	return i;
+}
+
+static int DecodeFloat96Quats_SSE(const uint8 *Src, int NumKeys, FQuat *Dst)
+{
+	int i;
+	for (i = 0; i + 4 <= NumKeys; i += 4, Src += 4 * sizeof(FQuatFloat96NoW))
+	{
+		__m128 X, Y, Z;
+		Deinterleave3(_mm_loadu_ps((const float*)Src), _mm_loadu_ps((const float*)Src + 4), _mm_loadu_ps((const float*)Src + 8), X, Y, Z);
+		StoreQuats(Dst + i, X, Y, Z, RestoreQuatW(X, Y, Z));
+	}
+	return i;
+}
+
+// (Value / Div - 1.0f) * Range + Min
+static FORCEINLINE __m128 DecodeInterval(__m128i Value, float Div, float Min, float Range)
+{
+	__m128 r = _mm_sub_ps(_mm_div_ps(_mm_cvtepi32_ps(Value), _mm_set1_ps(Div)), _mm_set1_ps(1.0f));
+	return _mm_add_ps(_mm_mul_ps(r, _mm_set1_ps(Range)), _mm_set1_ps(Min));
+}
+
+// FVectorIntervalFixed32: X:10, Y:11, Z:11
+static int DecodeIntervalFixed32Vectors_SSE(const uint8 *Src, int NumKeys, FVector *Dst, const FVector &Mins, const FVector &Ranges)
+{
+	__m128i Mask10 = _mm_set1_epi32(0x3FF);
+	__m128i Mask11 = _mm_set1_epi32(0x7FF);
+	int i;
+	for (i = 0; i + 4 <= NumKeys; i += 4, Src += 4 * sizeof(FVectorIntervalFixed32))
+	{
+		__m128i V = _mm_loadu_si128((const __m128i*)Src);
+		__m128 X = DecodeInterval(_mm_and_si128(V, Mask10), 511.0f, Mins.X, Ranges.X);
+		__m128 Y = DecodeInterval(_mm_and_si128(_mm_srli_epi32(V, 10), Mask11), 1023.0f, Mins.Y, Ranges.Y);
+		__m128 Z = DecodeInterval(_mm_srli_epi32(V, 21), 1023.0f, Mins.Z, Ranges.Z);
+		StoreVectors(Dst + i, X, Y, Z);
+	}
+	return i;
+}
+
+// FQuatIntervalFixed32NoW: Z:10, Y:11, X:11
+static int DecodeIntervalFixed32Quats_SSE(const uint8 *Src, int NumKeys, FQuat *Dst, const FVector &Mins, const FVector &Ranges)
+{
+	__m128i Mask10 = _mm_set1_epi32(0x3FF);
+	__m128i Mask11 = _mm_set1_epi32(0x7FF);
+	int i;
+	for (i = 0; i + 4 <= NumKeys; i += 4, Src += 4 * sizeof(FQuatIntervalFixed32NoW))
+	{
+		__m128i V = _mm_loadu_si128((const __m128i*)Src);
+		__m128 Z = DecodeInterval(_mm_and_si128(V, Mask10), 511.0f, Mins.Z, Ranges.Z);
+		__m128 Y = DecodeInterval(_mm_and_si128(_mm_srli_epi32(V, 10), Mask11), 1023.0f, Mins.Y, Ranges.Y);
+		__m128 X = DecodeInterval(_mm_srli_epi32(V, 21), 1023.0f, Mins.X, Ranges.X);
+		StoreQuats(Dst + i, X, Y, Z, RestoreQuatW(X, Y, Z));
+	}
+	return i;
+}
+
+#endif // USE_SSE
+
+// Decoders for formats which have SSE2 code path: use SSE2 for groups of 4 keys, and scalar
+// code for the remaining ones
+
+static void DecodeFixed48Vectors(const uint8 *Src, int NumKeys, FVector *Dst)
+{
+	int i = 0;
+#if USE_SSE
+	i = DecodeFixed48Vectors_SSE(Src, NumKeys, Dst, 32767, 128.0f / 32767.0f);
+#endif
+	DecodeVectors<FVectorFixed48>(Src + i * sizeof(FVectorFixed48), NumKeys - i, Dst + i);
+}
+
+static void DecodeIntervalFixed32Vectors(const uint8 *Src, int NumKeys, FVector *Dst, const FVector &Mins, const FVector &Ranges)
+{
+	int i = 0;
+#if USE_SSE
+	i = DecodeIntervalFixed32Vectors_SSE(Src, NumKeys, Dst, Mins, Ranges);
+#endif
+	DecodeVectorsRanged<FVectorIntervalFixed32>(Src + i * sizeof(FVectorIntervalFixed32), NumKeys - i, Dst + i, Mins, Ranges);
+}
+
+static void DecodeFixed48Quats(const uint8 *Src, int NumKeys, FQuat *Dst)
+{
+	int i = 0;
+#if USE_SSE
+	i = DecodeFixed48Quats_SSE(Src, NumKeys, Dst);
+#endif
+	DecodeQuats<FQuatFixed48NoW>(Src + i * sizeof(FQuatFixed48NoW), NumKeys - i, Dst + i);
+}
+
+static void DecodeFloat96Quats(const uint8 *Src, int NumKeys, FQuat *Dst)
+{
+	int i = 0;
+#if USE_SSE
+	i = DecodeFloat96Quats_SSE(Src, NumKeys, Dst);
+#endif
+	DecodeQuats<FQuatFloat96NoW>(Src + i * sizeof(FQuatFloat96NoW), NumKeys - i, Dst + i);
+}
+
+static void DecodeIntervalFixed32Quats(const uint8 *Src, int NumKeys, FQuat *Dst, const FVector &Mins, const FVector &Ranges)
+{
+	int i = 0;
+#if USE_SSE
+	i = DecodeIntervalFixed32Quats_SSE(Src, NumKeys, Dst, Mins, Ranges);
+#endif
+	DecodeQuatsRanged<FQuatIntervalFixed32NoW>(Src + i * sizeof(FQuatIntervalFixed32NoW), NumKeys - i, Dst + i, Mins, Ranges);
+}
+
+// Per-track ACF_Float96NoW translation: only components from Mask are stored, Mask 0 means
+// that all 3 components are present
+template<int Mask>
+static void DecodePerTrackFloat96Vectors(const uint8 *Src, int NumKeys, FVector *Dst)
+{
+	for (int i = 0; i < NumKeys; i++)
+	{
+		FVector v;
+		v.Set(0, 0, 0);
+		if (!Mask)
+		{
+			memcpy(&v, Src, sizeof(FVector)); Src += sizeof(FVector);
+		}
+		if (Mask & 1) { memcpy(&v.X, Src, sizeof(float)); Src += sizeof(float); }
+		if (Mask & 2) { memcpy(&v.Y, Src, sizeof(float)); Src += sizeof(float); }
+		if (Mask & 4) { memcpy(&v.Z, Src, sizeof(float)); Src += sizeof(float); }
+		Dst[i] = v;
+	}
+}
+
+// Per-track ACF_Fixed48NoW translation
+template<int Mask>
+static void DecodePerTrackFixed48Vectors(const uint8 *Src, int NumKeys, FVector *Dst)
+{
+	int i = 0;
+#if USE_SSE
+	if (Mask == 7)
+	{
+		// same as DecodeFixed48_PerTrackComponent<7>()
+		i = DecodeFixed48Vectors_SSE(Src, NumKeys, Dst, 255, 1.0f);
+		Src += i * 3 * sizeof(uint16);
+	}
+#endif
+	for ( ; i < NumKeys; i++)
+	{
+		FVector v;
+		v.Set(0, 0, 0);
+		uint16 c;
+		if (Mask & 1) { memcpy(&c, Src, sizeof(uint16)); Src += sizeof(uint16); v.X = DecodeFixed48_PerTrackComponent<7>(c); }
+		if (Mask & 2) { memcpy(&c, Src, sizeof(uint16)); Src += sizeof(uint16); v.Y = DecodeFixed48_PerTrackComponent<7>(c); }
+		if (Mask & 4) { memcpy(&c, Src, sizeof(uint16)); Src += sizeof(uint16); v.Z = DecodeFixed48_PerTrackComponent<7>(c); }
+		Dst[i] = v;
+	}
+}
+
+// Per-track ACF_Fixed48NoW rotation
+template<int Mask>
+static void DecodePerTrackFixed48Quats(const uint8 *Src, int NumKeys, FQuat *Dst)
+{
+	int i = 0;
+#if USE_SSE
+	if (Mask == 7)
+	{
+		// all components are stored, this is FQuatFixed48NoW
+		i = DecodeFixed48Quats_SSE(Src, NumKeys, Dst);
+		Src += i * sizeof(FQuatFixed48NoW);
+	}
+#endif
+	for ( ; i < NumKeys; i++)
+	{
+		FQuatFixed48NoW q;
+		q.X = q.Y = q.Z = 32767;			// corresponds to 0
+		if (Mask & 1) { memcpy(&q.X, Src, sizeof(uint16)); Src += sizeof(uint16); }
+		if (Mask & 2) { memcpy(&q.Y, Src, sizeof(uint16)); Src += sizeof(uint16); }
+		if (Mask & 4) { memcpy(&q.Z, Src, sizeof(uint16)); Src += sizeof(uint16); }
+		Dst[i] = q;
+	}
+}
+
+// Call Func<Mask>(Args) with compile-time Mask value
+#define DISPATCH_COMPONENT_MASK(Func, Mask, Args)	\
+	switch (Mask)									\
+	{												\
+	case 0: Func<0> Args; break;					\
+	case 1: Func<1> Args; break;					\
+	case 2: Func<2> Args; break;					\
+	case 3: Func<3> Args; break;					\
+	case 4: Func<4> Args; break;					\
+	case 5: Func<5> Args; break;					\
+	case 6: Func<6> Args; break;					\
+	case 7: Func<7> Args; break;					\
+	}
+
+// Number of components stored for ComponentMask
+static const int NumMaskComponents[8] = { 0, 1, 1, 2, 1, 2, 2, 3 };
+
+
+bool DecodeTranslationKeys(FArchive &Ar, const uint8 *Data, AnimationCompressionFormat Format, int NumKeys,
+	const FVector &Mins, const FVector &Ranges, TArray<FVector> &Keys)
+{
+	guard(DecodeTranslationKeys);
+
+	if (Ar.ReverseBytes) return false;		// data should be byte-swapped, use generic code
+
+	int KeySize;
+	switch (Format)
+	{
+	case ACF_None:
+	case ACF_Float96NoW:
+		KeySize = sizeof(FVector); break;
+	case ACF_IntervalFixed32NoW:
+		KeySize = sizeof(FVectorIntervalFixed32); break;
+	case ACF_Fixed48NoW:
+		KeySize = sizeof(FVectorFixed48); break;
+	case ACF_Identity:
+		KeySize = 0; break;
+	default:
+		return false;
+	}
+
+	const uint8 *Src = GetKeyData(Ar, Data, KeySize * NumKeys);
+	int Index = Keys.AddUninitialized(NumKeys);
+	FVector *Dst = Keys.GetData() + Index;
+
+	switch (Format)
+	{
+	case ACF_None:
+	case ACF_Float96NoW:
+		memcpy(Dst, Src, KeySize * NumKeys);
+		break;
+	case ACF_IntervalFixed32NoW:
+		DecodeIntervalFixed32Vectors(Src, NumKeys, Dst, Mins, Ranges);
+		break;
+	case ACF_Fixed48NoW:
+		DecodeFixed48Vectors(Src, NumKeys, Dst);
+		break;
+	case ACF_Identity:
+		for (int i = 0; i < NumKeys; i++) Dst[i].Set(0, 0, 0);
+		break;
+	default:
+		assert(0);			// rejected above
+	}
+	return true;
+
+	unguard;
+}
+
+
+bool DecodeRotationKeys(FArchive &Ar, const uint8 *Data, AnimationCompressionFormat Format, int NumKeys,
+	const FVector &Mins, const FVector &Ranges, TArray<FQuat> &Keys)
+{
+	guard(DecodeRotationKeys);
+
+	if (Ar.ReverseBytes) return false;		// data should be byte-swapped, use generic code
+
+	int KeySize;
+	switch (Format)
+	{
+	case ACF_None:
+		KeySize = sizeof(FQuat); break;
+	case ACF_Float96NoW:
+		KeySize = sizeof(FQuatFloat96NoW); break;
+	case ACF_Fixed48NoW:
+		KeySize = sizeof(FQuatFixed48NoW); break;
+	case ACF_Fixed32NoW:
+		KeySize = sizeof(FQuatFixed32NoW); break;
+	case ACF_IntervalFixed32NoW:
+		KeySize = sizeof(FQuatIntervalFixed32NoW); break;
+	case ACF_Float32NoW:
+		KeySize = sizeof(FQuatFloat32NoW); break;
+	case ACF_Identity:
+		KeySize = 0; break;
+	default:
+		return false;
+	}
+
+	const uint8 *Src = GetKeyData(Ar, Data, KeySize * NumKeys);
+	int Index = Keys.AddUninitialized(NumKeys);
+	FQuat *Dst = Keys.GetData() + Index;
+
+	switch (Format)
+	{
+	case ACF_None:
+		memcpy(Dst, Src, KeySize * NumKeys);
+		break;
+	case ACF_Float96NoW:
+		DecodeFloat96Quats(Src, NumKeys, Dst);
+		break;
+	case ACF_Fixed48NoW:
+		DecodeFixed48Quats(Src, NumKeys, Dst);
+		break;
+	case ACF_Fixed32NoW:
+		DecodeQuats<FQuatFixed32NoW>(Src, NumKeys, Dst);
+		break;
+	case ACF_IntervalFixed32NoW:
+		DecodeIntervalFixed32Quats(Src, NumKeys, Dst, Mins, Ranges);
+		break;
+	case ACF_Float32NoW:
+		DecodeQuats<FQuatFloat32NoW>(Src, NumKeys, Dst);
+		break;
+	case ACF_Identity:
+		for (int i = 0; i < NumKeys; i++) Dst[i].Set(0, 0, 0, 1);
+		break;
+	default:
+		assert(0);			// rejected above
+	}
+	return true;
+
+	unguard;
+}
+
+
+bool DecodePerTrackTranslationKeys(FArchive &Ar, const uint8 *Data, AnimationCompressionFormat Format, int ComponentMask,
+	int NumKeys, const FVector &Mins, const FVector &Ranges, TArray<FVector> &Keys)
+{
+	guard(DecodePerTrackTranslationKeys);
+
+	if (Ar.ReverseBytes) return false;		// data should be byte-swapped, use generic code
+
+	int Mask = ComponentMask & 7;
+	int KeySize;
+	switch (Format)
+	{
+	case ACF_Float96NoW:
+		KeySize = Mask ? NumMaskComponents[Mask] * sizeof(float) : sizeof(FVector); break;
+	case ACF_IntervalFixed32NoW:
+		KeySize = sizeof(FVectorIntervalFixed32); break;
+	case ACF_Fixed48NoW:
+		KeySize = NumMaskComponents[Mask] * sizeof(uint16); break;
+	case ACF_Identity:
+		KeySize = 0; break;
+	default:
+		return false;
+	}
+
+	const uint8 *Src = GetKeyData(Ar, Data, KeySize * NumKeys);
+	int Index = Keys.AddUninitialized(NumKeys);
+	FVector *Dst = Keys.GetData() + Index;
+
+	switch (Format)
+	{
+	case ACF_Float96NoW:
+		DISPATCH_COMPONENT_MASK(DecodePerTrackFloat96Vectors, Mask, (Src, NumKeys, Dst));
+		break;
+	case ACF_IntervalFixed32NoW:
+		DecodeIntervalFixed32Vectors(Src, NumKeys, Dst, Mins, Ranges);
+		break;
+	case ACF_Fixed48NoW:
+		DISPATCH_COMPONENT_MASK(DecodePerTrackFixed48Vectors, Mask, (Src, NumKeys, Dst));
+		break;
+	case ACF_Identity:
+		for (int i = 0; i < NumKeys; i++) Dst[i].Set(0, 0, 0);
+		break;
+	default:
+		assert(0);			// rejected above
+	}
+	return true;
+
+	unguard;
+}
+
+
+bool DecodePerTrackRotationKeys(FArchive &Ar, const uint8 *Data, AnimationCompressionFormat Format, int ComponentMask,
+	int NumKeys, const FVector &Mins, const FVector &Ranges, TArray<FQuat> &Keys)
+{
+	guard(DecodePerTrackRotationKeys);
+
+	if (Ar.ReverseBytes) return false;		// data should be byte-swapped, use generic code
+
+	int Mask = ComponentMask & 7;
+	int KeySize;
+	switch (Format)
+	{
+	case ACF_Float96NoW:
+		KeySize = sizeof(FQuatFloat96NoW); break;
+	case ACF_Fixed48NoW:
+		KeySize = NumMaskComponents[Mask] * sizeof(uint16); break;
+	case ACF_Fixed32NoW:
+	case ACF_IntervalFixed32NoW:
+	case ACF_Float32NoW:
+		KeySize = sizeof(uint32); break;
+	case ACF_Identity:
+		KeySize = 0; break;
+	default:
+		return false;
+	}
+
+	const uint8 *Src = GetKeyData(Ar, Data, KeySize * NumKeys);
+	int Index = Keys.AddUninitialized(NumKeys);
+	FQuat *Dst = Keys.GetData() + Index;
+
+	switch (Format)
+	{
+	case ACF_Float96NoW:
+		DecodeFloat96Quats(Src, NumKeys, Dst);
+		break;
+	case ACF_Fixed48NoW:
+		DISPATCH_COMPONENT_MASK(DecodePerTrackFixed48Quats, Mask, (Src, NumKeys, Dst));
+		break;
+	case ACF_Fixed32NoW:
+		DecodeQuats<FQuatFixed32NoW>(Src, NumKeys, Dst);
+		break;
+	case ACF_IntervalFixed32NoW:
+		DecodeIntervalFixed32Quats(Src, NumKeys, Dst, Mins, Ranges);
+		break;
+	case ACF_Float32NoW:
+		DecodeQuats<FQuatFloat32NoW>(Src, NumKeys, Dst);
+		break;
+	case ACF_Identity:
+		for (int i = 0; i < NumKeys; i++) Dst[i].Set(0, 0, 0, 1);
+		break;
+	default:
+		assert(0);			// rejected above
+	}
+	return true;
+
+	unguard;
+}
+
+
+#endif // UNREAL3
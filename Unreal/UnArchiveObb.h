@@ -12,25 +12,22 @@ struct FObbEntry
 };
 
 
-class FObbFile : public FArchive
+class FObbFile : public FVirtualFileReader
 {
-	DECLARE_ARCHIVE(FObbFile, FArchive);
+	DECLARE_ARCHIVE(FObbFile, FVirtualFileReader);
 public:
 	FObbFile(const FObbEntry* info, FArchive* reader)
-	:	Info(info)
-	,	Reader(reader)
+	:	FVirtualFileReader(reader)
+	,	Info(info)
 	{}
 
 	virtual void Serialize(void *data, int size)
 	{
 		guard(FObbFile::Serialize);
+		ArPos += ReleaseWindow();
 		if (ArStopper > 0 && ArPos + size > ArStopper)
 			appError("Serializing behind stopper (%X+%X > %X)", ArPos, size, ArStopper);
-		// seek every time in a case if the same 'Reader' was used by different FObbFile
-		// (this is a lightweight operation for buffered FArchive)
-		Reader->Seek64(Info->Pos + ArPos);
-		Reader->Serialize(data, size);
-		ArPos += size;
+		ReadBuffered(Info->Pos, Info->Size, data, size);
 		unguard;
 	}
 
@@ -38,6 +35,7 @@ public:
 	{
 		guard(FObbFile::Seek);
 		assert(Pos >= 0 && Pos < Info->Size);
+		ReleaseWindow();
 		ArPos = Pos;
 		unguard;
 	}
@@ -49,7 +47,6 @@ public:
 
 protected:
 	const FObbEntry* Info;
-	FArchive*	Reader;
 };
 
 
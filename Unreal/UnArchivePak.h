@@ -63,6 +63,7 @@ struct FPakEntry
 	int			CompressionBlockSize;
 
 	int64		StructSize;					// computed value
+	FPakEntry*	HashNext;					// used by FPakVFS
 
 	friend FArchive& operator<<(FArchive& Ar, FPakEntry& P)
 	{
@@ -98,13 +99,113 @@ struct FPakEntry
 	}
 };
 
-class FPakFile : public FArchive
+// Parser for in-memory pak index. Index is read with a single call and parsed here
+// without FArchive virtual calls, which is noticeably faster for paks with a lot of files.
+// Note: little-endian data only.
+struct FPakIndexReader
 {
-	DECLARE_ARCHIVE(FPakFile, FArchive);
+	const byte*	Data;
+	const byte*	End;
+
+	FPakIndexReader(const byte* InData, int Size)
+	:	Data(InData)
+	,	End(InData + Size)
+	{}
+
+	FORCEINLINE void Read(void* Dst, int Size)
+	{
+		if (Data + Size > End) appError("Pak index is truncated");
+		memcpy(Dst, Data, Size);
+		Data += Size;
+	}
+
+	FORCEINLINE int ReadInt()
+	{
+		int Value;
+		Read(&Value, sizeof(Value));
+		return Value;
+	}
+
+	FORCEINLINE int64 ReadInt64()
+	{
+		int64 Value;
+		Read(&Value, sizeof(Value));
+		return Value;
+	}
+
+	// Read FString, append it to the string in Dst
+	void ReadString(char* Dst, int DstSize)
+	{
+		int len = ReadInt();
+		int used = strlen(Dst);
+		char* d = Dst + used;
+		char* dEnd = Dst + DstSize - 1;
+		if (len >= 0)
+		{
+			// ANSI string, copy with null terminator
+			if (Data + len > End) appError("Pak index is truncated");
+			for (int i = 0; i < len && d < dEnd; i++)
+				*d++ = Data[i];
+			Data += len;
+		}
+		else
+		{
+			// UNICODE string, conversion is the same as in FString serializer
+			len = -len;
+			if (Data + len * 2 > End) appError("Pak index is truncated");
+			for (int i = 0; i < len && d < dEnd; i++)
+			{
+				uint16 c = Data[i*2] | (Data[i*2+1] << 8);
+				if (c & 0xFF00) c = '$';
+				*d++ = (char)c;
+			}
+			Data += len * 2;
+		}
+		*d = 0;
+	}
+
+	void ReadEntry(FPakEntry& P, int PakVer)
+	{
+		// the same as operator<<(FArchive&, FPakEntry&)
+		const byte* Start = Data;
+
+		P.Pos = ReadInt64();
+		P.Size = ReadInt64();
+		P.UncompressedSize = ReadInt64();
+		P.CompressionMethod = ReadInt();
+
+		if (PakVer < PAK_NO_TIMESTAMPS)
+			Data += sizeof(int64);			// timestamp
+
+		Read(ARRAY_ARG(P.Hash));
+
+		if (PakVer >= PAK_COMPRESSION_ENCRYPTION)
+		{
+			if (P.CompressionMethod != 0)
+			{
+				int NumBlocks = ReadInt();
+				if (NumBlocks < 0 || Data + NumBlocks * sizeof(FPakCompressedBlock) > End)
+					appError("Pak index is truncated");
+				P.CompressionBlocks.Empty(NumBlocks);
+				P.CompressionBlocks.AddUninitialized(NumBlocks);
+				Read(P.CompressionBlocks.GetData(), NumBlocks * sizeof(FPakCompressedBlock));
+			}
+			Read(&P.bEncrypted, 1);
+			P.CompressionBlockSize = ReadInt();
+			if (P.bEncrypted) appError("Encrypted PAKs are not supported");
+		}
+
+		P.StructSize = Data - Start;
+	}
+};
+
+class FPakFile : public FVirtualFileReader
+{
+	DECLARE_ARCHIVE(FPakFile, FVirtualFileReader);
 public:
 	FPakFile(const FPakEntry* info, FArchive* reader)
-	:	Info(info)
-	,	Reader(reader)
+	:	FVirtualFileReader(reader)
+	,	Info(info)
 	,	UncompressedBuffer(NULL)
 	{}
 
@@ -117,6 +218,7 @@ public:
 	virtual void Serialize(void *data, int size)
 	{
 		guard(FPakFile::Serialize);
+		ArPos += ReleaseWindow();
 		if (ArStopper > 0 && ArPos + size > ArStopper)
 			appError("Serializing behind stopper (%X+%X > %X)", ArPos, size, ArStopper);
 
@@ -141,8 +243,7 @@ public:
 					int CompressedBlockSize = (int)(Block.CompressedEnd - Block.CompressedStart);
 					int UncompressedBlockSize = min((int)Info->CompressionBlockSize, (int)Info->UncompressedSize - UncompressedBufferPos); // don't pass file end
 					byte* CompressedData = (byte*)appMalloc(CompressedBlockSize);
-					Reader->Seek64(Block.CompressedStart);
-					Reader->Serialize(CompressedData, CompressedBlockSize);
+					Reader->ReadAt(Block.CompressedStart, CompressedData, CompressedBlockSize);
 					appDecompress(CompressedData, CompressedBlockSize, UncompressedBuffer, UncompressedBlockSize, Info->CompressionMethod);
 					appFree(CompressedData);
 				}
@@ -162,17 +263,18 @@ public:
 				data  = OffsetPointer(data, BytesToCopy);
 			}
 
+			// remaining decompressed data could be read without Serialize() call
+			int BufferEnd = min(UncompressedBufferPos + (int)Info->CompressionBlockSize, (int)Info->UncompressedSize);
+			if (UncompressedBuffer && ArPos >= UncompressedBufferPos && ArPos < BufferEnd)
+				SetWindow(UncompressedBuffer + ArPos - UncompressedBufferPos, BufferEnd - ArPos, ArPos);
+
 			unguard;
 		}
 		else
 		{
 			guard(SerializeUncompressed);
 
-			// seek every time in a case if the same 'Reader' was used by different FPakFile
-			// (this is a lightweight operation for buffered FArchive)
-			Reader->Seek64(Info->Pos + Info->StructSize + ArPos);
-			Reader->Serialize(data, size);
-			ArPos += size;
+			ReadBuffered(Info->Pos + Info->StructSize, (int)Info->UncompressedSize, data, size);
 
 			unguard;
 		}
@@ -183,6 +285,7 @@ public:
 	{
 		guard(FPakFile::Seek);
 		assert(Pos >= 0 && Pos < Info->UncompressedSize);
+		ReleaseWindow();
 		ArPos = Pos;
 		unguard;
 	}
@@ -194,7 +297,6 @@ public:
 
 protected:
 	const FPakEntry* Info;
-	FArchive*	Reader;
 	byte*		UncompressedBuffer;
 	int			UncompressedBufferPos;
 };
@@ -204,14 +306,16 @@ class FPakVFS : public FVirtualFileSystem
 {
 public:
 	FPakVFS(const char* InFilename)
-	:	LastInfo(NULL)
-	,	Reader(NULL)
+	:	Reader(NULL)
 	,	Filename(InFilename)
+	,	HashTable(NULL)
+	,	HashSize(0)
 	{}
 
 	virtual ~FPakVFS()
 	{
 		delete Reader;
+		if (HashTable) appFree(HashTable);
 	}
 
 	virtual bool AttachReader(FArchive* reader)
@@ -232,10 +336,23 @@ public:
 
 		Reader->ArLicenseeVer = info.Version;
 
+		if (info.IndexSize <= 0 || info.IndexSize >= (256<<20) || info.IndexOffset + info.IndexSize > Reader->GetFileSize64())
+			appError("Pak \"%s\" has wrong index size %X", *Filename, (int)info.IndexSize);
+
+		// load the whole index into memory
+		int IndexSize = (int)info.IndexSize;
+		byte* IndexData = (byte*)appMalloc(IndexSize);
 		Reader->Seek64(info.IndexOffset);
+		Reader->Serialize(IndexData, IndexSize);
+		FPakIndexReader Index(IndexData, IndexSize);
 
 		FStaticString<256> MountPoint;
-		*Reader << MountPoint;
+		{
+			char Buffer[512];
+			Buffer[0] = 0;
+			Index.ReadString(ARRAY_ARG(Buffer));
+			MountPoint = Buffer;
+		}
 
 		// Process MountPoint
 		if (!MountPoint.RemoveFromStart("../../.."))
@@ -249,24 +366,33 @@ public:
 			MountPoint = "Root/";
 		}
 
-		int count;
-		*Reader << count;
+		int count = Index.ReadInt();
+		if (count < 0 || count > IndexSize)
+			appError("Pak \"%s\" has wrong file count %d", *Filename, count);
 		FileInfos.AddZeroed(count);
 
+		// prepare hash table, use power of 2 size which is not less than file count
+		for (HashSize = 256; HashSize < count; HashSize <<= 1)
+		{}
+		HashTable = (FPakEntry**)appMalloc(HashSize * sizeof(FPakEntry*));
+
 		for (int i = 0; i < count; i++)
 		{
 			FPakEntry& E = FileInfos[i];
-			// serialize name, combine with MountPoint
-			FStaticString<512> Filename;
-			*Reader << Filename;
-			FStaticString<512> CombinedPath;
-			CombinedPath = MountPoint;
-			CombinedPath += Filename;
-			E.Name = appStrdupPool(*CombinedPath);
-			// serialize other fields
-			*Reader << E;
+			// read name, combine with MountPoint
+			char CombinedPath[1024];
+			appStrncpyz(CombinedPath, *MountPoint, ARRAY_COUNT(CombinedPath));
+			Index.ReadString(ARRAY_ARG(CombinedPath));
+			E.Name = appStrdupPool(CombinedPath);
+			// read other fields
+			Index.ReadEntry(E, info.Version);
+			// add to hash
+			int hash = appStrHashNoCase(E.Name) & (HashSize - 1);
+			E.HashNext = HashTable[hash];
+			HashTable[hash] = &E;
 		}
 
+		appFree(IndexData);
 		return true;
 
 		unguard;
@@ -286,9 +412,7 @@ public:
 
 	virtual const char* FileName(int i)
 	{
-		FPakEntry* info = &FileInfos[i];
-		LastInfo = info;
-		return info->Name;
+		return FileInfos[i].Name;
 	}
 
 	virtual FArchive* CreateReader(const char* name)
@@ -302,21 +426,16 @@ protected:
 	FString				Filename;
 	FArchive*			Reader;
 	TArray<FPakEntry>	FileInfos;
-	FPakEntry*			LastInfo;			// cached last accessed file info, simple optimization
+	FPakEntry**			HashTable;			// [HashSize], chains are linked with FPakEntry::HashNext
+	int					HashSize;
 
 	const FPakEntry* FindFile(const char* name)
 	{
-		if (LastInfo && !stricmp(LastInfo->Name, name))
-			return LastInfo;
-
-		for (int i = 0; i < FileInfos.Num(); i++)
+		if (!HashTable) return NULL;
+		for (const FPakEntry* info = HashTable[appStrHashNoCase(name) & (HashSize - 1)]; info; info = info->HashNext)
 		{
-			FPakEntry* info = &FileInfos[i];
 			if (!stricmp(info->Name, name))
-			{
-				LastInfo = info;
 				return info;
-			}
 		}
 		return NULL;
 	}
@@ -1,5 +1,6 @@
 #include "Core.h"
 #include "UnCore.h"
+#include "Parallel.h"
 
 
 int  GForceGame           = GAME_UNKNOWN;
@@ -324,16 +325,28 @@ bool FString::RemoveFromEnd(const char* Text)
 -----------------------------------------------------------------------------*/
 
 #define STRING_HASH_SIZE		16384
+#define STRING_POOL_SHARDS		64		// should be power of 2
 
 struct CStringPoolEntry
 {
 	CStringPoolEntry*	HashNext;
 	int					Length;
+	int					NameId;			// shared by strings which differ only by case
 	char				Str[1];
 };
 
+// Hash is case-insensitive, so strings which differ only by case are placed into the same
+// chain and could share the name ID. Hash chains are split between several locks and memory
+// pools, so name tables of packages loaded in different threads are filled in parallel.
+struct CStringPoolShard
+{
+	CMutex				Lock;
+	CMemoryChain*		Pool;
+};
+
 static CStringPoolEntry* StringHashTable[STRING_HASH_SIZE];
-static CMemoryChain* StringPool;
+static CStringPoolShard StringPoolShards[STRING_POOL_SHARDS];
+static volatile int NumNameIds = 1;		// ID 0 is reserved for "None"
 
 const char* appStrdupPool(const char* str)
 {
@@ -341,7 +354,7 @@ const char* appStrdupPool(const char* str)
 	int hash = 0;
 	for (int i = 0; i < len; i++)
 	{
-		char c = str[i];
+		char c = tolower((byte)str[i]);
 #if 0
 		hash = (hash + c) ^ 0xABCDEF;
 #else
@@ -350,24 +363,39 @@ const char* appStrdupPool(const char* str)
 	}
 	hash &= (STRING_HASH_SIZE - 1);
 
+	CStringPoolShard& Shard = StringPoolShards[hash & (STRING_POOL_SHARDS - 1)];
+	CScopedLock Lock(Shard.Lock);
+	int NameId = -1;
 	for (const CStringPoolEntry* s = StringHashTable[hash]; s; s = s->HashNext)
 	{
-		if (s->Length == len && !strcmp(str, s->Str))		// found a string
+		if (s->Length != len) continue;
+		if (!strcmp(str, s->Str))							// found a string
 			return s->Str;
+		if (NameId < 0 && !stricmp(str, s->Str))			// found the same name in different case
+			NameId = s->NameId;
 	}
+	if (NameId < 0)
+		NameId = stricmp(str, "None") ? appInterlockedAdd(&NumNameIds, 1) - 1 : 0;
 
-	if (!StringPool) StringPool = new CMemoryChain();
+	if (!Shard.Pool) Shard.Pool = new CMemoryChain();
 
 	// allocate new string from pool
-	CStringPoolEntry* n = (CStringPoolEntry*)StringPool->Alloc(sizeof(CStringPoolEntry) + len);	// note: null byte is taken into account in CStringPoolEntry
+	CStringPoolEntry* n = (CStringPoolEntry*)Shard.Pool->Alloc(sizeof(CStringPoolEntry) + len);	// note: null byte is taken into account in CStringPoolEntry
 	n->HashNext = StringHashTable[hash];
-	StringHashTable[hash] = n;
 	n->Length = len;
+	n->NameId = NameId;
 	memcpy(n->Str, str, len+1);
+	StringHashTable[hash] = n;
 
 	return n->Str;
 }
 
+int appGetNameId(const char* PooledStr)
+{
+	const CStringPoolEntry* s = (const CStringPoolEntry*)(PooledStr - offsetof(CStringPoolEntry, Str));
+	return s->NameId;
+}
+
 #if 0
 void PrintStringHashDistribution()
 {
@@ -93,6 +93,8 @@ struct CGameFileInfo
 	const char *ShortFilename;						// without path, points to filename part of RelativeName
 	const char *Extension;							// points to extension part (excluding '.') of RelativeName
 	CGameFileInfo* HashNext;						// used for fast search; computed from ShortFilename excluding extension
+	CGameFileInfo* FolderNext;						// next file in the same directory
+	CGameFileInfo* ExtNext;							// next file with the same extension
 	bool		IsPackage;
 	bool		PackageScanned;
 	int			SizeInKb;							// file size, in kilobytes
@@ -112,8 +114,9 @@ extern int GNumForeignFiles;
 // Filename can contain extension, but should not contain path.
 // This function is quite fast because it uses hash tables.
 const CGameFileInfo *appFindGameFile(const char *Filename, const char *Ext = NULL);
-// This function allows wildcard use in Filename. When wildcard is used, it iterates over all
-// found files and could be relatively slow.
+// This function allows wildcard use in Filename. When wildcard begins with a path, only the
+// directory subtree is checked, otherwise it iterates over all files with the wildcard's
+// extension, or over all packages.
 void appFindGameFiles(const char *Filename, TArray<const CGameFileInfo*>& Files);
 
 const char *appSkipRootDir(const char *Filename);
@@ -148,7 +151,11 @@ extern const char *GStartupPackage;
 	FName class
 -----------------------------------------------------------------------------*/
 
+// Global name table. Returns a copy of the string which lives until the end of the program;
+// the same strings are returned as the same pointers.
 const char* appStrdupPool(const char* str);
+// Dense case-insensitive ID of the string returned by appStrdupPool(). "None" has ID 0.
+int appGetNameId(const char* PooledStr);
 
 class FName
 {
@@ -157,14 +164,16 @@ public:
 #if UNREAL3 || UNREAL4
 	int			ExtraIndex;
 #endif
+	int			NameId;				// appGetNameId(Str)
 	const char	*Str;
 
 	FName()
 	:	Index(0)
-	,	Str("None")
 #if UNREAL3 || UNREAL4
 	,	ExtraIndex(0)
 #endif
+	,	NameId(0)
+	,	Str("None")
 	{}
 
 	inline FName& operator=(const FName &Other)
@@ -173,6 +182,7 @@ public:
 #if UNREAL3 || UNREAL4
 		ExtraIndex = Other.ExtraIndex;
 #endif // UNREAL3
+		NameId = Other.NameId;
 		Str = Other.Str;
 		return *this;
 	}
@@ -180,6 +190,7 @@ public:
 	inline FName& operator=(const char* String)
 	{
 		Str = appStrdupPool(String);
+		NameId = appGetNameId(Str);
 		Index = 0;
 #if UNREAL3 || UNREAL4
 		ExtraIndex = 0;
@@ -187,10 +198,10 @@ public:
 		return *this;
 	}
 
+	// Names are case-insensitive, strings of names which are equal could differ by case
 	inline bool operator==(const FName& Other) const
 	{
-		// we're using appStrdupPool for FName strings, so perhaps comparison of pointers is enough here
-		return (Str == Other.Str) || (stricmp(Str, Other.Str) == 0);
+		return NameId == Other.NameId;
 	}
 
 	inline bool operator==(const char* String) const
@@ -383,6 +394,15 @@ enum EPlatform
 };
 
 
+// Contiguous window over archive data which is already in memory, see FArchive::SetWindow()
+struct FArchiveWindow
+{
+	const byte	*Start;			// data at the archive position where window was set up
+	const byte	*Ptr;			// data at the current archive position
+	const byte	*End;
+};
+
+
 class FArchive
 {
 public:
@@ -395,20 +415,26 @@ protected:
 	int		ArPos;
 	int		ArStopper;
 
+	FArchiveWindow	OwnWindow;
+	FArchiveWindow	*Window;	// points to OwnWindow or to window of the wrapped archive
+
 public:
 	// game-specific flags
 	int		Game;				// EGame
 	int		Platform;			// EPlatform
 
 	FArchive()
-	:	ArPos(0)
-	,	ArStopper(0)
-	,	ArVer(100000)			//?? something large
+	:	ArVer(100000)			//?? something large
 	,	ArLicenseeVer(0)
 	,	ReverseBytes(false)
+	,	ArPos(0)
+	,	ArStopper(0)
+	,	Window(&OwnWindow)
 	,	Game(GAME_UNKNOWN)
 	,	Platform(PLATFORM_PC)
-	{}
+	{
+		OwnWindow.Start = OwnWindow.Ptr = OwnWindow.End = NULL;
+	}
 
 	virtual ~FArchive()
 	{}
@@ -450,7 +476,7 @@ public:
 
 	virtual int Tell() const
 	{
-		return ArPos;
+		return ArPos + WindowConsumed();
 	}
 
 	virtual int GetFileSize() const
@@ -488,6 +514,41 @@ public:
 	virtual void Serialize(void *data, int size) = 0;
 	void ByteOrderSerialize(void *data, int size);
 
+	// Inline versions of Serialize() and ByteOrderSerialize(), used for simple types. When
+	// the archive has a memory window with enough data, data is copied directly from memory,
+	// otherwise virtual Serialize() is called.
+	FORCEINLINE void FastSerialize(void *data, int size)
+	{
+		FArchiveWindow &W = *Window;
+		if (W.End - W.Ptr >= size)
+		{
+			memcpy(data, W.Ptr, size);
+			W.Ptr += size;
+			return;
+		}
+		Serialize(data, size);
+	}
+
+	FORCEINLINE void FastByteOrderSerialize(void *data, int size)
+	{
+		if (!ReverseBytes)
+			FastSerialize(data, size);
+		else
+			ByteOrderSerialize(data, size);
+	}
+
+	// Positional read: read data at Pos without changing archive position. Archives which
+	// are shared between files of a VFS container should implement it without a shared
+	// cursor, so it could be called from different threads. Default implementation uses
+	// Seek64() and Serialize(), so it is not thread-safe.
+	virtual void ReadAt(int64 Pos, void *data, int size)
+	{
+		int64 OldPos = Tell64();
+		Seek64(Pos);
+		Serialize(data, size);
+		Seek64(OldPos);
+	}
+
 	// "Stopper" is used to check for overrun serialization.
 	// Note: there's no 64-bit "stopper" - large files are used only as containers for smaller
 	// files, so stopper validation is performed on upper level, with 32-bit values.
@@ -495,6 +556,14 @@ public:
 	virtual void SetStopper(int Pos)
 	{
 		ArStopper = Pos;
+		// window shouldn't cross the stopper; when stopper is moved forward, the window
+		// will be extended with the next Serialize() call
+		if (ArStopper > 0 && OwnWindow.Ptr < OwnWindow.End)
+		{
+			int Avail = max(ArStopper - Tell(), 0);
+			if (OwnWindow.End - OwnWindow.Ptr > Avail)
+				OwnWindow.End = OwnWindow.Ptr + Avail;
+		}
 	}
 
 	virtual int GetStopper() const
@@ -562,6 +631,41 @@ public:
 		else
 			return NULL;
 	}
+
+protected:
+	// Memory window support. Archive which has data in memory exposes it with SetWindow(),
+	// Data should point to the data at the current position Pos, window is limited by
+	// the stopper. Reads from the window are performed without any virtual calls, so the
+	// archive should account bytes consumed from the window in all its functions: use
+	// WindowConsumed() for position queries, and ReleaseWindow() before changing position
+	// or buffers.
+	void SetWindow(const void *Data, int Size, int64 Pos)
+	{
+		if (ArStopper > 0 && Pos + Size > ArStopper)
+			Size = max((int)(ArStopper - Pos), 0);
+		OwnWindow.Start = OwnWindow.Ptr = (const byte*)Data;
+		OwnWindow.End = OwnWindow.Start + Size;
+	}
+
+	// Drop the window, returns number of bytes consumed from it
+	int ReleaseWindow()
+	{
+		int Consumed = WindowConsumed();
+		OwnWindow.Start = OwnWindow.Ptr = OwnWindow.End = NULL;
+		return Consumed;
+	}
+
+	int WindowConsumed() const
+	{
+		return (int)(OwnWindow.Ptr - OwnWindow.Start);
+	}
+
+	// Used by archives which forward all calls to the other archive: operator<< will read
+	// data directly from the window of that archive
+	void ShareWindow(FArchive *Other)
+	{
+		Window = Other->Window;
+	}
 };
 
 #define DECLARE_ARCHIVE(Class,Base)		\
@@ -587,53 +691,53 @@ private:
 FORCEINLINE FArchive& operator<<(FArchive &Ar, bool &B)
 {
 	int32 b32 = B;
-	Ar.Serialize(&b32, 4);
+	Ar.FastSerialize(&b32, 4);
 	if (Ar.IsLoading) B = (b32 != 0);
 	return Ar;
 }
 FORCEINLINE FArchive& operator<<(FArchive &Ar, char &B) // int8
 {
-	Ar.Serialize(&B, 1);
+	Ar.FastSerialize(&B, 1);
 	return Ar;
 }
 FORCEINLINE FArchive& operator<<(FArchive &Ar, byte &B) // uint8
 {
-	Ar.Serialize(&B, 1);
+	Ar.FastSerialize(&B, 1);
 	return Ar;
 }
 FORCEINLINE FArchive& operator<<(FArchive &Ar, int16 &B)
 {
-	Ar.ByteOrderSerialize(&B, 2);
+	Ar.FastByteOrderSerialize(&B, 2);
 	return Ar;
 }
 FORCEINLINE FArchive& operator<<(FArchive &Ar, uint16 &B)
 {
-	Ar.ByteOrderSerialize(&B, 2);
+	Ar.FastByteOrderSerialize(&B, 2);
 	return Ar;
 }
 FORCEINLINE FArchive& operator<<(FArchive &Ar, int32 &B)
 {
-	Ar.ByteOrderSerialize(&B, 4);
+	Ar.FastByteOrderSerialize(&B, 4);
 	return Ar;
 }
 FORCEINLINE FArchive& operator<<(FArchive &Ar, uint32 &B)
 {
-	Ar.ByteOrderSerialize(&B, 4);
+	Ar.FastByteOrderSerialize(&B, 4);
 	return Ar;
 }
 FORCEINLINE FArchive& operator<<(FArchive &Ar, int64 &B)
 {
-	Ar.ByteOrderSerialize(&B, 8);
+	Ar.FastByteOrderSerialize(&B, 8);
 	return Ar;
 }
 FORCEINLINE FArchive& operator<<(FArchive &Ar, uint64 &B)
 {
-	Ar.ByteOrderSerialize(&B, 8);
+	Ar.FastByteOrderSerialize(&B, 8);
 	return Ar;
 }
 FORCEINLINE FArchive& operator<<(FArchive &Ar, float &B)
 {
-	Ar.ByteOrderSerialize(&B, 4);
+	Ar.FastByteOrderSerialize(&B, 4);
 	return Ar;
 }
 
@@ -699,8 +803,11 @@ public:
 	virtual ~FFileReader();
 
 	virtual void Serialize(void *data, int size);
+	virtual void ReadAt(int64 Pos, void *data, int size);
 	virtual bool Open();
 	virtual int64 GetFileSize64() const;
+
+	friend class FFileWriter;
 };
 
 
@@ -716,8 +823,15 @@ public:
 	virtual void Close();
 	virtual int64 GetFileSize64() const;
 
+	// Copy Size bytes from Pos of Src file to the current position. When possible, data is
+	// copied by the system without passing it through process memory.
+	void CopyFrom(FFileReader &Src, int64 Pos, int64 Size);
+
 	static void CleanupOnError();
 
+	// Total size of closed files, used for statistics
+	static int64 TotalBytesWritten;
+
 protected:
 	void FlushBuffer();
 };
@@ -788,30 +902,35 @@ public:
 	{
 		IsLoading = true;
 		ArStopper = size;
+		SetWindow(DataPtr, DataSize, 0);
 	}
 
 	virtual void Seek(int Pos)
 	{
 		guard(FMemReader::Seek);
 		assert(Pos >= 0 && Pos <= DataSize);
+		ReleaseWindow();
 		ArPos = Pos;
+		SetWindow(DataPtr + ArPos, DataSize - ArPos, ArPos);
 		unguard;
 	}
 
 	virtual bool IsEof() const
 	{
-		return ArPos >= DataSize;
+		return Tell() >= DataSize;
 	}
 
 	virtual void Serialize(void *data, int size)
 	{
 		guard(FMemReader::Serialize);
+		ArPos += ReleaseWindow();
 		if (ArStopper > 0 && ArPos + size > ArStopper)
 			appError("Serializing behind stopper (%X+%X > %X)", ArPos, size, ArStopper);
 		if (ArPos + size > DataSize)
 			appError("Serializing behind end of buffer");
 		memcpy(data, DataPtr + ArPos, size);
 		ArPos += size;
+		SetWindow(DataPtr + ArPos, DataSize - ArPos, ArPos);
 		unguard;
 	}
 
@@ -1704,9 +1823,10 @@ inline void Exchange(TArray<T>& A, TArray<T>& B)
 {
 	const int size = sizeof(TArray<T>);
 	byte buffer[size];
-	memcpy(buffer, &A, size);
-	memcpy(&A, &B, size);
-	memcpy(&B, buffer, size);
+	// arrays are relocatable, swap them bitwise
+	memcpy(buffer, (void*)&A, size);
+	memcpy((void*)&A, (void*)&B, size);
+	memcpy((void*)&B, buffer, size);
 }
 
 // Binary-compatible array, but with inline allocation. FArray has helper function
@@ -2104,13 +2224,19 @@ struct FByteBulkData //?? separate FUntypedBulkData
 //	int		SavedElementCount;
 //	int		SavedBulkDataOffsetInFile;
 //	int		SavedBulkDataSizeOnDisk;
-	byte	*BulkData;					// pointer to array data
+	mutable byte *BulkData;				// pointer to array data, use GetData() to load the data on demand
 //	int		LockStatus;
 //	FArchive *AttachedAr;
+	// lazy loading
+	UnPackage *LazyPackage;				// when not NULL, data is loaded from this package by GetData()
+	int64	LazyDataPos;				// position of inline data in LazyPackage, or -1 when data is at BulkDataOffsetInFile
+	mutable int LazyIndex;				// index in the list of loaded lazy bulks, used for memory budget
 
 	FByteBulkData()
 	:	BulkData(NULL)
 	,	BulkDataOffsetInFile(0)
+	,	LazyPackage(NULL)
+	,	LazyIndex(INDEX_NONE)
 	{}
 
 	virtual ~FByteBulkData()
@@ -2123,12 +2249,29 @@ struct FByteBulkData //?? separate FUntypedBulkData
 		return 1;
 	}
 
-	void ReleaseData()
+	// Returns pointer to the data. Data which was skipped during serialization is loaded here.
+	// Returns NULL when bulk has no data.
+	byte* GetData() const
+	{
+		if (!BulkData && LazyPackage) LoadLazyData();
+		return BulkData;
+	}
+
+	// Returns true when released data could be loaded again with GetData()
+	bool CanReloadData() const
 	{
-		if (BulkData) appFree(BulkData);
-		BulkData = NULL;
+		return LazyPackage != NULL;
 	}
 
+	void ReleaseData() const;
+
+	// Read a part of data. When data is not loaded, it is read from the package, and the
+	// whole data is not loaded.
+	void ReadData(int Offset, void *Buffer, int Size) const;
+	// Write a part of data to Ar. When data is not loaded, it is copied from the package
+	// file by small blocks, so large payloads are never placed in memory.
+	void WriteData(FArchive &Ar, int Offset, int Size) const;
+
 	// support functions
 	void SerializeHeader(FArchive &Ar);
 	void SerializeData(FArchive &Ar);
@@ -2136,10 +2279,25 @@ struct FByteBulkData //?? separate FUntypedBulkData
 	void Serialize(FArchive &Ar);
 	void Skip(FArchive &Ar);
 
+	// Memory budget for lazily loaded data. Data is not released immediately when budget is
+	// exceeded: TrimMemory() should be called at points where nobody holds pointers to bulk
+	// data. Threads which access bulk data asynchronously should wrap this access with
+	// PinMemory()/UnpinMemory() calls, TrimMemory() does nothing while memory is pinned.
+	static void TrimMemory();
+	static void PinMemory();
+	static void UnpinMemory();
+
 protected:
 	void SerializeDataChunk(FArchive &Ar);
+	bool SetupLazyLoading(FArchive &Ar, int64 DataPos);
+	void LoadLazyData() const;
+	bool CanStreamData() const;
+	void StreamData(int Offset, int Size, void *Buffer, FArchive *Writer) const;
 };
 
+// Memory limit for data loaded with FByteBulkData::GetData(), in megabytes; 0 = unlimited
+extern int GMaxBulkDataMemory;
+
 struct FWordBulkData : public FByteBulkData
 {
 	virtual int GetElementSize() const
@@ -1,16 +1,24 @@
 #include "Core.h"
 #include "UnCore.h"
 
-#if UNREAL4
-#include "UnPackage.h"			// for accessing FPackageFileSummary from FByteBulkData
+#if UNREAL3
+#include "UnPackage.h"			// for accessing FPackageFileSummary and package reader from FByteBulkData
 #endif
+#include "Parallel.h"			// for CMutex
 
 #if _WIN32
 #include <io.h>					// for _filelengthi64
+#else
+#include <unistd.h>				// for pread
+#endif
+
+#if __linux__
+#include <sys/sendfile.h>
 #endif
 
 
 #define FILE_BUFFER_SIZE		4096
+#define COPY_BUFFER_SIZE		65536		// buffer for copying data between files
 
 
 //#define DEBUG_BULK			1
@@ -513,24 +521,26 @@ FFileArchive::~FFileArchive()
 
 void FFileArchive::Seek(int Pos)
 {
+	ReleaseWindow();
 	ArPos64 = Pos;
 }
 
 void FFileArchive::Seek64(int64 Pos)
 {
+	ReleaseWindow();
 	ArPos64 = Pos;
 }
 
 int FFileArchive::Tell() const
 {
 	guard(FFileArchive::Tell());
-	return (int)ArPos64;
+	return (int)(ArPos64 + WindowConsumed());
 	unguard;
 }
 
 int64 FFileArchive::Tell64() const
 {
-	return ArPos64;
+	return ArPos64 + WindowConsumed();
 }
 
 int FFileArchive::GetFileSize() const
@@ -542,7 +552,7 @@ int FFileArchive::GetFileSize() const
 
 bool FFileArchive::IsEof() const
 {
-	return ArPos64 >= GetFileSize64();
+	return Tell64() >= GetFileSize64();
 }
 
 // this function is useful only for FRO_NoOpenError mode
@@ -555,6 +565,7 @@ void FFileArchive::Close()
 {
 	if (IsOpen())
 	{
+		ArPos64 += ReleaseWindow();
 		fclose(f);
 		f = NULL;
 		appFree(Buffer);
@@ -599,6 +610,7 @@ void FFileReader::Serialize(void *data, int size)
 {
 	guard(FFileReader::Serialize);
 
+	ArPos64 += ReleaseWindow();
 	if (ArStopper > 0 && ArPos64 + size > ArStopper)
 		appError("Serializing behind stopper (%llX+%X > %X)", ArPos64, size, ArStopper);
 
@@ -657,6 +669,54 @@ void FFileReader::Serialize(void *data, int size)
 		ArPos64 += CanCopy;
 	}
 
+	// remaining buffered data could be read without Serialize() call
+	int64 LocalPos64 = ArPos64 - BufferPos;
+	if (LocalPos64 >= 0 && LocalPos64 < BufferSize)
+		SetWindow(Buffer + LocalPos64, BufferSize - (int)LocalPos64, ArPos64);
+
+	unguardf("File=%s", ShortName);
+}
+
+#if _WIN32
+static CMutex ReadAtLock;
+#endif
+
+void FFileReader::ReadAt(int64 Pos, void *data, int size)
+{
+	guard(FFileReader::ReadAt);
+
+	assert(IsOpen());
+#if PROFILE
+	// note: not atomic, but this is just statistics
+	GNumSerialize++;
+	GSerializeBytes += size;
+#endif
+
+#if _WIN32
+	// there's no pread() in msvcrt, use file descriptor with locking
+	{
+		CScopedLock Lock(ReadAtLock);
+		int fd = fileno(f);
+		if (_lseeki64(fd, Pos, SEEK_SET) == -1)
+			appError("Error seeking to position 0x%llX", Pos);
+		if (_read(fd, data, size) != size)
+			appError("Unable to read %d bytes at pos=0x%llX", size, Pos);
+		// file position was changed, so Serialize() should seek 'f' before reading
+		FilePos = -1;
+	}
+#else
+	int fd = fileno(f);
+	while (size > 0)
+	{
+		ssize_t ReadBytes = pread(fd, data, size, Pos);
+		if (ReadBytes <= 0)
+			appError("Unable to read %d bytes at pos=0x%llX", size, Pos);
+		data = OffsetPointer(data, (int)ReadBytes);
+		Pos  += ReadBytes;
+		size -= (int)ReadBytes;
+	}
+#endif // _WIN32
+
 	unguardf("File=%s", ShortName);
 }
 
@@ -686,6 +746,8 @@ int64 FFileReader::GetFileSize64() const
 
 static TArray<FFileWriter*> GFileWriters;
 
+int64 FFileWriter::TotalBytesWritten = 0;
+
 FFileWriter::FFileWriter(const char *Filename, unsigned Options)
 :	FFileArchive(Filename, Options)
 {
@@ -785,6 +847,7 @@ bool FFileWriter::Open()
 
 void FFileWriter::Close()
 {
+	if (IsOpen()) TotalBytesWritten += GetFileSize64();
 	FlushBuffer();
 	Super::Close();
 }
@@ -818,6 +881,55 @@ int64 FFileWriter::GetFileSize64() const
 }
 
 
+void FFileWriter::CopyFrom(FFileReader &Src, int64 Pos, int64 Size)
+{
+	guard(FFileWriter::CopyFrom);
+
+	assert(Src.IsOpen());
+#if __linux__
+	// copy data with sendfile(), it doesn't change position of the source file
+	FlushBuffer();
+	fflush(f);
+	if (fseeko64(f, ArPos64, SEEK_SET) != 0)
+		appError("Error seeking to position 0x%llX", ArPos64);
+	int OutFd = fileno(f);
+	int InFd  = fileno(Src.f);
+	off64_t Offset = Pos;
+	while (Size > 0)
+	{
+		ssize_t Copied = sendfile64(OutFd, InFd, &Offset, (size_t)min(Size, (int64)(1 << 30)));
+		if (Copied <= 0) break;				// not supported for these files, or error; try regular copying
+		Size    -= Copied;
+		ArPos64 += Copied;
+	}
+	// sendfile() has changed file position, sync FILE with it
+	if (fseeko64(f, ArPos64, SEEK_SET) != 0)
+		appError("Error seeking to position 0x%llX", ArPos64);
+	FilePos = BufferPos = ArPos64;
+	if (FilePos > FileSize) FileSize = FilePos;
+	Pos = Offset;
+#endif // __linux__
+
+	// copy with a small buffer
+	if (Size > 0)
+	{
+		int BufferSize = (int)min(Size, (int64)COPY_BUFFER_SIZE);
+		byte *CopyBuffer = (byte*)appMalloc(BufferSize);
+		while (Size > 0)
+		{
+			int Count = (int)min(Size, (int64)BufferSize);
+			Src.ReadAt(Pos, CopyBuffer, Count);
+			Serialize(CopyBuffer, Count);
+			Pos  += Count;
+			Size -= Count;
+		}
+		appFree(CopyBuffer);
+	}
+
+	unguard;
+}
+
+
 /*-----------------------------------------------------------------------------
 	Dummy archive class
 -----------------------------------------------------------------------------*/
@@ -1093,10 +1205,46 @@ header_done: ;
 }
 
 
+// Try to skip data and load it later with GetData(). DataPos is position of inline data in the
+// archive, or -1 when data is stored at BulkDataOffsetInFile. Returns false when data should be
+// serialized immediately.
+bool FByteBulkData::SetupLazyLoading(FArchive &Ar, int64 DataPos)
+{
+	// could load data only from package, the other archives (memory readers etc) may not exist
+	// at the time of GetData() call
+	UnPackage *Package = Ar.CastTo<UnPackage>();
+	if (!Package) return false;
+
+	int DataSize = ElementCount * GetElementSize();
+	if (DataPos >= 0)
+	{
+		// inline data: should know its size on disk to skip it, so compressed data is loaded now
+		if (BulkDataFlags & (BULKDATA_CompressedLzo | BULKDATA_CompressedZlib | BULKDATA_CompressedLzx))
+			return false;
+#if BLADENSOUL
+		if (Ar.Game == GAME_BladeNSoul && (BulkDataFlags & BULKDATA_CompressedLzoEncr))
+			return false;
+#endif
+		Ar.Seek64(DataPos + DataSize);
+	}
+	if (DataSize <= 0) return true;		// nothing to load
+
+	LazyPackage = Package;
+	LazyDataPos = DataPos;
+#if DEBUG_BULK
+	appPrintf("lazy bulk (flags=%X, pos=%llX+%X)\n", BulkDataFlags, (DataPos >= 0) ? DataPos : BulkDataOffsetInFile, DataSize);
+#endif
+	return true;
+}
+
+
 void FByteBulkData::Serialize(FArchive &Ar)
 {
 	guard(FByteBulkData::Serialize);
 
+	ReleaseData();
+	LazyPackage = NULL;
+
 	SerializeHeader(Ar);
 
 	if (BulkDataFlags & BULKDATA_Unused)	// skip serializing
@@ -1122,6 +1270,7 @@ void FByteBulkData::Serialize(FArchive &Ar)
 		if (BulkDataFlags & BULKDATA_PayloadAtEndOfFile)
 		{
 			// stored in the same file, but at different position
+			if (SetupLazyLoading(Ar, -1)) return;
 			// save archive position
 			int savePos, saveStopper;
 			savePos     = Ar.Tell();
@@ -1136,6 +1285,7 @@ void FByteBulkData::Serialize(FArchive &Ar)
 		}
 		if (BulkDataFlags & BULKDATA_ForceInlinePayload)
 		{
+			if (SetupLazyLoading(Ar, Ar.Tell64())) return;
 			SerializeDataChunk(Ar);
 			return;
 		}
@@ -1156,6 +1306,7 @@ void FByteBulkData::Serialize(FArchive &Ar)
 	if (BulkDataFlags & BULKDATA_SeparateData)
 	{
 		// stored in the same file, but at different position
+		if (SetupLazyLoading(Ar, -1)) return;
 		// save archive position
 		int savePos, saveStopper;
 		savePos     = Ar.Tell();
@@ -1178,6 +1329,7 @@ void FByteBulkData::Serialize(FArchive &Ar)
 	if (ElementCount > 0)
 	{
 //		assert(BulkDataOffsetInFile == Ar.Tell());
+		if (SetupLazyLoading(Ar, Ar.Tell64())) return;
 		SerializeData(Ar);
 	}
 
@@ -1237,26 +1389,13 @@ void FByteBulkData::SerializeData(FArchive &Ar)
 		// UE4 compressed packages use uncompressed position for bulk data
 		/// reference: FUntypedBulkData::LoadDataIntoMemory
 
-		// open new FArchive for the current file
+		// read data with the raw file reader shared by all bulk data of the package
 		UnPackage* Package = Ar.CastTo<UnPackage>();
 		assert(Package);
-		//!! should make the following code as separate function
-		const CGameFileInfo* info = appFindGameFile(Package->Filename);
-		FArchive* loader = NULL;
-		if (info)
-		{
-			loader = appCreateFileReader(info);
-			assert(loader);
-		}
-		else
-		{
-			loader = new FFileReader(Package->Filename);
-		}
-		loader->Game = Ar.Game;
-
-		loader->Seek64(BulkDataOffsetInFile);
-		SerializeDataChunk(*loader);
-		delete loader;
+		CScopedLock Lock(Package->ReaderLock);
+		FArchive* Loader = Package->GetPayloadReader();
+		Loader->Seek64(BulkDataOffsetInFile);
+		SerializeDataChunk(*Loader);
 	}
 	else
 #endif // UNREAL4
@@ -1288,8 +1427,7 @@ void FByteBulkData::SerializeDataChunk(FArchive &Ar)
 	guard(FByteBulkData::SerializeDataChunk);
 
 	// allocate array
-	if (BulkData) appFree(BulkData);
-	BulkData = NULL;
+	ReleaseData();
 	int DataSize = ElementCount * GetElementSize();
 	if (!DataSize) return;		// nothing to serialize
 	BulkData = (byte*)appMalloc(DataSize);
@@ -1319,4 +1457,240 @@ void FByteBulkData::SerializeDataChunk(FArchive &Ar)
 }
 
 
+
+/*-----------------------------------------------------------------------------
+	Lazy bulk data loading
+-----------------------------------------------------------------------------*/
+
+int GMaxBulkDataMemory = 256;
+
+static CMutex LoadedBulkLock;
+static TArray<const FByteBulkData*> LoadedBulks;	// lazy bulks with data, in loading order; could contain NULL items
+static size_t LoadedBulkSize = 0;
+static int BulkPinCount = 0;
+
+void FByteBulkData::LoadLazyData() const
+{
+	guard(FByteBulkData::LoadLazyData);
+
+	UnPackage *Package = LazyPackage;
+	// package reader is shared with object loading code
+	CScopedLock Lock(Package->ReaderLock);
+	if (BulkData) return;		// loaded by another thread
+
+	FByteBulkData *Bulk = const_cast<FByteBulkData*>(this);
+	// save archive position
+	int savePos, saveStopper;
+	savePos     = Package->Tell();
+	saveStopper = Package->GetStopper();
+	bool WasOpen = Package->IsOpen();
+	if (!WasOpen) Package->Open();
+	// seek to data block and read data
+	Package->SetStopper(0);
+	if (LazyDataPos >= 0)
+	{
+		Package->Seek64(LazyDataPos);
+		Bulk->SerializeDataChunk(*Package);
+	}
+	else
+	{
+		Bulk->SerializeData(*Package);
+	}
+	// restore archive position
+	Package->Seek(savePos);
+	Package->SetStopper(saveStopper);
+	if (!WasOpen) Package->Close();
+
+	// register data for memory budget
+	if (BulkData)
+	{
+		CScopedLock Lock2(LoadedBulkLock);
+		LazyIndex = LoadedBulks.Add(this);
+		LoadedBulkSize += ElementCount * GetElementSize();
+	}
+
+	unguardf("%s, pos=%llX", LazyPackage->Filename, (LazyDataPos >= 0) ? LazyDataPos : BulkDataOffsetInFile);
+}
+
+void FByteBulkData::ReleaseData() const
+{
+	if (LazyIndex != INDEX_NONE)
+	{
+		CScopedLock Lock(LoadedBulkLock);
+		LoadedBulks[LazyIndex] = NULL;
+		LoadedBulkSize -= ElementCount * GetElementSize();
+		LazyIndex = INDEX_NONE;
+	}
+	if (BulkData) appFree(BulkData);
+	BulkData = NULL;
+}
+
+void FByteBulkData::TrimMemory()
+{
+	guard(FByteBulkData::TrimMemory);
+
+	if (GMaxBulkDataMemory <= 0) return;
+	CScopedLock Lock(LoadedBulkLock);
+	if (BulkPinCount) return;
+
+	size_t MaxSize = (size_t)GMaxBulkDataMemory << 20;
+	if (LoadedBulkSize <= MaxSize) return;
+
+	// release data which was loaded first
+	int i;
+	int NumReleased = 0;
+	for (i = 0; i < LoadedBulks.Num() && LoadedBulkSize > MaxSize; i++)
+	{
+		const FByteBulkData *Bulk = LoadedBulks[i];
+		if (!Bulk) continue;
+		LoadedBulkSize -= Bulk->ElementCount * Bulk->GetElementSize();
+		appFree(Bulk->BulkData);
+		Bulk->BulkData  = NULL;
+		Bulk->LazyIndex = INDEX_NONE;
+		LoadedBulks[i]  = NULL;
+		NumReleased++;
+	}
+	// compact the list
+	int NumLoaded = 0;
+	for (i = 0; i < LoadedBulks.Num(); i++)
+	{
+		const FByteBulkData *Bulk = LoadedBulks[i];
+		if (!Bulk) continue;
+		Bulk->LazyIndex = NumLoaded;
+		LoadedBulks[NumLoaded++] = Bulk;
+	}
+	if (NumLoaded < LoadedBulks.Num())
+		LoadedBulks.RemoveAt(NumLoaded, LoadedBulks.Num() - NumLoaded);
+#if DEBUG_BULK
+	appPrintf("released %d bulks, %d bulks with %d Mb remains\n", NumReleased, NumLoaded, (int)(LoadedBulkSize >> 20));
+#endif
+
+	unguard;
+}
+
+void FByteBulkData::PinMemory()
+{
+	// using lock here, so TrimMemory() which is possibly running now will finish before
+	// the caller will access any data
+	CScopedLock Lock(LoadedBulkLock);
+	BulkPinCount++;
+}
+
+void FByteBulkData::UnpinMemory()
+{
+	CScopedLock Lock(LoadedBulkLock);
+	assert(BulkPinCount > 0);
+	BulkPinCount--;
+}
+
+// Check if not loaded data could be read directly from the package
+bool FByteBulkData::CanStreamData() const
+{
+	if (!LazyPackage) return false;
+	if (BulkDataFlags & (BULKDATA_CompressedLzo | BULKDATA_CompressedZlib | BULKDATA_CompressedLzx))
+		return false;
+#if BLADENSOUL
+	if (LazyPackage->Game == GAME_BladeNSoul && (BulkDataFlags & BULKDATA_CompressedLzoEncr))
+		return false;
+#endif
+	return true;
+}
+
+// Read a part of not loaded data from the package. When Writer is not NULL, data is written
+// to it, otherwise it is placed to Buffer.
+void FByteBulkData::StreamData(int Offset, int Size, void *Buffer, FArchive *Writer) const
+{
+	guard(FByteBulkData::StreamData);
+
+	UnPackage *Package = LazyPackage;
+	CScopedLock Lock(Package->ReaderLock);
+
+	int64 Pos = ((LazyDataPos >= 0) ? LazyDataPos : BulkDataOffsetInFile) + Offset;
+	// save archive position
+	int savePos, saveStopper;
+	savePos     = Package->Tell();
+	saveStopper = Package->GetStopper();
+	bool WasOpen = Package->IsOpen();
+	if (!WasOpen) Package->Open();
+
+	FFileReader *FileReader = Package->Loader->CastTo<FFileReader>();
+	FFileWriter *FileWriter = Writer ? Writer->CastTo<FFileWriter>() : NULL;
+	if (FileReader && FileWriter)
+	{
+		// package is a plain file, copy data from file to file
+		FileWriter->CopyFrom(*FileReader, Pos, Size);
+	}
+	else
+	{
+		// use package reader, it could decrypt data or read it from a pak file
+		FArchive *Src = Package;
+#if UNREAL4
+		// data is outside of compressed package stream
+		if (Package->Game >= GAME_UE4 && LazyDataPos < 0 && Package->IsCompressed())
+			Src = Package->GetPayloadReader();
+#endif
+		Package->SetStopper(0);
+		Src->Seek64(Pos);
+		if (!Writer)
+		{
+			Src->Serialize(Buffer, Size);
+		}
+		else
+		{
+			int BufferSize = min(Size, COPY_BUFFER_SIZE);
+			byte *CopyBuffer = (byte*)appMalloc(BufferSize);
+			while (Size > 0)
+			{
+				int Count = min(Size, BufferSize);
+				Src->Serialize(CopyBuffer, Count);
+				Writer->Serialize(CopyBuffer, Count);
+				Size -= Count;
+			}
+			appFree(CopyBuffer);
+		}
+		// restore archive position
+		Package->Seek(savePos);
+		Package->SetStopper(saveStopper);
+	}
+	if (!WasOpen) Package->Close();
+
+	unguardf("%s, pos=%llX", LazyPackage->Filename, (LazyDataPos >= 0) ? LazyDataPos : BulkDataOffsetInFile);
+}
+
+void FByteBulkData::ReadData(int Offset, void *Buffer, int Size) const
+{
+	guard(FByteBulkData::ReadData);
+
+	assert(Offset >= 0 && Size >= 0 && Offset + Size <= ElementCount * GetElementSize());
+	if (!BulkData && CanStreamData())
+	{
+		StreamData(Offset, Size, Buffer, NULL);
+		return;
+	}
+	const byte *Data = GetData();
+	if (!Data) appError("Bulk data is not available");
+	memcpy(Buffer, Data + Offset, Size);
+
+	unguard;
+}
+
+void FByteBulkData::WriteData(FArchive &Ar, int Offset, int Size) const
+{
+	guard(FByteBulkData::WriteData);
+
+	assert(Offset >= 0 && Size >= 0 && Offset + Size <= ElementCount * GetElementSize());
+	if (!BulkData && CanStreamData())
+	{
+		StreamData(Offset, Size, NULL, &Ar);
+		return;
+	}
+	byte *Data = GetData();
+	if (!Data) appError("Bulk data is not available");
+	Ar.Serialize(Data + Offset, Size);
+
+	unguard;
+}
+
+
+
 #endif // UNREAL3
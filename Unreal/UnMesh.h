@@ -20,6 +20,15 @@ struct FPackedNormal;
 struct CMeshVertex;
 void UnpackNormals(const FPackedNormal SrcNormal[3], CMeshVertex &V);
 
+// Stream versions of conversion functions. Items are placed with SrcStride and DstStride (VertexSize)
+// bytes step, so data could be converted directly between vertex structures. ConvertUVs() could work
+// in place, when Src and Dst are the same.
+struct FMeshUVHalf;
+struct FMeshUVFloat;
+void ConvertUVs(const FMeshUVHalf *Src, int SrcStride, FMeshUVFloat *Dst, int DstStride, int Count);
+void ConvertUVs(const FMeshUVFloat *Src, int SrcStride, FMeshUVFloat *Dst, int DstStride, int Count);
+void UnpackNormals(const FPackedNormal *SrcNormal, int SrcStride, CMeshVertex *Verts, int VertexSize, int Count);
+
 //?? move these declarations outside
 class CSkeletalMesh;
 struct CSkelMeshLod;
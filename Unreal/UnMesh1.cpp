@@ -271,7 +271,7 @@ void UVertMesh::SerializeVertMesh1(FArchive &Ar)
 
 	SerializeLodMesh1(Ar, AnimSeqs, BoundingBoxes, BoundingSpheres, FrameCount);
 	VertexCount = Super::VertexCount;
-	BuildNormals();
+	InitNormals();
 
 	unguard;
 }
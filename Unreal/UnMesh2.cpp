@@ -182,21 +182,31 @@ lod_fields2:
 	UVertMesh class
 -----------------------------------------------------------------------------*/
 
-void UVertMesh::BuildNormals()
+void UVertMesh::InitNormals()
 {
-	// UE1 meshes have no stored normals, should build them
+	// UE1 meshes have no stored normals, should build them. Computing normals for all
+	// frames takes a lot of time for meshes with many frames, so do it on demand.
+	Normals.Empty(Verts.Num());
+	Normals.AddZeroed(Verts.Num());
+	FrameHasNormals.Empty(FrameCount);
+	FrameHasNormals.AddZeroed(FrameCount);
+}
+
+
+void UVertMesh::BuildFrameNormals(int FrameIndex)
+{
+	guard(UVertMesh::BuildFrameNormals);
+
 	// This function is similar to BuildNormals() from SkelMeshInstance.cpp
-	int numVerts = Verts.Num();
+	int base = VertexCount * FrameIndex;
 	int i;
-	Normals.Empty(numVerts);
-	Normals.AddZeroed(numVerts);
 	TArray<CVec3> tmpVerts, tmpNormals;
-	tmpVerts.AddZeroed(numVerts);
-	tmpNormals.AddZeroed(numVerts);
+	tmpVerts.AddZeroed(VertexCount);
+	tmpNormals.AddZeroed(VertexCount);
 	// convert verts
-	for (i = 0; i < numVerts; i++)
+	for (i = 0; i < VertexCount; i++)
 	{
-		const FMeshVert &SV = Verts[i];
+		const FMeshVert &SV = Verts[base + i];
 		CVec3           &DV = tmpVerts[i];
 		DV[0] = SV.X * MeshScale.X;
 		DV[1] = SV.Y * MeshScale.Y;
@@ -210,45 +220,43 @@ void UVertMesh::BuildNormals()
 		int i1 = Wedges[F.iWedge[0]].iVertex;
 		int i2 = Wedges[F.iWedge[2]].iVertex;		// note: reverse order in comparison with SkeletalMesh
 		int i3 = Wedges[F.iWedge[1]].iVertex;
-		// iterate all frames
-		for (int j = 0; j < FrameCount; j++)
-		{
-			int base = VertexCount * j;
-			// compute edges
-			const CVec3 &V1 = tmpVerts[base + i1];
-			const CVec3 &V2 = tmpVerts[base + i2];
-			const CVec3 &V3 = tmpVerts[base + i3];
-			CVec3 D1, D2, D3;
-			VectorSubtract(V2, V1, D1);
-			VectorSubtract(V3, V2, D2);
-			VectorSubtract(V1, V3, D3);
-			// compute normal
-			CVec3 norm;
-			cross(D2, D1, norm);
-			norm.Normalize();
-			// compute angles
-			D1.Normalize();
-			D2.Normalize();
-			D3.Normalize();
-			float angle1 = acos(-dot(D1, D3));
-			float angle2 = acos(-dot(D1, D2));
-			float angle3 = acos(-dot(D2, D3));
-			// add normals for triangle verts
-			VectorMA(tmpNormals[base + i1], angle1, norm);
-			VectorMA(tmpNormals[base + i2], angle2, norm);
-			VectorMA(tmpNormals[base + i3], angle3, norm);
-		}
+		// compute edges
+		const CVec3 &V1 = tmpVerts[i1];
+		const CVec3 &V2 = tmpVerts[i2];
+		const CVec3 &V3 = tmpVerts[i3];
+		CVec3 D1, D2, D3;
+		VectorSubtract(V2, V1, D1);
+		VectorSubtract(V3, V2, D2);
+		VectorSubtract(V1, V3, D3);
+		// compute normal
+		CVec3 norm;
+		cross(D2, D1, norm);
+		norm.Normalize();
+		// compute angles
+		D1.Normalize();
+		D2.Normalize();
+		D3.Normalize();
+		float angle1 = acos(-dot(D1, D3));
+		float angle2 = acos(-dot(D1, D2));
+		float angle3 = acos(-dot(D2, D3));
+		// add normals for triangle verts
+		VectorMA(tmpNormals[i1], angle1, norm);
+		VectorMA(tmpNormals[i2], angle2, norm);
+		VectorMA(tmpNormals[i3], angle3, norm);
 	}
 	// normalize and convert computed normals
-	for (i = 0; i < numVerts; i++)
+	FMeshNorm *DN = &Normals[base];
+	for (i = 0; i < VertexCount; i++, DN++)
 	{
-		CVec3 &SN     = tmpNormals[i];
-		FMeshNorm &DN = Normals[i];
+		CVec3 &SN = tmpNormals[i];
 		SN.Normalize();
-		DN.X = appRound(SN[0] * 511 + 512);
-		DN.Y = appRound(SN[1] * 511 + 512);
-		DN.Z = appRound(SN[2] * 511 + 512);
+		DN->X = appRound(SN[0] * 511 + 512);
+		DN->Y = appRound(SN[1] * 511 + 512);
+		DN->Z = appRound(SN[2] * 511 + 512);
 	}
+	FrameHasNormals[FrameIndex] = true;
+
+	unguardf("frame=%d", FrameIndex);
 }
 
 
@@ -274,6 +282,12 @@ void UVertMesh::Serialize(FArchive &Ar)
 	Ar << VertexCount << FrameCount;
 	Ar << BoundingBoxes << BoundingSpheres;
 
+	if (Normals.Num() != Verts.Num())
+	{
+		// normals are missing or damaged, compute them
+		InitNormals();
+	}
+
 	unguard;
 }
 
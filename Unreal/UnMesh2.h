@@ -528,7 +528,7 @@ class UVertMesh : public ULodMesh
 	DECLARE_CLASS(UVertMesh, ULodMesh);
 public:
 	TArray<FMeshVert>		Verts2;			// empty; used ULodMesh.Verts
-	TArray<FMeshNorm>		Normals;		// [NumFrames * NumVerts]
+	TArray<FMeshNorm>		Normals;		// [NumFrames * NumVerts]; use GetFrameNormals() for access
 	TArray<float>			f150;			// empty?
 	TArray<FMeshAnimSeq>	AnimSeqs;
 	TArray<FBox>			BoundingBoxes;	// [NumFrames]
@@ -538,8 +538,20 @@ public:
 	// FAnimVertexStream fields; used internally in UT, but serialized
 	TArray<FAnimMeshVertex> AnimMeshVerts;	// empty; generated after loading
 	int						StreamVersion;	// unused
-
-	void BuildNormals();
+	// Normals computed on demand
+	TArray<bool>			FrameHasNormals;// [NumFrames]; empty when all normals are available
+
+	// Meshes without stored normals: allocate normals, they will be computed by
+	// GetFrameNormals()
+	void InitNormals();
+	void BuildFrameNormals(int FrameIndex);
+	// Get normals for the animation frame, compute them when needed
+	const FMeshNorm* GetFrameNormals(int FrameIndex) const
+	{
+		if (FrameHasNormals.Num() && !FrameHasNormals[FrameIndex])
+			const_cast<UVertMesh*>(this)->BuildFrameNormals(FrameIndex);
+		return &Normals[VertexCount * FrameIndex];
+	}
 
 	virtual void Serialize(FArchive &Ar);
 #if UNREAL1
@@ -43,15 +43,87 @@ float half2float(uint16 h)
 		unsigned	df;
 	} f;
 
-	int sign = (h >> 15) & 0x00000001;
-	int exp  = (h >> 10) & 0x0000001F;
-	int mant =  h        & 0x000003FF;
+	unsigned sign = (h & 0x8000) << 16;
+	int      exp  = (h >> 10) & 0x0000001F;
+	unsigned mant =  h        & 0x000003FF;
 
-	exp  = exp + (127 - 15);
-	f.df = (sign << 31) | (exp << 23) | (mant << 13);
+	if (exp == 0)
+	{
+		// zero or denormal: value is mant * 2^-24, conversion is exact
+		f.f = mant * (1.0f / 16777216.0f);
+		f.df |= sign;
+	}
+	else if (exp == 31)
+	{
+		// infinity or NaN
+		f.df = sign | 0x7F800000 | (mant << 13);
+	}
+	else
+	{
+		f.df = sign | ((exp + (127 - 15)) << 23) | (mant << 13);
+	}
 	return f.f;
 }
 
+#if USE_SSE
+
+// Convert 4 halfs placed in lower 16 bits of 32-bit integers to floats. Based on "half_to_float_SSE2"
+// by Fabian Giesen: https://gist.github.com/rygorous/2144712. Gives the same results as half2float(),
+// including denormals, infinity and NaN.
+static FORCEINLINE __m128 HalfToFloat4(__m128i h)
+{
+	const __m128i MaskNoSign = _mm_set1_epi32(0x7FFF);
+	const __m128i WasInfNan  = _mm_set1_epi32(0x7BFF);
+	const __m128i ExpInfNan  = _mm_set1_epi32(255 << 23);
+	const __m128  Magic      = _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23));	// 2^112
+
+	__m128i ExpMant  = _mm_and_si128(MaskNoSign, h);
+	__m128  Scaled   = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(ExpMant, 13)), Magic);
+	__m128i IsInfNan = _mm_cmpgt_epi32(ExpMant, WasInfNan);
+	__m128i Sign     = _mm_slli_epi32(_mm_xor_si128(h, ExpMant), 16);
+	__m128i SignExp  = _mm_or_si128(Sign, _mm_and_si128(IsInfNan, ExpInfNan));
+	return _mm_or_ps(Scaled, _mm_castsi128_ps(SignExp));
+}
+
+#endif // USE_SSE
+
+void ConvertUVs(const FMeshUVHalf *Src, int SrcStride, FMeshUVFloat *Dst, int DstStride, int Count)
+{
+	const byte *s = (const byte*)Src;
+	byte *d = (byte*)Dst;
+	int i = 0;
+#if USE_SSE
+	const __m128i LowMask = _mm_set1_epi32(0xFFFF);
+	for ( ; i + 4 <= Count; i += 4, s += SrcStride * 4, d += DstStride * 4)
+	{
+		// gather 4 UV pairs, all reads are done before writes, so in-place conversion is possible
+		__m128i h = _mm_set_epi32(*(const int*)(s + SrcStride * 3), *(const int*)(s + SrcStride * 2),
+			*(const int*)(s + SrcStride), *(const int*)s);
+		__m128 U = HalfToFloat4(_mm_and_si128(h, LowMask));
+		__m128 V = HalfToFloat4(_mm_srli_epi32(h, 16));
+		__m128 UV01 = _mm_unpacklo_ps(U, V);
+		__m128 UV23 = _mm_unpackhi_ps(U, V);
+		_mm_storel_pi((__m64*)d,                     UV01);
+		_mm_storeh_pi((__m64*)(d + DstStride),       UV01);
+		_mm_storel_pi((__m64*)(d + DstStride * 2),   UV23);
+		_mm_storeh_pi((__m64*)(d + DstStride * 3),   UV23);
+	}
+#endif // USE_SSE
+	for ( ; i < Count; i++, s += SrcStride, d += DstStride)
+	{
+		FMeshUVHalf UV = *(const FMeshUVHalf*)s;
+		*(FMeshUVFloat*)d = UV;		// convert
+	}
+}
+
+void ConvertUVs(const FMeshUVFloat *Src, int SrcStride, FMeshUVFloat *Dst, int DstStride, int Count)
+{
+	const byte *s = (const byte*)Src;
+	byte *d = (byte*)Dst;
+	for (int i = 0; i < Count; i++, s += SrcStride, d += DstStride)
+		*(FMeshUVFloat*)d = *(const FMeshUVFloat*)s;
+}
+
 
 //!! RENAME to CopyNormals/ConvertNormals/PutNormals/RepackNormals etc
 void UnpackNormals(const FPackedNormal SrcNormal[3], CMeshVertex &V)
@@ -75,6 +147,14 @@ void UnpackNormals(const FPackedNormal SrcNormal[3], CMeshVertex &V)
 	}
 }
 
+void UnpackNormals(const FPackedNormal *SrcNormal, int SrcStride, CMeshVertex *Verts, int VertexSize, int Count)
+{
+	const byte *s = (const byte*)SrcNormal;
+	byte *d = (byte*)Verts;
+	for (int i = 0; i < Count; i++, s += SrcStride, d += VertexSize)
+		UnpackNormals((const FPackedNormal*)s, *(CMeshVertex*)d);
+}
+
 
 
 /*-----------------------------------------------------------------------------
@@ -1924,6 +2004,45 @@ after_skeleton:
 }
 
 
+static void ConvertPositions(const FVector *Src, int SrcStride, CSkelMeshVertex *D, int Count, const FVector &MeshOrigin, const FVector &MeshExtension)
+{
+	const byte *s = (const byte*)Src;
+	for (int i = 0; i < Count; i++, s += SrcStride, D++)
+		D->Position = CVT(*(const FVector*)s);
+}
+
+static void ConvertPositions(const FVectorIntervalFixed32GPU *Src, int SrcStride, CSkelMeshVertex *D, int Count, const FVector &MeshOrigin, const FVector &MeshExtension)
+{
+	const byte *s = (const byte*)Src;
+	for (int i = 0; i < Count; i++, s += SrcStride, D++)
+	{
+		FVector VPos = ((const FVectorIntervalFixed32GPU*)s)->ToVector(MeshOrigin, MeshExtension);
+		D->Position = CVT(VPos);
+	}
+}
+
+// Convert position, UV and normal streams of GPU skin vertices of any type, influences are
+// converted separately because they depend on mesh chunks
+template<class VertType>
+static void ConvertGPUSkinStreams(const TArray<VertType> &Verts, const FSkeletalMeshVertexBuffer3 &S, CSkelMeshLod *Lod)
+{
+	guard(ConvertGPUSkinStreams);
+
+	int NumVerts = Lod->NumVerts;
+	assert(Verts.Num() >= NumVerts);
+	const VertType *V = Verts.GetData();
+	CSkelMeshVertex *D = Lod->Verts;
+
+	ConvertPositions(&V->Pos, sizeof(VertType), D, NumVerts, S.MeshOrigin, S.MeshExtension);
+	ConvertUVs(&V->UV[0], sizeof(VertType), (FMeshUVFloat*)&D->UV, sizeof(CSkelMeshVertex), NumVerts);
+	for (int TexCoordIndex = 1; TexCoordIndex < Lod->NumTexCoords; TexCoordIndex++)
+		ConvertUVs(&V->UV[TexCoordIndex], sizeof(VertType), (FMeshUVFloat*)Lod->ExtraUV[TexCoordIndex-1], sizeof(CMeshUVFloat), NumVerts);
+	UnpackNormals(V->Normal, sizeof(VertType), D, sizeof(CSkelMeshVertex), NumVerts);
+
+	unguard;
+}
+
+
 void USkeletalMesh3::ConvertMesh()
 {
 	guard(USkeletalMesh3::ConvertMesh);
@@ -2005,6 +2124,25 @@ void USkeletalMesh3::ConvertMesh()
 		CSkelMeshVertex *D = Lod->Verts;
 		int NumReweightedVerts = 0;
 
+		if (UseGpuSkinVerts)
+		{
+			// convert GPU skin vertex streams
+			if (!S.bUseFullPrecisionUVs)
+			{
+				if (!S.bUsePackedPosition)
+					ConvertGPUSkinStreams(S.VertsHalf, S, Lod);
+				else
+					ConvertGPUSkinStreams(S.VertsHalfPacked, S, Lod);
+			}
+			else
+			{
+				if (!S.bUsePackedPosition)
+					ConvertGPUSkinStreams(S.VertsFloat, S, Lod);
+				else
+					ConvertGPUSkinStreams(S.VertsFloatPacked, S, Lod);
+			}
+		}
+
 		for (int Vert = 0; Vert < VertexCount; Vert++, D++)
 		{
 			if (Vert >= lastChunkVertex)
@@ -2021,67 +2159,22 @@ void USkeletalMesh3::ConvertMesh()
 				//   previous chunk (FirstVertex=0 for a few chunks)
 				// - index count may be greater than sum of all face counts * 3 from all mesh sections -- this is verified in PSK exporter
 
-				// get vertex from GPU skin
+				// get vertex from GPU skin; position, UV and normals were converted above
 				const FGPUVert3Common *V;		// has normal and influences, but no UV[] and position
-
 				if (!S.bUseFullPrecisionUVs)
 				{
-					// position
-					const FMeshUVHalf *SUV;
 					if (!S.bUsePackedPosition)
-					{
-						const FGPUVert3Half &V0 = S.VertsHalf[Vert];
-						D->Position = CVT(V0.Pos);
-						V   = &V0;
-						SUV = V0.UV;
-					}
+						V = &S.VertsHalf[Vert];
 					else
-					{
-						const FGPUVert3PackedHalf &V0 = S.VertsHalfPacked[Vert];
-						FVector VPos;
-						VPos = V0.Pos.ToVector(S.MeshOrigin, S.MeshExtension);
-						D->Position = CVT(VPos);
-						V   = &V0;
-						SUV = V0.UV;
-					}
-					// UV
-					FMeshUVFloat fUV = SUV[0];			// convert half->float
-					D->UV = CVT(fUV);
-					for (int TexCoordIndex = 1; TexCoordIndex < NumTexCoords; TexCoordIndex++)
-					{
-						Lod->ExtraUV[TexCoordIndex-1][Vert] = CVT(SUV[TexCoordIndex]);
-					}
+						V = &S.VertsHalfPacked[Vert];
 				}
 				else
 				{
-					// position
-					const FMeshUVFloat *SUV;
 					if (!S.bUsePackedPosition)
-					{
-						const FGPUVert3Float &V0 = S.VertsFloat[Vert];
-						V = &V0;
-						D->Position = CVT(V0.Pos);
-						SUV = V0.UV;
-					}
+						V = &S.VertsFloat[Vert];
 					else
-					{
-						const FGPUVert3PackedFloat &V0 = S.VertsFloatPacked[Vert];
-						V = &V0;
-						FVector VPos;
-						VPos = V0.Pos.ToVector(S.MeshOrigin, S.MeshExtension);
-						D->Position = CVT(VPos);
-						SUV = V0.UV;
-					}
-					// UV
-					FMeshUVFloat fUV = SUV[0];
-					D->UV = CVT(fUV);
-					for (int TexCoordIndex = 1; TexCoordIndex < NumTexCoords; TexCoordIndex++)
-					{
-						Lod->ExtraUV[TexCoordIndex-1][Vert] = CVT(SUV[TexCoordIndex]);
-					}
+						V = &S.VertsFloatPacked[Vert];
 				}
-				// convert Normal[3]
-				UnpackNormals(V->Normal, *D);
 				// convert influences
 				int TotalWeight = 0;
 				int i2 = 0;
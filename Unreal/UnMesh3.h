@@ -330,6 +330,20 @@ _ENUM(AnimationKeyFormat)
 	_E(AKF_PerTrackCompression),
 };
 
+// Batch key decoders (UnAnimKeys.cpp). Decode NumKeys keys of the specified format directly from
+// the Data block, which is the memory of archive Ar, starting at the current archive position,
+// and append them to Keys. Return false when the format is not supported, in this case nothing
+// is read, and keys should be decoded with the generic code.
+bool DecodeTranslationKeys(FArchive &Ar, const uint8 *Data, AnimationCompressionFormat Format, int NumKeys,
+	const FVector &Mins, const FVector &Ranges, TArray<FVector> &Keys);
+bool DecodeRotationKeys(FArchive &Ar, const uint8 *Data, AnimationCompressionFormat Format, int NumKeys,
+	const FVector &Mins, const FVector &Ranges, TArray<FQuat> &Keys);
+// Same, for AKF_PerTrackCompression with ComponentMask taken from the track header
+bool DecodePerTrackTranslationKeys(FArchive &Ar, const uint8 *Data, AnimationCompressionFormat Format, int ComponentMask,
+	int NumKeys, const FVector &Mins, const FVector &Ranges, TArray<FVector> &Keys);
+bool DecodePerTrackRotationKeys(FArchive &Ar, const uint8 *Data, AnimationCompressionFormat Format, int ComponentMask,
+	int NumKeys, const FVector &Mins, const FVector &Ranges, TArray<FQuat> &Keys);
+
 
 #if TUROK
 
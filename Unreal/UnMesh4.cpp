@@ -734,6 +734,29 @@ void USkeletalMesh4::Serialize(FArchive &Ar)
 }
 
 
+// Convert position, UV and normal streams of GPU skin vertices of any type, influences are
+// converted separately because they depend on mesh chunks
+template<class VertType>
+static void ConvertGPUSkinStreams(const TArray<VertType> &Verts, CSkelMeshLod *Lod)
+{
+	guard(ConvertGPUSkinStreams);
+
+	int NumVerts = Lod->NumVerts;
+	assert(Verts.Num() >= NumVerts);
+	const VertType *V = Verts.GetData();
+	CSkelMeshVertex *D = Lod->Verts;
+
+	for (int i = 0; i < NumVerts; i++)
+		D[i].Position = CVT(V[i].Pos);
+	ConvertUVs(&V->UV[0], sizeof(VertType), (FMeshUVFloat*)&D->UV, sizeof(CSkelMeshVertex), NumVerts);
+	for (int TexCoordIndex = 1; TexCoordIndex < Lod->NumTexCoords; TexCoordIndex++)
+		ConvertUVs(&V->UV[TexCoordIndex], sizeof(VertType), (FMeshUVFloat*)Lod->ExtraUV[TexCoordIndex-1], sizeof(CMeshUVFloat), NumVerts);
+	UnpackNormals(V->Normal, sizeof(VertType), D, sizeof(CSkelMeshVertex), NumVerts);
+
+	unguard;
+}
+
+
 void USkeletalMesh4::ConvertMesh()
 {
 	guard(USkeletalMesh4::ConvertMesh);
@@ -785,6 +808,12 @@ void USkeletalMesh4::ConvertMesh()
 		const FSkeletalMeshVertexBuffer4 &S = SrcLod.VertexBufferGPUSkin;
 		CSkelMeshVertex *D = Lod->Verts;
 
+		// convert vertex streams
+		if (!S.bUseFullPrecisionUVs)
+			ConvertGPUSkinStreams(S.VertsHalf, Lod);
+		else
+			ConvertGPUSkinStreams(S.VertsFloat, Lod);
+
 		for (int Vert = 0; Vert < VertexCount; Vert++, D++)
 		{
 			if (Vert >= lastChunkVertex)
@@ -806,41 +835,12 @@ void USkeletalMesh4::ConvertMesh()
 				}
 			}
 
-			// get vertex from GPU skin
+			// get vertex from GPU skin; position, UV and normals were converted above
 			const FGPUVert4Common *V;		// has normal and influences, but no UV[] and position
-
 			if (!S.bUseFullPrecisionUVs)
-			{
-				const FMeshUVHalf *SUV;
-				const FGPUVert4Half &V0 = S.VertsHalf[Vert];
-				D->Position = CVT(V0.Pos);
-				V = &V0;
-				SUV = V0.UV;
-				// UV
-				FMeshUVFloat fUV = SUV[0];				// convert half->float
-				D->UV = CVT(fUV);
-				for (int TexCoordIndex = 1; TexCoordIndex < NumTexCoords; TexCoordIndex++)
-				{
-					Lod->ExtraUV[TexCoordIndex-1][Vert] = CVT(SUV[TexCoordIndex]);
-				}
-			}
+				V = &S.VertsHalf[Vert];
 			else
-			{
-				const FMeshUVFloat *SUV;
-				const FGPUVert4Float &V0 = S.VertsFloat[Vert];
-				V = &V0;
-				D->Position = CVT(V0.Pos);
-				SUV = V0.UV;
-				// UV
-				FMeshUVFloat fUV = SUV[0];
-				D->UV = CVT(fUV);
-				for (int TexCoordIndex = 1; TexCoordIndex < NumTexCoords; TexCoordIndex++)
-				{
-					Lod->ExtraUV[TexCoordIndex-1][Vert] = CVT(SUV[TexCoordIndex]);
-				}
-			}
-			// convert Normal[3]
-			UnpackNormals(V->Normal, *D);
+				V = &S.VertsFloat[Vert];
 			// convert influences
 //			int TotalWeight = 0;
 			int i2 = 0;
@@ -1040,10 +1040,8 @@ struct FStaticMeshUVItem4
 		{
 			for (int i = 0; i < GNumStaticUVSets; i++)
 			{
-				// read in half format and convert to float
-				FMeshUVHalf UVHalf;
-				Ar << UVHalf;
-				V.UV[i] = UVHalf;		// convert
+				// read in half format, the whole stream is converted to float in FStaticMeshVertexBuffer4
+				Ar << *(FMeshUVHalf*)&V.UV[i];
 			}
 		}
 		return Ar;
@@ -1081,6 +1079,15 @@ struct FStaticMeshVertexBuffer4
 			GNumStaticUVSets = S.NumTexCoords;
 			GUseStaticFloatUVs = S.bUseFullPrecisionUVs;
 			S.UV.BulkSerialize(Ar);
+			if (!S.bUseFullPrecisionUVs && S.UV.Num())
+			{
+				// convert half UVs to float in place
+				for (int i = 0; i < S.NumTexCoords; i++)
+				{
+					FMeshUVFloat *UV = &S.UV[0].UV[i];
+					ConvertUVs((FMeshUVHalf*)UV, sizeof(FStaticMeshUVItem4), UV, sizeof(FStaticMeshUVItem4), S.UV.Num());
+				}
+			}
 		}
 
 		return Ar;
@@ -1486,21 +1493,18 @@ void UStaticMesh4::ConvertMesh()
 
 		// vertices
 		Lod->AllocateVerts(NumVerts);
-		for (int i = 0; i < NumVerts; i++)
+		if (NumVerts)
 		{
-			const FStaticMeshUVItem4 &SUV = SrcLod.VertexBuffer.UV[i];
-			CStaticMeshVertex &V = Lod->Verts[i];
-
-			V.Position = CVT(SrcLod.PositionVertexBuffer.Verts[i]);
-			UnpackNormals(SUV.Normal, V);
+			assert(SrcLod.VertexBuffer.UV.Num() >= NumVerts);
+			const FStaticMeshUVItem4 *SUV = SrcLod.VertexBuffer.UV.GetData();
+			CStaticMeshVertex *V = Lod->Verts;
+			for (int i = 0; i < NumVerts; i++)
+				V[i].Position = CVT(SrcLod.PositionVertexBuffer.Verts[i]);
+			UnpackNormals(SUV->Normal, sizeof(FStaticMeshUVItem4), V, sizeof(CStaticMeshVertex), NumVerts);
 			// copy UV
-			const FMeshUVFloat* fUV = &SUV.UV[0];
-			V.UV = *CVT(fUV);
+			ConvertUVs(&SUV->UV[0], sizeof(FStaticMeshUVItem4), (FMeshUVFloat*)&V->UV, sizeof(CStaticMeshVertex), NumVerts);
 			for (int TexCoordIndex = 1; TexCoordIndex < NumTexCoords; TexCoordIndex++)
-			{
-				fUV++;
-				Lod->ExtraUV[TexCoordIndex-1][i] = *CVT(fUV);
-			}
+				ConvertUVs(&SUV->UV[TexCoordIndex], sizeof(FStaticMeshUVItem4), (FMeshUVFloat*)Lod->ExtraUV[TexCoordIndex-1], sizeof(CMeshUVFloat), NumVerts);
 			//!! also has ColorStream
 		}
 
@@ -1583,7 +1587,7 @@ void UStaticMesh4::ConvertSourceModels()
 		CStaticMeshLod *Lod = new (Mesh->Lods) CStaticMeshLod;
 
 		FRawMesh RawMesh;
-		FMemReader Reader(Bulk.BulkData, Bulk.ElementCount); // ElementCount is the same as data size, for byte bulk data
+		FMemReader Reader(Bulk.GetData(), Bulk.ElementCount); // ElementCount is the same as data size, for byte bulk data
 		Reader.SetupFrom(*GetPackageArchive());
 		RawMesh.Serialize(Reader);
 
@@ -74,9 +74,10 @@ void USkeletalMesh3::FixBatman2Skeleton()
 
 	//?? use EnableTwistBoneFixers and EnableClavicleFixer vars
 	CSkeletalMesh *Mesh = ConvertedMesh;
-	CCoords Coords[MAX_MESHBONES];
 	int i;
 	int NumBones = Mesh->RefSkeleton.Num();
+	TArray<CCoords> Coords;
+	Coords.AddZeroed(NumBones);
 
 	// compute coordinates for all bones
 	//!! code similar to CSkelMeshInstance::SetMesh()
@@ -672,7 +672,7 @@ void USkeletalMesh::PostLoadBioshockMesh()
 		for (i = 0; i < Skel->m_numBones; i++)
 		{
 			FMeshBone &B = RefSkeleton[i];
-			B.Name.Str    = Skel->m_bones[i]->m_name;				//?? hack: FName assignment
+			B.Name        = Skel->m_bones[i]->m_name;
 			B.ParentIndex = max(Skel->m_parentIndices[i], (hkInt16)0);
 			const hkQsTransform &t = Skel->m_referencePose[i];
 			B.BonePos.Orientation = (FQuat&)   t.m_rotation;
@@ -692,7 +692,7 @@ void USkeletalMesh::PostLoadBioshockMesh()
 		for (i = 0; i < Skel->m_numBones; i++)
 		{
 			FMeshBone &B = RefSkeleton[i];
-			B.Name.Str    = Skel->m_bones[i]->m_name;				//?? hack: FName assignment
+			B.Name        = Skel->m_bones[i]->m_name;
 			B.ParentIndex = max(Skel->m_parentIndices[i], (hkInt16)0);
 			const hkQsTransform &t = Skel->m_referencePose[i];
 			B.BonePos.Orientation = (FQuat&)   t.m_rotation;
@@ -136,6 +136,13 @@ void UObject::BeginLoad()
 }
 
 
+static void GetLoadingObjectHeader(char *buf, int bufSize, const void *Param)
+{
+	const UObject *Obj = (const UObject*)Param;
+	appSprintf(buf, bufSize, "Loading object %s'%s.%s'", Obj->GetClassName(), Obj->Package->Name, Obj->Name);
+}
+
+
 void UObject::EndLoad()
 {
 	assert(GObjBeginLoadCount > 0);
@@ -157,10 +164,13 @@ void UObject::EndLoad()
 		//!! should sort by packages + package offset
 		UnPackage *Package = Obj->Package;
 		guard(LoadObject);
+		CScopedLock Lock(Package->ReaderLock);
 		Package->SetupReader(Obj->PackageIndex);
-		appPrintf("Loading %s %s from package %s\n", Obj->GetClassName(), Obj->Name, Package->Filename);
+		appPrintfVerbose("Loading %s %s from package %s\n", Obj->GetClassName(), Obj->Name, Package->Filename);
 		// setup NotifyInfo to describe object
-		appSetNotifyHeader("Loading object %s'%s.%s'", Obj->GetClassName(), Package->Name, Obj->Name);
+		appSetNotifyHeaderFunc(GetLoadingObjectHeader, Obj);
+		unsigned StartTime = appMilliseconds();
+		int StartPos = Package->Tell();
 #if PROFILE_LOADING
 		appResetProfiler();
 #endif
@@ -176,6 +186,8 @@ void UObject::EndLoad()
 				Obj->GetClassName(), Obj->Name,
 				Package->GetStopper() - Package->Tell());
 		LoadedObjects.Add(Obj);
+		appLogObject("load", Obj->GetClassName(), Package->Name, Obj->Name, Package->Tell() - StartPos,
+			appMilliseconds() - StartTime, "ok");
 
 #if UNREAL4
 	#define UNVERS_STR		(Package->Game >= GAME_UE4 && Package->Summary.IsUnversioned) ? " (unversioned)" : ""
@@ -200,6 +212,10 @@ void UObject::EndLoad()
 
 	// close all opened file handles
 	UnPackage::CloseAllReaders();
+#if UNREAL3
+	// release lazily loaded bulk data when it exceeds memory limit
+	FByteBulkData::TrimMemory();
+#endif
 
 	unguard;
 }
@@ -384,7 +400,7 @@ struct FPropertyTag
 				Ar << Object;
 				if (!Object)
 				{
-					Tag.Name.Str = "None";
+					Tag.Name = "None";
 					return Ar;
 				}
 				// now, should continue serialization, skipping Name serialization (not implemented right now, so - appError)
@@ -568,7 +584,7 @@ struct FPropertyTagBat2
 		{
 		simple_prop:
 			// property serialized by offset
-			Tag.PropertyName.Str = "None";
+			Tag.PropertyName = "None";
 			Tag.DataSize = Tag.ArrayIndex = 0;
 			return Ar;
 		}
@@ -700,7 +716,7 @@ static bool FindPropBat2(const CTypeInfo *StrucType, const FPropertyTagBat2 &Tag
 
 	// prepare Tag
 	Tag.Type       = TagBat.Type;
-	Tag.Name.Str   = "unk";
+	Tag.Name       = "unk";
 	Tag.DataSize   = 0;			// unset
 	Tag.ArrayIndex = 0;
 
@@ -735,7 +751,7 @@ static bool FindPropBat2(const CTypeInfo *StrucType, const FPropertyTagBat2 &Tag
 			if (p->Offset == TagBat.Offset)
 			{
 				// found it
-				Tag.Name.Str   = p->Name;
+				Tag.Name       = p->Name;
 				Tag.Type       = TagBat.Type;
 				Tag.DataSize   = 0;			// unset
 				Tag.ArrayIndex = 0;
@@ -847,6 +863,11 @@ void CTypeInfo::SerializeProps(FArchive &Ar, void *ObjectData) const
 
 	int PropTagPos;
 
+	// When serializing from a package, property tag names are resolved using package's cache
+	CPropTagCache *TagCache = NULL;
+	if (UObject::GLoadingObj && UObject::GLoadingObj->Package && static_cast<FArchive*>(UObject::GLoadingObj->Package) == &Ar)
+		TagCache = &UObject::GLoadingObj->Package->PropTagCache;
+
 	// property list
 	while (true)
 	{
@@ -1021,7 +1042,7 @@ void CTypeInfo::SerializeProps(FArchive &Ar, void *ObjectData) const
 
 		int StopPos = Ar.Tell() + Tag.DataSize;	// for verification
 
-		const CPropInfo *Prop = FindProperty(Tag.Name);
+		const CPropInfo *Prop = TagCache ? TagCache->Find(this, Tag.Name) : FindProperty(Tag.Name);
 		if (!Prop || !Prop->TypeName)	// Prop->TypeName==NULL when declared with PROP_DROP() macro
 		{
 			if (!Prop)
@@ -1446,32 +1467,169 @@ struct PropPatch
 };
 
 static TArray<PropPatch> Patches;
-
-const CPropInfo *CTypeInfo::FindProperty(const char *Name) const
+static int PatchesRevision = 0;			// incremented by RemapProp(), used to invalidate CPropHash
+
+// Case-insensitive hash table of all properties visible from a particular CTypeInfo:
+// own properties, properties of parent types, and remapped property names. Uses open
+// addressing; entry with NULL Prop is a valid "property doesn't exist" result (remap
+// to a missing property). Properties are serialized by the main thread only (inside
+// UObject::EndLoad()), so the hash is built and used without locking.
+struct CPropHash
 {
-	guard(CTypeInfo::FindProperty);
-	int i;
-	// check for remap
-	for (i = 0; i < Patches.Num(); i++)
+	struct Entry
+	{
+		const char		*Name;
+		const CPropInfo	*Prop;
+	};
+
+	Entry		*Entries;
+	int			HashMask;
+	int			Revision;
+
+	CPropHash(int NumItems)
+	:	Revision(PatchesRevision)
+	{
+		int Size = 16;
+		while (Size < NumItems * 2) Size <<= 1;		// keep load factor below 0.5
+		Entries  = (Entry*)appMalloc(Size * sizeof(Entry));
+		HashMask = Size - 1;
+	}
+
+	~CPropHash()
 	{
-		const PropPatch &p = Patches[i];
-		if (!stricmp(p.ClassName, this->Name) && !stricmp(p.OldName, Name))
+		appFree(Entries);
+	}
+
+	// Returns false if the name already exists in the table
+	bool Add(const char *Name, const CPropInfo *Prop)
+	{
+		for (int h = appStrHashNoCase(Name) & HashMask; /* empty */; h = (h + 1) & HashMask)
 		{
-			Name = p.NewName;
-			break;
+			Entry &E = Entries[h];
+			if (!E.Name)
+			{
+				E.Name = Name;
+				E.Prop = Prop;
+				return true;
+			}
+			if (!stricmp(E.Name, Name)) return false;
 		}
 	}
-	// find property
-	for (const CTypeInfo *Type = this; Type; Type = Type->Parent)
+
+	const Entry *Find(const char *Name) const
 	{
-		for (i = 0; i < Type->NumProps; i++)
+		for (int h = appStrHashNoCase(Name) & HashMask; /* empty */; h = (h + 1) & HashMask)
+		{
+			const Entry &E = Entries[h];
+			if (!E.Name) return NULL;
+			if (!stricmp(E.Name, Name)) return &E;
+		}
+	}
+};
+
+// Linear search over the whole class hierarchy, used to build CPropHash
+static const CPropInfo *FindPropertyInHierarchy(const CTypeInfo *Type, const char *Name)
+{
+	for (/* empty */; Type; Type = Type->Parent)
+	{
+		for (int i = 0; i < Type->NumProps; i++)
 			if (!(stricmp(Type->Props[i].Name, Name)))
 				return Type->Props + i;
 	}
 	return NULL;
+}
+
+const CPropInfo *CTypeInfo::FindProperty(const char *Name) const
+{
+	guard(CTypeInfo::FindProperty);
+
+	if (!PropHash || PropHash->Revision != PatchesRevision)
+	{
+		// (re)build the hash
+		delete PropHash;
+		int NumItems = Patches.Num();
+		const CTypeInfo *Type;
+		for (Type = this; Type; Type = Type->Parent)
+			NumItems += Type->NumProps;
+		PropHash = new CPropHash(NumItems);
+		// remaps are added first: they take precedence over properties with the same name
+		for (int i = 0; i < Patches.Num(); i++)
+		{
+			const PropPatch &p = Patches[i];
+			if (!stricmp(p.ClassName, this->Name))
+				PropHash->Add(p.OldName, FindPropertyInHierarchy(this, p.NewName));
+		}
+		// derived class properties are added before parent class ones, so they override
+		// parent properties with the same name
+		for (Type = this; Type; Type = Type->Parent)
+		{
+			for (int i = 0; i < Type->NumProps; i++)
+				PropHash->Add(Type->Props[i].Name, Type->Props + i);
+		}
+	}
+
+	const CPropHash::Entry *Found = PropHash->Find(Name);
+	return Found ? Found->Prop : NULL;
+
+	unguard;
+}
+
+
+const CPropInfo *CPropTagCache::Find(const CTypeInfo *Type, const FName &Name)
+{
+	guard(CPropTagCache::Find);
+
+#if UNREAL3 || UNREAL4
+	if (Name.ExtraIndex)
+		return Type->FindProperty(Name);		// name string is not in the name table
+#endif
+
+	if (NumItems * 2 >= Entries.Num())
+	{
+		// grow the table and rehash existing items
+		TArray<Entry> OldEntries;
+		Exchange(OldEntries, Entries);
+		int NewSize = max(OldEntries.Num() * 2, 256);
+		Entries.AddZeroed(NewSize);
+		NumItems = 0;
+		for (int i = 0; i < OldEntries.Num(); i++)
+		{
+			const Entry &E = OldEntries[i];
+			if (E.Type) *Locate(E.Type, E.NameIndex) = E;
+		}
+	}
+
+	Entry *E = Locate(Type, Name.Index);
+	if (E->Type)
+	{
+		// verify the name string: FName's index could be set up in a non-standard way
+		// by game-specific FPropertyTag code
+		if (E->Name == Name.Str) return E->Prop;
+		return Type->FindProperty(Name);
+	}
+	E->Type      = Type;
+	E->NameIndex = Name.Index;
+	E->Name      = Name.Str;
+	E->Prop      = Type->FindProperty(Name);
+	NumItems++;
+	return E->Prop;
+
 	unguard;
 }
 
+CPropTagCache::Entry *CPropTagCache::Locate(const CTypeInfo *Type, int NameIndex)
+{
+	int HashMask = Entries.Num() - 1;
+	int h = ((NameIndex * 0x9E3779B1u) ^ ((size_t)Type >> 4)) & HashMask;
+	while (true)
+	{
+		Entry &E = Entries[h];
+		if (!E.Type || (E.Type == Type && E.NameIndex == NameIndex))
+			return &E;
+		h = (h + 1) & HashMask;
+	}
+}
+
 
 static void PrintIndent(int Value)
 {
@@ -1723,6 +1881,7 @@ void CTypeInfo::RemapProp(const char *ClassName, const char *OldName, const char
 	p->ClassName = ClassName;
 	p->OldName   = OldName;
 	p->NewName   = NewName;
+	PatchesRevision++;
 }
 
 
@@ -78,6 +78,7 @@ struct CTypeInfo
 	const CPropInfo *Props;
 	int				NumProps;
 	void (*Constructor)(void*);
+	mutable struct CPropHash *PropHash;	// hash table for FindProperty(), built on demand
 	// methods
 	FORCEINLINE CTypeInfo(const char *AName, const CTypeInfo *AParent, int DataSize,
 					 const CPropInfo *AProps, int PropCount, void (*AConstructor)(void*))
@@ -87,6 +88,7 @@ struct CTypeInfo
 	,	Props(AProps)
 	,	NumProps(PropCount)
 	,	Constructor(AConstructor)
+	,	PropHash(NULL)
 	{}
 	inline bool IsClass() const
 	{
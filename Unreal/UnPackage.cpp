@@ -1430,6 +1430,39 @@ public:
 
 #if UNREAL3
 
+// Block of compressed data used by FUE3ArchiveReader::DecompressAll()
+struct CDecompressBlock
+{
+	int						SrcPos;
+	int						SrcSize;
+	int						DstPos;
+	int						DstSize;
+	bool					Stored;			// block is not compressed
+};
+
+struct CDecompressContext
+{
+	const CDecompressBlock	*Blocks;
+	byte					*SrcData;		// compressed data, starting with the first block
+	int						SrcStart;
+	byte					*Dst;
+	int						CompressionFlags;
+};
+
+static void DecompressBlockWorker(int Index, void *Param)
+{
+	const CDecompressContext *Ctx = (CDecompressContext*)Param;
+	const CDecompressBlock &B = Ctx->Blocks[Index];
+	guard(DecompressBlock);
+	byte *Src = Ctx->SrcData + B.SrcPos - Ctx->SrcStart;
+	if (!B.Stored)
+		appDecompress(Src, B.SrcSize, Ctx->Dst + B.DstPos, B.DstSize, Ctx->CompressionFlags);
+	else
+		memcpy(Ctx->Dst + B.DstPos, Src, B.DstSize);
+	unguardf("block=%X+%X", B.SrcPos, B.SrcSize);
+}
+
+
 class FUE3ArchiveReader : public FArchive
 {
 	DECLARE_ARCHIVE(FUE3ArchiveReader, FArchive);
@@ -1441,9 +1474,8 @@ public:
 	// compression data
 	int						CompressionFlags;
 	TArray<FCompressedChunk> CompressedChunks;
-	// own file positions, overriding FArchive's one (because parent class is
+	// own file position, overriding FArchive's one (because parent class is
 	// used for compressed data)
-	int						Stopper;
 	int						Position;
 	// decompression buffer
 	byte					*Buffer;
@@ -1488,8 +1520,9 @@ public:
 	{
 		guard(FUE3ArchiveReader::Serialize);
 
-		if (Stopper > 0 && Position + size > Stopper)
-			appError("Serializing behind stopper (%X+%X > %X)", Position, size, Stopper);
+		Position += ReleaseWindow();
+		if (ArStopper > 0 && Position + size > ArStopper)
+			appError("Serializing behind stopper (%X+%X > %X)", Position, size, ArStopper);
 
 		while (true)
 		{
@@ -1503,7 +1536,12 @@ public:
 				Position += ToCopy;
 				size     -= ToCopy;
 				data     = OffsetPointer(data, ToCopy);
-				if (!size) return;										// copied enough
+				if (!size)
+				{
+					// copied enough, the rest of Buffer could be read without Serialize() call
+					UpdateWindow();
+					return;
+				}
 			}
 			// here: data/size points outside of loaded Buffer
 			PrepareBuffer(Position);
@@ -1541,42 +1579,7 @@ public:
 		}
 
 		if (Chunk != CurrentChunk)
-		{
-			// serialize compressed chunk header
-			Reader->Seek(Chunk->CompressedOffset);
-#if BIOSHOCK
-			if (Game == GAME_Bioshock)
-			{
-				// read block size
-				int CompressedSize;
-				*Reader << CompressedSize;
-				// generate ChunkHeader
-				ChunkHeader.Blocks.Empty(1);
-				FCompressedChunkBlock *Block = new (ChunkHeader.Blocks) FCompressedChunkBlock;
-				Block->UncompressedSize = 32768;
-				if (ArLicenseeVer >= 57)		//?? Bioshock 2; no version code found
-					*Reader << Block->UncompressedSize;
-				Block->CompressedSize = CompressedSize;
-			}
-			else
-#endif // BIOSHOCK
-			{
-				if (Chunk->CompressedSize != Chunk->UncompressedSize)
-					*Reader << ChunkHeader;
-				else
-				{
-					// have seen such block in Borderlands: chunk has CompressedSize==UncompressedSize
-					// and has no compression; no such code in original engine
-					ChunkHeader.BlockSize = -1;	// mark as uncompressed (checked below)
-					ChunkHeader.Sum.CompressedSize = ChunkHeader.Sum.UncompressedSize = Chunk->UncompressedSize;
-					ChunkHeader.Blocks.Empty(1);
-					FCompressedChunkBlock *Block = new (ChunkHeader.Blocks) FCompressedChunkBlock;
-					Block->UncompressedSize = Block->CompressedSize = Chunk->UncompressedSize;
-				}
-			}
-			ChunkDataPos = Reader->Tell();
-			CurrentChunk = Chunk;
-		}
+			ReadChunkHeader(Chunk);
 		// find block in ChunkHeader.Blocks
 		int ChunkPosition = Chunk->UncompressedOffset;
 		int ChunkData     = ChunkDataPos;
@@ -1622,14 +1625,123 @@ public:
 		unguard;
 	}
 
+	void ReadChunkHeader(const FCompressedChunk *Chunk)
+	{
+		guard(FUE3ArchiveReader::ReadChunkHeader);
+		// serialize compressed chunk header
+		Reader->Seek(Chunk->CompressedOffset);
+#if BIOSHOCK
+		if (Game == GAME_Bioshock)
+		{
+			// read block size
+			int CompressedSize;
+			*Reader << CompressedSize;
+			// generate ChunkHeader
+			ChunkHeader.Blocks.Empty(1);
+			FCompressedChunkBlock *Block = new (ChunkHeader.Blocks) FCompressedChunkBlock;
+			Block->UncompressedSize = 32768;
+			if (ArLicenseeVer >= 57)		//?? Bioshock 2; no version code found
+				*Reader << Block->UncompressedSize;
+			Block->CompressedSize = CompressedSize;
+		}
+		else
+#endif // BIOSHOCK
+		{
+			if (Chunk->CompressedSize != Chunk->UncompressedSize)
+				*Reader << ChunkHeader;
+			else
+			{
+				// have seen such block in Borderlands: chunk has CompressedSize==UncompressedSize
+				// and has no compression; no such code in original engine
+				ChunkHeader.BlockSize = -1;	// mark as uncompressed (checked below)
+				ChunkHeader.Sum.CompressedSize = ChunkHeader.Sum.UncompressedSize = Chunk->UncompressedSize;
+				ChunkHeader.Blocks.Empty(1);
+				FCompressedChunkBlock *Block = new (ChunkHeader.Blocks) FCompressedChunkBlock;
+				Block->UncompressedSize = Block->CompressedSize = Chunk->UncompressedSize;
+			}
+		}
+		ChunkDataPos = Reader->Tell();
+		CurrentChunk = Chunk;
+		unguard;
+	}
+
+	// Decompress the whole file to Dst, which should have GetFileSize() bytes. Compressed data
+	// is read with a single call, then blocks are decompressed in parallel.
+	void DecompressAll(byte *Dst, int DstSize)
+	{
+		guard(FUE3ArchiveReader::DecompressAll);
+
+		// data before the first chunk is not compressed
+		const FCompressedChunk &FirstChunk = CompressedChunks[0];
+		if (FirstChunk.UncompressedOffset > 0)
+		{
+			Reader->Seek(0);
+			Reader->Serialize(Dst, FirstChunk.UncompressedOffset);
+		}
+
+		// collect blocks of all chunks
+		TArray<CDecompressBlock> Blocks;
+		int SrcStart = 0x7FFFFFFF, SrcEnd = 0;
+		for (int ChunkIndex = 0; ChunkIndex < CompressedChunks.Num(); ChunkIndex++)
+		{
+			const FCompressedChunk *Chunk = &CompressedChunks[ChunkIndex];
+			ReadChunkHeader(Chunk);
+			int SrcPos = ChunkDataPos;
+			int DstPos = Chunk->UncompressedOffset;
+			for (int BlockIndex = 0; BlockIndex < ChunkHeader.Blocks.Num(); BlockIndex++)
+			{
+				const FCompressedChunkBlock &Block = ChunkHeader.Blocks[BlockIndex];
+				if (DstPos + Block.UncompressedSize > DstSize)
+					appError("Block %X+%X is outside of file (%X bytes)", DstPos, Block.UncompressedSize, DstSize);
+				CDecompressBlock *B = new (Blocks) CDecompressBlock;
+				B->SrcPos  = SrcPos;
+				B->SrcSize = Block.CompressedSize;
+				B->DstPos  = DstPos;
+				B->DstSize = Block.UncompressedSize;
+				B->Stored  = (ChunkHeader.BlockSize == -1);
+				SrcStart = min(SrcStart, SrcPos);
+				SrcEnd   = max(SrcEnd, SrcPos + Block.CompressedSize);
+				SrcPos += Block.CompressedSize;
+				DstPos += Block.UncompressedSize;
+			}
+		}
+		if (!Blocks.Num()) return;
+
+		// read compressed data
+		byte *SrcData = (byte*)appMalloc(SrcEnd - SrcStart);
+		Reader->Seek(SrcStart);
+		Reader->Serialize(SrcData, SrcEnd - SrcStart);
+
+		// decompress
+		CDecompressContext Ctx;
+		Ctx.Blocks           = Blocks.GetData();
+		Ctx.SrcData          = SrcData;
+		Ctx.SrcStart         = SrcStart;
+		Ctx.Dst              = Dst;
+		Ctx.CompressionFlags = CompressionFlags;
+		appParallelFor(Blocks.Num(), DecompressBlockWorker, &Ctx);
+
+		appFree(SrcData);
+
+		unguard;
+	}
+
+	void UpdateWindow()
+	{
+		if (Position >= BufferStart && Position < BufferEnd)
+			SetWindow(Buffer + Position - BufferStart, BufferEnd - Position, Position);
+	}
+
 	// position controller
 	virtual void Seek(int Pos)
 	{
+		ReleaseWindow();
 		Position = Pos;
+		UpdateWindow();
 	}
 	virtual int Tell() const
 	{
-		return Position;
+		return Position + WindowConsumed();
 	}
 	virtual int GetFileSize() const
 	{
@@ -1651,14 +1763,6 @@ public:
 		return Chunk.UncompressedOffset + Chunk.UncompressedSize;
 		unguard;
 	}
-	virtual void SetStopper(int Pos)
-	{
-		Stopper = Pos;
-	}
-	virtual int GetStopper() const
-	{
-		return Stopper;
-	}
 	virtual bool IsOpen() const
 	{
 		return Reader->IsOpen();
@@ -1670,6 +1774,7 @@ public:
 
 	virtual void Close()
 	{
+		Position += ReleaseWindow();
 		Reader->Close();
 		if (Buffer)
 		{
@@ -1792,6 +1897,9 @@ FArchive* UnPackage::CreateLoader(const char* filename, FArchive* baseLoader)
 
 UnPackage::UnPackage(const char *filename, FArchive *baseLoader, bool silent)
 :	Loader(NULL)
+#if UNREAL4
+,	PayloadReader(NULL)
+#endif
 {
 	guard(UnPackage::UnPackage);
 
@@ -1811,24 +1919,7 @@ UnPackage::UnPackage(const char *filename, FArchive *baseLoader, bool silent)
 #if !DEBUG_PACKAGE
 	if (!silent)
 #endif
-	{
-		PKG_LOG("Loading package: %s Ver: %d/%d ", Filename, Loader->ArVer, Loader->ArLicenseeVer);
-			// don't use 'Summary.FileVersion, Summary.LicenseeVersion' because UE4 has overrides for unversioned packages
-#if UNREAL3
-		if (Game >= GAME_UE3)
-		{
-			PKG_LOG("Engine: %d ", Summary.EngineVersion);
-			FUE3ArchiveReader* UE3Loader = Loader->CastTo<FUE3ArchiveReader>();
-			if (UE3Loader && UE3Loader->IsFullyCompressed)
-				PKG_LOG("[FullComp] ");
-		}
-#endif // UNREAL3
-#if UNREAL4
-		if (Game >= GAME_UE4 && Summary.IsUnversioned)
-			PKG_LOG("[Unversioned] ");
-#endif // UNREAL4
-		PKG_LOG("Names: %d Exports: %d Imports: %d Game: %X\n", Summary.NameCount, Summary.ExportCount, Summary.ImportCount, Game);
-	}
+		PrintInfo();
 
 #if DEBUG_PACKAGE
 	appPrintf("Flags: %X, Name offset: %X, Export offset: %X, Import offset: %X\n", Summary.PackageFlags, Summary.NameOffset, Summary.ExportOffset, Summary.ImportOffset);
@@ -1898,6 +1989,9 @@ UnPackage::UnPackage(const char *filename, FArchive *baseLoader, bool silent)
 	#endif // NURIEN
 #endif // UNREAL3
 
+	// Loader is final now, read simple types directly from its memory buffer
+	ShareWindow(Loader);
+
 	LoadNameTable();
 	LoadImportTable();
 	LoadExportTable();
@@ -1924,7 +2018,7 @@ UnPackage::UnPackage(const char *filename, FArchive *baseLoader, bool silent)
 no_depends: ;
 #endif // UNREAL3 && !USE_COMPACT_PACKAGE_STRUCTS
 
-	// add self to package map
+	// make short package name
 	char buf[MAX_PACKAGE_PATH];
 	const char *s = strrchr(filename, '/');
 	if (!s) s = strrchr(filename, '\\');			// WARNING: not processing mixed '/' and '\'
@@ -1933,7 +2027,8 @@ no_depends: ;
 	char *s2 = strchr(buf, '.');
 	if (s2) *s2 = 0;
 	appStrncpyz(Name, buf, ARRAY_COUNT(Name));
-	PackageMap.Add(this);
+	// note: package is added to PackageMap by LoadPackage(), it could be created in a
+	// prefetch thread
 
 	// Release package file handle
 	CloseReader();
@@ -1946,6 +2041,27 @@ no_depends: ;
 }
 
 
+void UnPackage::PrintInfo()
+{
+	PKG_LOG("Loading package: %s Ver: %d/%d ", Filename, Loader->ArVer, Loader->ArLicenseeVer);
+		// don't use 'Summary.FileVersion, Summary.LicenseeVersion' because UE4 has overrides for unversioned packages
+#if UNREAL3
+	if (Game >= GAME_UE3)
+	{
+		PKG_LOG("Engine: %d ", Summary.EngineVersion);
+		FUE3ArchiveReader* UE3Loader = Loader->CastTo<FUE3ArchiveReader>();
+		if (UE3Loader && UE3Loader->IsFullyCompressed)
+			PKG_LOG("[FullComp] ");
+	}
+#endif // UNREAL3
+#if UNREAL4
+	if (Game >= GAME_UE4 && Summary.IsUnversioned)
+		PKG_LOG("[Unversioned] ");
+#endif // UNREAL4
+	PKG_LOG("Names: %d Exports: %d Imports: %d Game: %X\n", Summary.NameCount, Summary.ExportCount, Summary.ImportCount, Game);
+}
+
+
 void UnPackage::LoadNameTable()
 {
 	guard(UnPackage::LoadNameTable);
@@ -2247,16 +2363,19 @@ UnPackage::~UnPackage()
 	guard(UnPackage::~UnPackage);
 	// free resources
 	if (Loader) delete Loader;
+#if UNREAL4
+	if (PayloadReader) delete PayloadReader;
+#endif
 	delete NameTable;
 	delete ImportTable;
 	delete ExportTable;
 #if UNREAL3
 	if (DependsTable) delete DependsTable;
 #endif
-	// remove self from package table
+	// remove self from package table; prefetched packages could be released before registration
 	int i = PackageMap.FindItem(this);
-	assert(i != INDEX_NONE);
-	PackageMap.RemoveAt(i);
+	if (i != INDEX_NONE)
+		PackageMap.RemoveAt(i);
 	unguard;
 }
 
@@ -2297,6 +2416,7 @@ void UnPackage::SetupReader(int ExportIndex)
 
 void UnPackage::CloseReader()
 {
+	CScopedLock Lock(ReaderLock);
 #if 0
 	FFileArchive* File = FindFileArchive(Loader);
 	assert(File);
@@ -2304,6 +2424,13 @@ void UnPackage::CloseReader()
 #else
 	Loader->Close();
 #endif
+#if UNREAL4
+	if (PayloadReader)
+	{
+		delete PayloadReader;
+		PayloadReader = NULL;
+	}
+#endif
 }
 
 void UnPackage::CloseAllReaders()
@@ -2315,6 +2442,163 @@ void UnPackage::CloseAllReaders()
 	}
 }
 
+void UnPackage::ReadUncompressedFile(byte *Buffer, int Size)
+{
+	guard(UnPackage::ReadUncompressedFile);
+
+	CScopedLock Lock(ReaderLock);
+#if UNREAL3
+	FUE3ArchiveReader* UE3Loader = Loader->CastTo<FUE3ArchiveReader>();
+	if (UE3Loader)
+	{
+		UE3Loader->DecompressAll(Buffer, Size);
+		return;
+	}
+#endif // UNREAL3
+	Loader->Seek(0);
+	Loader->Serialize(Buffer, Size);
+
+	unguardf("%s", Filename);
+}
+
+
+#if UNREAL4
+
+#define PAYLOAD_BUFFER_SIZE		(256*1024)
+
+// Reader for raw data of UE4 compressed package. Bulk data of such package is stored outside
+// of compressed blocks, and it is accessed with uncompressed file positions. File is read with
+// positional reads using a large read-ahead buffer, so neighbouring payloads (mips, LODs) are
+// loaded with a single read operation.
+class FPackagePayloadReader : public FArchive
+{
+	DECLARE_ARCHIVE(FPackagePayloadReader, FArchive);
+public:
+	FPackagePayloadReader(FArchive *InReader)
+	:	Reader(InReader)
+	,	Pos(0)
+	,	Buffer(NULL)
+	,	BufferPos(0)
+	,	BufferSize(0)
+	{
+		IsLoading = true;
+		SetupFrom(*Reader);
+		FileSize = Reader->GetFileSize64();
+	}
+
+	virtual ~FPackagePayloadReader()
+	{
+		if (Buffer) appFree(Buffer);
+		delete Reader;
+	}
+
+	virtual void Seek(int InPos)
+	{
+		Pos = InPos;
+	}
+
+	virtual void Seek64(int64 InPos)
+	{
+		Pos = InPos;
+	}
+
+	virtual int Tell() const
+	{
+		return (int)Pos;
+	}
+
+	virtual int64 Tell64() const
+	{
+		return Pos;
+	}
+
+	virtual int GetFileSize() const
+	{
+		return Reader->GetFileSize();
+	}
+
+	virtual int64 GetFileSize64() const
+	{
+		return FileSize;
+	}
+
+	virtual void Serialize(void *data, int size)
+	{
+		guard(FPackagePayloadReader::Serialize);
+
+		if (Pos + size > FileSize)
+			appError("Serializing behind end of file (%llX+%X > %llX)", Pos, size, FileSize);
+
+		while (size > 0)
+		{
+			if (Pos >= BufferPos && Pos < BufferPos + BufferSize)
+			{
+				// data is in buffer
+				int LocalPos = (int)(Pos - BufferPos);
+				int CanCopy = min(BufferSize - LocalPos, size);
+				memcpy(data, Buffer + LocalPos, CanCopy);
+				data = OffsetPointer(data, CanCopy);
+				size -= CanCopy;
+				Pos  += CanCopy;
+			}
+			else if (size >= PAYLOAD_BUFFER_SIZE)
+			{
+				// large block, read directly
+				Reader->ReadAt(Pos, data, size);
+				Pos += size;
+				break;
+			}
+			else
+			{
+				// fill the buffer, it will probably contain the following payloads too
+				if (!Buffer) Buffer = (byte*)appMalloc(PAYLOAD_BUFFER_SIZE);
+				BufferPos  = Pos;
+				BufferSize = (int)min((int64)PAYLOAD_BUFFER_SIZE, FileSize - Pos);
+				Reader->ReadAt(BufferPos, Buffer, BufferSize);
+			}
+		}
+
+		unguardf("pos=%llX", Pos);
+	}
+
+protected:
+	FArchive	*Reader;
+	int64		Pos;
+	int64		FileSize;
+	byte		*Buffer;
+	int64		BufferPos;
+	int			BufferSize;
+};
+
+
+FArchive* UnPackage::GetPayloadReader()
+{
+	guard(UnPackage::GetPayloadReader);
+
+	if (!PayloadReader)
+	{
+		// open new FArchive for the package file
+		const CGameFileInfo* info = appFindGameFile(Filename);
+		FArchive* Reader = NULL;
+		if (info)
+		{
+			Reader = appCreateFileReader(info);
+			assert(Reader);
+		}
+		else
+		{
+			Reader = new FFileReader(Filename);
+		}
+		Reader->Game = Game;
+		PayloadReader = new FPackagePayloadReader(Reader);
+	}
+	return PayloadReader;
+
+	unguardf("%s", Filename);
+}
+
+#endif // UNREAL4
+
 
 /*-----------------------------------------------------------------------------
 	UObject* and FName serializers
@@ -2336,8 +2620,12 @@ FArchive& UnPackage::operator<<(FName &N)
 		}
 		else
 		{
-			N.Str = appStrdupPool(va("%s%d", GetName(N.Index), N.ExtraIndex-1));	// without "_" char
+			// note: not using va() here, packages are also loaded by prefetch threads
+			char buf[MAX_FNAME_LEN + 16];
+			appSprintf(ARRAY_ARG(buf), "%s%d", GetName(N.Index), N.ExtraIndex-1);	// without "_" char
+			N.Str = appStrdupPool(buf);
 		}
+		N.NameId = appGetNameId(N.Str);
 		return *this;
 	}
 #endif // BIOSHOCK
@@ -2389,12 +2677,16 @@ FArchive& UnPackage::operator<<(FName &N)
 	}
 	else
 	{
-		N.Str = appStrdupPool(va("%s_%d", GetName(N.Index), N.ExtraIndex-1));
+		// note: not using va() here, packages are also loaded by prefetch threads
+		char buf[MAX_FNAME_LEN + 16];
+		appSprintf(ARRAY_ARG(buf), "%s_%d", GetName(N.Index), N.ExtraIndex-1);
+		N.Str = appStrdupPool(buf);
 	}
 #else
 	// no modern engines compiled
 	N.Str = GetName(N.Index);
 #endif // UNREAL3 || UNREAL4
+	N.NameId = appGetNameId(N.Str);
 
 	return *this;
 
@@ -2617,6 +2909,91 @@ UObject* UnPackage::CreateExport(int index)
 }
 
 
+/*-----------------------------------------------------------------------------
+	Import resolution cache
+
+	Objects like default materials and textures are imported by many packages.
+	Resolved imports are stored in the global cache, keyed by class name and full
+	object path, so the same object imported by another package is found without
+	scanning export table of the source package. Package objects are never
+	destroyed, so cached entries are always valid.
+-----------------------------------------------------------------------------*/
+
+#define IMPORT_CACHE_HASH_SIZE		16384
+
+struct CImportCacheEntry
+{
+	FString			Key;
+	UnPackage		*Package;
+	int				ExportIndex;
+	int				HashNext;
+};
+
+static TArray<CImportCacheEntry> ImportCache;
+static int ImportCacheHash[IMPORT_CACHE_HASH_SIZE];
+
+// Make a key for import: "Class'Package.Group.Object'"
+static void GetImportKey(const UnPackage *Package, const FObjectImport &Imp, char *buf, int bufSize)
+{
+	guard(GetImportKey);
+
+	// collect names of import and its outer objects
+	const char *Names[64];
+	int NumNames = 0;
+	Names[NumNames++] = Imp.ObjectName;
+	int PackageIndex = Imp.PackageIndex;
+	while (PackageIndex && NumNames < ARRAY_COUNT(Names))
+	{
+		if (PackageIndex < 0)
+		{
+			const FObjectImport &Rec = Package->GetImport(-PackageIndex-1);
+			PackageIndex = Rec.PackageIndex;
+			Names[NumNames++] = Rec.ObjectName;
+		}
+		else
+		{
+			// possible for UE3 forced exports
+			const FObjectExport &Rec = Package->GetExport(PackageIndex-1);
+			PackageIndex = Rec.PackageIndex;
+			Names[NumNames++] = Rec.ObjectName;
+		}
+	}
+
+	appSprintf(buf, bufSize, "%s'", *Imp.ClassName);
+	for (int i = NumNames - 1; i >= 0; i--)
+		appStrcatn(buf, bufSize, va(i ? "%s." : "%s'", Names[i]));
+
+	unguard;
+}
+
+static CImportCacheEntry* FindImportCacheEntry(const char *Key, int Hash)
+{
+	if (!ImportCache.Num()) return NULL;
+	for (int i = ImportCacheHash[Hash]; i >= 0; i = ImportCache[i].HashNext)
+	{
+		CImportCacheEntry &E = ImportCache[i];
+		if (!stricmp(*E.Key, Key)) return &E;
+	}
+	return NULL;
+}
+
+static void AddImportCacheEntry(const char *Key, int Hash, UnPackage *Package, int ExportIndex)
+{
+	if (!ImportCache.Num())
+	{
+		// we're adding first item here, initialize hash with -1
+		memset(ImportCacheHash, -1, sizeof(ImportCacheHash));
+	}
+	int Index = ImportCache.AddZeroed();
+	CImportCacheEntry &E = ImportCache[Index];
+	E.Key         = Key;
+	E.Package     = Package;
+	E.ExportIndex = ExportIndex;
+	E.HashNext    = ImportCacheHash[Hash];
+	ImportCacheHash[Hash] = Index;
+}
+
+
 UObject* UnPackage::CreateImport(int index)
 {
 	guard(UnPackage::CreateImport);
@@ -2624,6 +3001,22 @@ UObject* UnPackage::CreateImport(int index)
 	FObjectImport &Imp = GetImport(index);
 	if (Imp.Missing) return NULL;	// error message already displayed for this entry
 
+	// check if import was already resolved
+	if (Imp.ResolvedPackage)
+		return Imp.ResolvedPackage->CreateExport(Imp.ResolvedIndex);
+
+	// check the global cache
+	char Key[1024];
+	GetImportKey(this, Imp, ARRAY_ARG(Key));
+	int KeyHash = appStrHashNoCase(Key) & (IMPORT_CACHE_HASH_SIZE - 1);
+	const CImportCacheEntry *Cached = FindImportCacheEntry(Key, KeyHash);
+	if (Cached)
+	{
+		Imp.ResolvedPackage = Cached->Package;
+		Imp.ResolvedIndex   = Cached->ExportIndex;
+		return Cached->Package->CreateExport(Cached->ExportIndex);
+	}
+
 	// load package
 	const char *PackageName = GetObjectPackageName(Imp.PackageIndex);
 	UnPackage *Package = LoadPackage(PackageName);
@@ -2682,7 +3075,10 @@ UObject* UnPackage::CreateImport(int index)
 		return NULL;
 	}
 
-	// create object
+	// remember the result and create object
+	Imp.ResolvedPackage = Package;
+	Imp.ResolvedIndex   = ObjIndex;
+	AddImportCacheEntry(Key, KeyHash, Package, ObjIndex);
 	return Package->CreateExport(ObjIndex);
 
 	unguardf("%s:%d", Filename, index);
@@ -2824,10 +3220,21 @@ UnPackage *UnPackage::LoadPackage(const char *Name, bool silent)
 		// Check if package was already loaded.
 		if (info->Package)
 			return info->Package;
-		// Load the package.
-		UnPackage* package = new UnPackage(info->RelativeName, appCreateFileReader(info), silent);
+		// Load the package, or take it from prefetched packages.
+		UnPackage* package = ClaimPrefetchedPackage(info);
+		if (package)
+		{
+			if (!silent) package->PrintInfo();
+		}
+		else
+		{
+			package = new UnPackage(info->RelativeName, appCreateFileReader(info), silent);
+		}
+		PackageMap.Add(package);
 		// Cache pointer in CGameFileInfo so next time it will be found quickly.
 		const_cast<CGameFileInfo*>(info)->Package = package;
+		// Start loading of imported packages.
+		if (!silent) package->PrefetchImports();
 		return package;
 	}
 	else
@@ -2850,7 +3257,11 @@ UnPackage *UnPackage::LoadPackage(const char *Name, bool silent)
 				return PackageMap[i];
 		// Try to load package.
 		if (appFileExists(Name))
-			return new UnPackage(Name, NULL, silent);
+		{
+			UnPackage* package = new UnPackage(Name, NULL, silent);
+			PackageMap.Add(package);
+			return package;
+		}
 	}
 
 	// The package is missing. Do not print any warnings: missing package is a normal situation
@@ -2861,3 +3272,182 @@ UnPackage *UnPackage::LoadPackage(const char *Name, bool silent)
 
 	unguardf("%s", Name);
 }
+
+
+/*-----------------------------------------------------------------------------
+	Import prefetching
+
+	When a package is loaded, packages referenced by its import table are
+	loaded in worker threads, so CreateImport() will find them ready. Only the
+	main thread adds and removes requests, worker threads change the state of
+	requests. Prefetched packages are not registered in PackageMap until
+	LoadPackage() claims them. Number of requests is limited by
+	GPrefetchPackages: when the list is full, the oldest prefetched package
+	which wasn't claimed is released.
+-----------------------------------------------------------------------------*/
+
+int GPrefetchPackages = 0;
+
+#define MAX_PREFETCH_THREADS	4
+
+enum
+{
+	PREFETCH_Queued,
+	PREFETCH_Working,
+	PREFETCH_Done,
+	PREFETCH_Failed,
+};
+
+struct CPrefetchRequest
+{
+	const CGameFileInfo		*Info;
+	UnPackage				*Package;
+	int						State;
+};
+
+static CMutex PrefetchLock;							// protects everything below
+static CCondition PrefetchFinished;					// signaled when a request leaves PREFETCH_Working state
+static TArray<CPrefetchRequest*> PrefetchRequests;
+static CThread PrefetchThreads[MAX_PREFETCH_THREADS];
+static bool PrefetchThreadActive[MAX_PREFETCH_THREADS];
+
+
+void UnPackage::PrefetchWorker(void *Arg)
+{
+	int ThreadIndex = (int)(size_t)Arg;
+	// Note: this function shouldn't have objects with destructors because of TRY
+	while (true)
+	{
+		// get the first queued request
+		CPrefetchRequest *Req = NULL;
+		PrefetchLock.Lock();
+		for (int i = 0; i < PrefetchRequests.Num(); i++)
+		{
+			if (PrefetchRequests[i]->State == PREFETCH_Queued)
+			{
+				Req = PrefetchRequests[i];
+				Req->State = PREFETCH_Working;
+				break;
+			}
+		}
+		if (!Req) PrefetchThreadActive[ThreadIndex] = false;
+		PrefetchLock.Unlock();
+		if (!Req) return;
+
+		UnPackage *Package = NULL;
+		TRY
+		{
+			Package = new UnPackage(Req->Info->RelativeName, appCreateFileReader(Req->Info), true);
+		}
+		CATCH_CRASH
+		{
+			// the error will be displayed when the main thread will load this package again
+#if DO_GUARD
+			GErrorHistory[0] = 0;
+#endif
+		}
+
+		PrefetchLock.Lock();
+		Req->Package = Package;
+		Req->State   = Package ? PREFETCH_Done : PREFETCH_Failed;
+		PrefetchFinished.SignalAll();
+		PrefetchLock.Unlock();
+	}
+}
+
+
+// Start an idle prefetch thread. PrefetchLock should be held.
+void UnPackage::StartPrefetchThread()
+{
+	// leave one core for the main thread
+	int NumThreads = bound(appGetNumThreads() - 1, 1, MAX_PREFETCH_THREADS);
+	for (int i = 0; i < NumThreads; i++)
+	{
+		if (PrefetchThreadActive[i]) continue;
+		// the thread has finished its work, release it before reusing
+		PrefetchThreads[i].Join();
+		PrefetchThreadActive[i] = true;
+		PrefetchThreads[i].Start(PrefetchWorker, (void*)(size_t)i);
+		return;
+	}
+	// all threads are busy, one of them will pick up the new request
+}
+
+
+void UnPackage::PrefetchImports()
+{
+	guard(UnPackage::PrefetchImports);
+
+	if (GPrefetchPackages <= 0 || appGetNumThreads() <= 1) return;
+
+	PrefetchLock.Lock();
+	for (int i = 0; i < Summary.ImportCount; i++)
+	{
+		const FObjectImport &Imp = ImportTable[i];
+		if (Imp.PackageIndex != 0) continue;		// not a package
+		const CGameFileInfo *info = appFindGameFile(Imp.ObjectName);
+		if (!info || !info->IsPackage || info->Package) continue;	// missing or already loaded
+
+		int j;
+		for (j = 0; j < PrefetchRequests.Num(); j++)
+			if (PrefetchRequests[j]->Info == info) break;
+		if (j < PrefetchRequests.Num()) continue;	// already requested
+
+		if (PrefetchRequests.Num() >= GPrefetchPackages)
+		{
+			// release the oldest package which wasn't claimed
+			for (j = 0; j < PrefetchRequests.Num(); j++)
+			{
+				int State = PrefetchRequests[j]->State;
+				if (State == PREFETCH_Done || State == PREFETCH_Failed) break;
+			}
+			if (j == PrefetchRequests.Num()) break;	// all requests are still in progress
+			CPrefetchRequest *Old = PrefetchRequests[j];
+			PrefetchRequests.RemoveAt(j);
+			if (Old->Package) delete Old->Package;
+			delete Old;
+		}
+
+		CPrefetchRequest *Req = new CPrefetchRequest;
+		Req->Info    = info;
+		Req->Package = NULL;
+		Req->State   = PREFETCH_Queued;
+		PrefetchRequests.Add(Req);
+		StartPrefetchThread();
+	}
+	PrefetchLock.Unlock();
+
+	unguardf("%s", Filename);
+}
+
+
+UnPackage* UnPackage::ClaimPrefetchedPackage(const CGameFileInfo *info)
+{
+	guard(UnPackage::ClaimPrefetchedPackage);
+
+	// requests list is modified by the main thread only, so it could be checked without locking
+	if (!PrefetchRequests.Num()) return NULL;
+
+	PrefetchLock.Lock();
+	int Index;
+	for (Index = 0; Index < PrefetchRequests.Num(); Index++)
+		if (PrefetchRequests[Index]->Info == info) break;
+	if (Index == PrefetchRequests.Num())
+	{
+		PrefetchLock.Unlock();
+		return NULL;
+	}
+	CPrefetchRequest *Req = PrefetchRequests[Index];
+	// the package is being loaded now, wait for it; the request stays at the same place
+	// because only the main thread removes requests
+	while (Req->State == PREFETCH_Working)
+		PrefetchFinished.Wait(PrefetchLock);
+	// not started yet, loaded or failed; the worker threads don't use it anymore
+	PrefetchRequests.RemoveAt(Index);
+	PrefetchLock.Unlock();
+	UnPackage *Package = Req->Package;
+	delete Req;
+	return Package;
+
+	unguardf("%s", info->RelativeName);
+}
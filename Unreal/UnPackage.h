@@ -1,6 +1,8 @@
 #ifndef __UNPACKAGE_H__
 #define __UNPACKAGE_H__
 
+#include "Parallel.h"			// for CMutex
+
 
 #if 1
 #	define PKG_LOG(...)		appPrintf(__VA_ARGS__)
@@ -173,6 +175,9 @@ struct FObjectImport
 	int32		PackageIndex;
 	FName		ObjectName;
 	bool		Missing;					// not serialized
+	// export which the import was resolved to, not serialized
+	UnPackage	*ResolvedPackage;
+	int32		ResolvedIndex;
 
 	friend FArchive& operator<<(FArchive &Ar, FObjectImport &I);
 };
@@ -192,6 +197,38 @@ struct FObjectDepends
 #endif // UNREAL3
 
 
+// Cache for resolving FPropertyTag names to object properties in CTypeInfo::SerializeProps().
+// Key is a pair of typeinfo and name table index, so repeated tags are found with a single
+// hash lookup instead of CTypeInfo::FindProperty() call. Used by the main thread only, like
+// CTypeInfo::FindProperty(), so it has no locking.
+struct CPropTagCache
+{
+	CPropTagCache()
+	:	NumItems(0)
+	{}
+
+	const struct CPropInfo* Find(const struct CTypeInfo *Type, const FName &Name);
+
+protected:
+	struct Entry
+	{
+		const CTypeInfo		*Type;
+		int					NameIndex;
+		const char			*Name;
+		const CPropInfo		*Prop;
+	};
+
+	TArray<Entry>	Entries;
+	int				NumItems;
+
+	Entry* Locate(const CTypeInfo *Type, int NameIndex);
+};
+
+
+// Maximal number of imported packages which are loaded in background threads before they
+// are needed; 0 = disable background loading
+extern int GPrefetchPackages;
+
 // In Unreal Engine class with similar functionality named "ULinkerLoad"
 class UnPackage : public FArchive
 {
@@ -200,6 +237,10 @@ public:
 	char					Filename[MAX_PACKAGE_PATH];		// full name with path and extension
 	char					Name[64];						// short name
 	FArchive				*Loader;
+#if UNREAL4
+	// Reader for bulk data of compressed package, created on demand with GetPayloadReader()
+	FArchive				*PayloadReader;
+#endif
 	// package header
 	FPackageFileSummary		Summary;
 	// tables
@@ -209,6 +250,10 @@ public:
 #if UNREAL3
 	FObjectDepends			*DependsTable;
 #endif
+	CPropTagCache			PropTagCache;
+	// Lock for the package reader. Object loading code uses it on the main thread, but lazy
+	// bulk data could be loaded from any thread.
+	CMutex					ReaderLock;
 
 protected:
 	UnPackage(const char *filename, FArchive *baseLoader = NULL, bool silent = false);
@@ -220,6 +265,10 @@ public:
 	// to previously loaded UnPackage.
 	static UnPackage *LoadPackage(const char *Name, bool silent = false);
 
+	// Start loading packages referenced by the import table in background threads. Does
+	// nothing when GPrefetchPackages is 0. Called by LoadPackage().
+	void PrefetchImports();
+
 	static FArchive* CreateLoader(const char* filename, FArchive* baseLoader = NULL);
 
 	static const TArray<UnPackage*>& GetPackageMap()
@@ -235,6 +284,17 @@ public:
 
 	static void CloseAllReaders();
 
+	// Read the whole package file in uncompressed form, Size should be GetFileSize(). Compressed
+	// blocks of UE3 packages are decompressed in parallel. Package should be opened.
+	void ReadUncompressedFile(byte *Buffer, int Size);
+
+#if UNREAL4
+	// Get a reader for raw file data of compressed package, used for data which is stored
+	// outside of compressed blocks. Reader is shared by all bulk data of the package, so it
+	// should be used with ReaderLock locked. Released with CloseReader().
+	FArchive* GetPayloadReader();
+#endif
+
 	const char* GetName(int index)
 	{
 		if (index < 0 || index >= Summary.NameCount)
@@ -358,10 +418,16 @@ public:
 	}
 
 private:
+	void PrintInfo();
 	void LoadNameTable();
 	void LoadImportTable();
 	void LoadExportTable();
 
+	// Import prefetching
+	static UnPackage* ClaimPrefetchedPackage(const CGameFileInfo *info);
+	static void StartPrefetchThread();
+	static void PrefetchWorker(void *Arg);
+
 	static TArray<UnPackage*> PackageMap;
 };
 
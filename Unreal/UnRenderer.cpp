@@ -12,9 +12,10 @@
 #include "GlWindow.h"
 
 #include "Shaders.h"
+#include "TexturePrepare.h"
 
-#define MAX_IMG_SIZE		4096
 #define BAD_TEXTURE			((GLuint) -2)	// the texture object has permanent error, don't try to upload it again
+#define MAX_UPLOADS_PER_FRAME	4				// number of asynchronously prepared textures uploaded per frame
 
 #if 0
 // profiling
@@ -31,258 +32,30 @@ static GLuint GetDefaultTexNum();
 
 
 //#define SHOW_SHADER_PARAMS	1
-//#define DEBUG_MIPS			1			// use to debug decompression of lower mip levels, especially for XBox360
-
-
-/*-----------------------------------------------------------------------------
-	Mipmapping and resampling
------------------------------------------------------------------------------*/
-
-//?? move to CoreGL
-
-static void ResampleTexture(unsigned* in, int inwidth, int inheight, unsigned* out, int outwidth, int outheight)
-{
-	int		i;
-	unsigned p1[MAX_IMG_SIZE], p2[MAX_IMG_SIZE];
-
-	unsigned fracstep = (inwidth << 16) / outwidth;
-	unsigned frac = fracstep >> 2;
-	for (i = 0; i < outwidth; i++)
-	{
-		p1[i] = 4 * (frac >> 16);
-		frac += fracstep;
-	}
-	frac = 3 * (fracstep >> 2);
-	for (i = 0; i < outwidth; i++)
-	{
-		p2[i] = 4 * (frac >> 16);
-		frac += fracstep;
-	}
-
-	float f, f1, f2;
-	f = (float)inheight / outheight;
-	for (i = 0, f1 = 0.25f * f, f2 = 0.75f * f; i < outheight; i++, out += outwidth, f1 += f, f2 += f)
-	{
-		unsigned *inrow  = in + inwidth * appFloor(f1);
-		unsigned *inrow2 = in + inwidth * appFloor(f2);
-		for (int j = 0; j < outwidth; j++)
-		{
-			int		n, r, g, b, a;
-			byte	*pix;
-
-			n = r = g = b = a = 0;
-#define PROCESS_PIXEL(row,col)	\
-	pix = (byte *)row + col[j];		\
-	if (pix[3])	\
-	{			\
-		n++;	\
-		r += *pix++; g += *pix++; b += *pix++; a += *pix;	\
-	}
-			PROCESS_PIXEL(inrow,  p1);
-			PROCESS_PIXEL(inrow,  p2);
-			PROCESS_PIXEL(inrow2, p1);
-			PROCESS_PIXEL(inrow2, p2);
-#undef PROCESS_PIXEL
-
-			switch (n)		// NOTE: generic version ("x /= n") is 50% slower
-			{
-			// case 1 - divide by 1 - do nothing
-			case 2: r >>= 1; g >>= 1; b >>= 1; a >>= 1; break;
-			case 3: r /= 3;  g /= 3;  b /= 3;  a /= 3;  break;
-			case 4: r >>= 2; g >>= 2; b >>= 2; a >>= 2; break;
-			case 0: r = g = b = 0; break;
-			}
-
-			((byte *)(out+j))[0] = r;
-			((byte *)(out+j))[1] = g;
-			((byte *)(out+j))[2] = b;
-			((byte *)(out+j))[3] = a;
-		}
-	}
-}
-
-
-static void MipMap(byte* in, int width, int height)
-{
-	width *= 4;		// sizeof(rgba)
-	height >>= 1;
-	byte *out = in;
-	for (int i = 0; i < height; i++, in += width)
-	{
-		for (int j = 0; j < width; j += 8, out += 4, in += 8)
-		{
-			int		r, g, b, a, am, n;
-
-			r = g = b = a = am = n = 0;
-//!! should perform removing of alpha-channel when IMAGE_NOALPHA specified
-//!! should perform removing (making black) color channel when alpha==0 (NOT ALWAYS?)
-//!!  - should analyze shader, and it will not use blending with alpha (or no blending at all)
-//!!    then remove alpha channel (require to process shader's *map commands after all other commands, this
-//!!    can be done with delaying [map|animmap|clampmap|animclampmap] lines and executing after all)
-#if 0
-#define PROCESS_PIXEL(idx)	\
-	if (in[idx+3])	\
-	{	\
-		n++;	\
-		r += in[idx]; g += in[idx+1]; b += in[idx+2]; a += in[idx+3];	\
-		am = max(am, in[idx+3]);	\
-	}
-#else
-#define PROCESS_PIXEL(idx)	\
-	{	\
-		n++;	\
-		r += in[idx]; g += in[idx+1]; b += in[idx+2]; a += in[idx+3];	\
-		am = max(am, in[idx+3]);	\
-	}
-#endif
-			PROCESS_PIXEL(0);
-			PROCESS_PIXEL(4);
-			PROCESS_PIXEL(width);
-			PROCESS_PIXEL(width+4);
-#undef PROCESS_PIXEL
-			//!! NOTE: currently, always n==4 here
-			switch (n)
-			{
-			// case 1 - divide by 1 - do nothing
-			case 2:
-				r >>= 1; g >>= 1; b >>= 1; a >>= 1;
-				break;
-			case 3:
-				r /= 3; g /= 3; b /= 3; a /= 3;
-				break;
-			case 4:
-				r >>= 2; g >>= 2; b >>= 2; a >>= 2;
-				break;
-			case 0:
-				r = g = b = 0;
-				break;
-			}
-			out[0] = r; out[1] = g; out[2] = b;
-			// generate alpha-channel for mipmaps (don't let it be transparent)
-			// dest alpha = (MAX(a[0]..a[3]) + AVG(a[0]..a[3])) / 2
-			// if alpha = 255 or 0 (for all 4 points) -- it will holds its value
-			out[3] = (am + a) / 2;
-		}
-	}
-}
 
 
 /*-----------------------------------------------------------------------------
 	Uploading textures
 -----------------------------------------------------------------------------*/
 
-//?? move to CoreGL
-
-static void GetImageDimensions(int width, int height, int* scaledWidth, int* scaledHeight)
-{
-	int sw, sh;
-	for (sw = 1; sw < width;  sw <<= 1) ;
-	for (sh = 1; sh < height; sh <<= 1) ;
-
-	// scale down only when new image dimension is larger than 64 and
-	// larger than 4/3 of original image dimension
-	if (sw > 64 && sw > (width * 4 / 3))  sw >>= 1;
-	if (sh > 64 && sh > (height * 4 / 3)) sh >>= 1;
-
-	while (sw > MAX_IMG_SIZE) sw >>= 1;
-	while (sh > MAX_IMG_SIZE) sh >>= 1;
-
-	if (sw < 1) sw = 1;
-	if (sh < 1) sh = 1;
-
-	*scaledWidth  = sw;
-	*scaledHeight = sh;
-}
-
-
-// Decompress and upload a texture. Returns false when decompression failed.
-static bool UploadTex(UUnrealMaterial* Tex, GLenum target, CTextureData &TexData, bool doMipmap)
+// Upload RGBA8 texture with all its mipmaps, TexData should be prepared with PrepareTextureData().
+static void UploadTex(GLenum target, GLenum target2, const CTextureData &TexData)
 {
 	guard(UploadTex);
 
-	byte *pic = TexData.Decompress(0);
-	if (!pic)
-	{
-		// some internal decompression error, message should be already printed to log
-		return false;
-	}
-
-	const CMipMap& Mip0 = TexData.Mips[0];
-
-	/*----- Calculate internal dimensions of the new texture --------*/
-	int scaledWidth, scaledHeight;
-	GetImageDimensions(Mip0.USize, Mip0.VSize, &scaledWidth, &scaledHeight);
-
-	/*---------------- Resample texture ------------------*/
-	// Copy or resample texture to new buffer (we will generate mipmaps there later)
-	unsigned *scaledPic = new unsigned [scaledWidth * scaledHeight];
-	if (Mip0.USize != scaledWidth || Mip0.VSize != scaledHeight)
-		ResampleTexture((unsigned*)pic, Mip0.USize, Mip0.VSize, scaledPic, scaledWidth, scaledHeight);
-	else
-		memcpy(scaledPic, pic, scaledWidth * scaledHeight * sizeof(unsigned));
-	delete pic; // no longer needed
-
 	/*------------- Determine texture format to upload --------------*/
 	GLenum format;
 	int alpha = 1; //?? image->alphaType;
 	format = (alpha ? 4 : 3);
 
 	/*------------------ Upload the image ---------------------------*/
-	// First mipmap
-//	printf("up_uncomp (%s, %d mips): %d %d (%d)\n", Tex->Name, TexData.Mips.Num(), Mip0.USize, Mip0.VSize, TexData.Mips.Num()); //!!
-	glTexImage2D(target, 0, format, scaledWidth, scaledHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, scaledPic);
-
-	// Upload or build other mipmaps
-	if (doMipmap && TexData.Mips.Num() > 1 && GL_SUPPORT(QGL_1_2)) // GL 1.2 is required for GL_TEXTURE_MAX_LEVEL
+	if (TexData.Mips.Num() > 1 && GL_SUPPORT(QGL_1_2)) // GL 1.2 is required for GL_TEXTURE_MAX_LEVEL
+		glTexParameteri(target2, GL_TEXTURE_MAX_LEVEL, TexData.Mips.Num() - 1);
+	for (int mipLevel = 0; mipLevel < TexData.Mips.Num(); mipLevel++)
 	{
-		guard(UploadMips);
-//		printf("upload mips %s\n", Tex->Name); //!!!!
-		// use provided mipmaps; assume all have power-of-2 dimensions
-		glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, TexData.Mips.Num() - 1);
-		for (int mipLevel = 1; mipLevel < TexData.Mips.Num(); mipLevel++)
-		{
-			const CMipMap& Mip = TexData.Mips[mipLevel];
-			byte* pic = TexData.Decompress(mipLevel);
-
-#if DEBUG_MIPS
-			// colorize mip levels
-			static const FVector cc[] = { {1,1,0}, {0,1,1}, {1,0,1}, {1,0,0}, {0,1,0}, {0,0,1} };
-			byte* d = pic;
-			FVector v = cc[min(mipLevel-1, 5)];
-			for (int i = 0; i < Mip.USize * Mip.VSize; i++, d += 4)
-			{
-				float r = d[0], g = d[1], b = d[2];
-				float c = (r + g + b) / 3.0f;
-				d[0] = byte(c * v.X);
-				d[1] = byte(c * v.Y);
-				d[2] = byte(c * v.Z);
-			}
-#endif // DEBUG_MIPS
-
-			assert(pic);
-//			printf("   mip %d x %d (%X)\n", Mip.USize, Mip.VSize, Mip.DataSize); //!!!
-			glTexImage2D(target, mipLevel, format, Mip.USize, Mip.VSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, pic);
-			delete pic;
-		}
-		unguard;
-	}
-	else if (doMipmap)
-	{
-		guard(BuildMips);
-		// build mipmaps
-//		printf("build mips %s\n", Tex->Name); //!!!!
-		int mipLevel = 0;
-		while (scaledWidth > 1 || scaledHeight > 1)
-		{
-			MipMap((byte *) scaledPic, scaledWidth, scaledHeight);
-			mipLevel++;
-			scaledWidth  >>= 1;
-			scaledHeight >>= 1;
-			if (scaledWidth < 1)  scaledWidth  = 1;
-			if (scaledHeight < 1) scaledHeight = 1;
-			glTexImage2D(target, mipLevel, format, scaledWidth, scaledHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, scaledPic);
-		}
-		unguard;
+		const CMipMap& Mip = TexData.Mips[mipLevel];
+//		printf("   mip %d x %d (%X)\n", Mip.USize, Mip.VSize, Mip.DataSize); //!!!
+		glTexImage2D(target, mipLevel, format, Mip.USize, Mip.VSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, Mip.CompressedData);
 	}
 
 #if DEBUG_MIPS
@@ -290,9 +63,6 @@ static bool UploadTex(UUnrealMaterial* Tex, GLenum target, CTextureData &TexData
 	glTexEnvf(GL_TEXTURE_FILTER_CONTROL_EXT, GL_TEXTURE_LOD_BIAS_EXT, 3.0f);
 #endif
 
-	delete scaledPic;
-	return true;
-
 	unguard;
 }
 
@@ -438,13 +208,100 @@ static bool UploadCompressedTex(UUnrealMaterial* Tex, GLenum target, GLenum targ
 }
 
 
+// Get options for texture preparation which match OpenGL capabilities
+static void GetPrepareParams(CTexturePrepareParams &Params, bool doMipmap)
+{
+	Params.DoMipmap        = doMipmap;
+	Params.UseProvidedMips = GL_SUPPORT(QGL_1_2);	// GL 1.2 is required for GL_TEXTURE_MAX_LEVEL
+	Params.KeepFormats     = 0;
+#if !DEBUG_MIPS
+	// formats accepted by UploadCompressedTex()
+	if (GL_SUPPORT(QGL_1_4))
+	{
+		Params.KeepFormats = (1 << TPF_BGRA8) | (1 << TPF_RGBA4);
+		if (GL_SUPPORT(QGL_EXT_TEXTURE_COMPRESSION_S3TC))
+			Params.KeepFormats |= (1 << TPF_DXT1) | (1 << TPF_DXT3) | (1 << TPF_DXT5);
+		if (GL_SUPPORT(QGL_ARB_TEXTURE_COMPRESSION_RGTC))
+			Params.KeepFormats |= (1 << TPF_BC5);
+		if (GL_SUPPORT(QGL_ARB_TEXTURE_COMPRESSION_BPTC))
+			Params.KeepFormats |= (1 << TPF_BC7);
+	}
+#endif // DEBUG_MIPS
+}
+
+
+// Upload texture data returned by PrepareTextureData(). Returns false in a case of error.
+static bool UploadPreparedTex(UUnrealMaterial* Tex, GLenum target, GLenum target2, CTextureData &TexData, CTexturePrepareParams &Params)
+{
+	guard(UploadPreparedTex);
+
+	if (TexData.Format == TPF_RGBA8)
+	{
+		UploadTex(target, target2, TexData);
+		return true;
+	}
+
+	if (UploadCompressedTex(Tex, target, target2, TexData, Params.DoMipmap))
+		return true;
+
+	// upload uncompressed
+	CTextureData Decompressed;
+	Params.KeepFormats = 0;
+	if (!PrepareTextureData(Tex, Params, Decompressed))
+	{
+		// some internal decompression error, message should be already displayed
+		return false;
+	}
+	UploadTex(target, target2, Decompressed);
+	return true;
+
+	unguard;
+}
+
+
+static int NumPendingUploads = 0;		// incremented when texture is not ready for upload
+
+// Returns 0 when the texture is not prepared yet, and the placeholder should be used
 static int Upload2D(UUnrealMaterial *Tex, bool doMipmap, bool clampS, bool clampT)
 {
 	guard(Upload2D);
 
+	static int UploadFrame = 0;
+	static int NumFrameUploads = 0;
+	if (UploadFrame != GCurrentFrame)
+	{
+		UploadFrame = GCurrentFrame;
+		NumFrameUploads = 0;
+	}
+
+	bool isDefault = (Tex->Package == NULL) && (Tex->Name == "Default");
+
+	CTexturePrepareParams Params;
+	GetPrepareParams(Params, doMipmap);
+
 	CTextureData TexData;
 	PROFILE_UPLOAD(appResetProfiler());
-	if (!Tex->GetTextureData(TexData))
+	bool prepared;
+	if (isDefault)
+	{
+		// the placeholder texture should be available immediately
+		prepared = PrepareTextureData(Tex, Params, TexData);
+	}
+	else
+	{
+		// decompression and mipmap generation are performed in a worker thread, take the
+		// result only when one more upload is allowed in this frame
+		bool canUpload = (NumFrameUploads < MAX_UPLOADS_PER_FRAME);
+		ETexturePrepareStatus Status = PrepareTextureAsync(Tex, Params, canUpload ? &TexData : NULL);
+		if (Status == TPS_Pending || (Status == TPS_Ready && !canUpload))
+		{
+			NumPendingUploads++;
+			return 0;
+		}
+		prepared = (Status == TPS_Ready);
+		NumFrameUploads++;
+	}
+	if (!prepared)
 	{
 		appPrintf("WARNING: %s %s has no valid mipmaps\n", Tex->GetClassName(), Tex->Name);
 		return BAD_TEXTURE;
@@ -454,18 +311,12 @@ static int Upload2D(UUnrealMaterial *Tex, bool doMipmap, bool clampS, bool clamp
 	glGenTextures(1, &TexNum);
 	glBindTexture(GL_TEXTURE_2D, TexNum);
 
-	if (!UploadCompressedTex(Tex, GL_TEXTURE_2D, GL_TEXTURE_2D, TexData, doMipmap))
+	if (!UploadPreparedTex(Tex, GL_TEXTURE_2D, GL_TEXTURE_2D, TexData, Params))
 	{
-		// upload uncompressed
-		if (!UploadTex(Tex, GL_TEXTURE_2D, TexData, doMipmap))
-		{
-			glDeleteTextures(1, &TexNum);
-			return BAD_TEXTURE;
-		}
+		glDeleteTextures(1, &TexNum);
+		return BAD_TEXTURE;
 	}
 
-	bool isDefault = (Tex->Package == NULL) && (Tex->Name == "Default");
-
 	// setup min/max filter
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, doMipmap ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);	// trilinear filter
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, isDefault ? GL_NEAREST : GL_LINEAR);
@@ -485,8 +336,17 @@ static bool UploadCubeSide(UUnrealMaterial *Tex, bool doMipmap, int side)
 {
 	guard(UploadCubeSide);
 
+	// Automatic mipmap generation doesn't work with cubemaps, so allow mipmaps only for
+	// explicitly provided data.
+	// https://www.opengl.org/sdk/docs/man/html/glGenerateMipmap.xhtml
+	CTexturePrepareParams Params;
+	GetPrepareParams(Params, true);
+
+	// cube faces are uploaded synchronously, the face could be queued when it was used as 2D texture
+	CancelTexturePreparation(Tex);
+
 	CTextureData TexData;
-	if (!Tex->GetTextureData(TexData))
+	if (!PrepareTextureData(Tex, Params, TexData))
 	{
 		appPrintf("WARNING: %s %s has no valid mipmaps\n", Tex->GetClassName(), Tex->Name);
 		return false;
@@ -503,20 +363,13 @@ static bool UploadCubeSide(UUnrealMaterial *Tex, bool doMipmap, int side)
 	}
 #endif
 
-	// Automatic mipmap generation doesn't work with cubemaps, so allow mipmaps only for
-	// explicitly provided data.
-	// https://www.opengl.org/sdk/docs/man/html/glGenerateMipmap.xhtml
 	doMipmap = TexData.Mips.Num() > 0;
 
 	GLenum target = GL_TEXTURE_CUBE_MAP_POSITIVE_X_ARB + side;
-	if (!UploadCompressedTex(Tex, target, GL_TEXTURE_CUBE_MAP_ARB, TexData, doMipmap))
+	if (!UploadPreparedTex(Tex, target, GL_TEXTURE_CUBE_MAP_ARB, TexData, Params))
 	{
-		// upload uncompressed
-		if (!UploadTex(Tex, target, TexData, doMipmap))
-		{
-			// some internal decompression error, message should be already displayed
-			return false;
-		}
+		// some internal decompression error, message should be already displayed
+		return false;
 	}
 
 	if (side == 5)
@@ -582,6 +435,7 @@ void GL_NormalmapShader(CShader &shader, CMaterialParams &Params)
 	const char *subst[10];
 	char  defines[512];
 	defines[0] = 0;
+	int numPending = NumPendingUploads;
 
 	enum
 	{
@@ -764,6 +618,13 @@ void GL_NormalmapShader(CShader &shader, CMaterialParams &Params)
 
 	glActiveTexture(GL_TEXTURE0);
 
+	if (NumPendingUploads != numPending)
+	{
+		// some textures are not uploaded yet, don't build the shader for placeholders
+		GL_UseGenericShader(GS_Textured);
+		return;
+	}
+
 	//?? should check IsValid before preparing params above (they're needed only once)
 	//?? (but this will not allow SHOW_SHADER_PARAMS to work)
 	if (!shader.IsValid())
@@ -1085,7 +946,15 @@ bool UTexture::Upload()
 {
 	if (TexNum == BAD_TEXTURE) return false;
 	if (!GL_TouchObject(DrawTimestamp))
+	{
 		TexNum = Upload2D(this, Mips.Num() > 1, UClampMode == TC_Clamp, VClampMode == TC_Clamp);
+		if (!TexNum)
+		{
+			// texture is not prepared yet, check it again later
+			DrawTimestamp = 0;
+			return false;
+		}
+	}
 	return (TexNum != BAD_TEXTURE);
 }
 
@@ -1125,6 +994,7 @@ bool UTexture::IsTranslucent() const
 void UTexture::Release()
 {
 	guard(UTexture::Release);
+	CancelTexturePreparation(this);
 	if (GL_IsValidObject(TexNum, DrawTimestamp))
 		glDeleteTextures(1, &TexNum);
 	Super::Release();
@@ -1871,7 +1741,15 @@ bool UTexture2D::Upload()
 {
 	if (TexNum == BAD_TEXTURE) return false;
 	if (!GL_TouchObject(DrawTimestamp))
-        TexNum = Upload2D(this, Mips.Num() > 1, AddressX == TA_Clamp, AddressY == TA_Clamp);
+	{
+		TexNum = Upload2D(this, Mips.Num() > 1, AddressX == TA_Clamp, AddressY == TA_Clamp);
+		if (!TexNum)
+		{
+			// texture is not prepared yet, check it again later
+			DrawTimestamp = 0;
+			return false;
+		}
+	}
 	return (TexNum != BAD_TEXTURE);
 }
 
@@ -1905,6 +1783,7 @@ void UTexture2D::GetParams(CMaterialParams &Params) const
 void UTexture2D::Release()
 {
 	guard(UTexture2D::Release);
+	CancelTexturePreparation(this);
 	if (GL_IsValidObject(TexNum, DrawTimestamp))
 		glDeleteTextures(1, &TexNum);
 	ReleaseTextureData();
@@ -769,8 +769,8 @@ void UTexture2D::ReleaseTextureData() const
 	{
 		const FTexture2DMipMap &Mip = (*MipsArray)[n];
 		const FByteBulkData &Bulk = Mip.Data;
-		if (Bulk.BulkData && (Bulk.BulkDataFlags & BULKDATA_StoreInSeparateFile))
-			const_cast<FByteBulkData*>(&Bulk)->ReleaseData();
+		if (Bulk.BulkData && ((Bulk.BulkDataFlags & BULKDATA_StoreInSeparateFile) || Bulk.CanReloadData()))
+			Bulk.ReleaseData();
 	}
 
 	unguardf("%s", Name);
@@ -909,7 +909,7 @@ bool UTexture2D::GetTextureData(CTextureData &TexData) const
 			// reference: DemoPlayerSkins.utx/DemoSkeleton have null-sized 1st 2 mips
 			const FTexture2DMipMap &Mip = (*MipsArray)[mipLevel];
 			const FByteBulkData &Bulk = Mip.Data;
-			if (!Mip.Data.BulkData)
+			if (!Bulk.GetData())
 			{
 				// check for external bulk
 				//?? Separate this function ?
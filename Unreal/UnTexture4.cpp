@@ -127,7 +127,7 @@ void UTexture2D::Serialize4(FArchive& Ar)
 			Ar << PixelFormatEnum;
 		}
 	}
-	else if (SourceArt.BulkData != NULL)
+	else if (SourceArt.GetData() != NULL)
 	{
 		guard(UTexture4::LoadSourceData);
 
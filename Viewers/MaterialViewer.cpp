@@ -310,7 +310,7 @@ void CMaterialViewer::Draw2D()
 		const TArray<FTexture2DMipMap> *MipsArray = Tex->GetMipmapArray();
 		const FTexture2DMipMap *Mip = NULL;
 		for (int i = 0; i < MipsArray->Num(); i++)
-			if ((*MipsArray)[i].Data.BulkData)
+			if ((*MipsArray)[i].Data.BulkData || (*MipsArray)[i].Data.CanReloadData())
 			{
 				Mip = &(*MipsArray)[i];
 				break;